@@ -56,6 +56,58 @@ function(verifySyslogDependencies VARNAME)
   endif()
 endfunction()
 
+# verifyJournaldDependencies(JOURNALD_SINK_ERROR) 
+# if (NOT JOURNALD_SINK_ERROR)
+# ... the journal socket protocol can be used, start using it.
+function(verifyJournaldDependencies VARNAME)
+  include(CheckSymbolExists)
+  if(NOT ${CMAKE_SYSTEM_NAME} MATCHES "Linux")
+    set(${VARNAME}
+        "journald is only available on Linux. g3journald [sink, test,example] will not be built"
+        PARENT_SCOPE)
+    return()
+  endif()
+  set(CMAKE_REQUIRED_DEFINITIONS -D_GNU_SOURCE)
+  check_symbol_exists(memfd_create "sys/mman.h" HAVE_MEMFD_CREATE)
+  if(NOT HAVE_MEMFD_CREATE)
+    set(${VARNAME}
+        "Could not find memfd_create. g3journald [sink, test,example] will not be built"
+        PARENT_SCOPE)
+  endif()
+endfunction()
+
+# verifySharedMemoryDependencies(SHAREDMEM_SINK_ERROR) 
+# if (NOT SHAREDMEM_SINK_ERROR)
+# ... the shared memory ring can be used, start using it.
+function(verifySharedMemoryDependencies VARNAME)
+  include(CheckIncludeFile)
+  if(NOT ${CMAKE_SYSTEM_NAME} MATCHES "Linux")
+    set(${VARNAME}
+        "The shared memory ring uses Linux futexes. g3sharedmem [sink, collector, test] will not be built"
+        PARENT_SCOPE)
+    return()
+  endif()
+  check_include_file("linux/futex.h" HAVE_LINUX_FUTEX_H)
+  if(NOT HAVE_LINUX_FUTEX_H)
+    set(${VARNAME}
+        "Could not find linux/futex.h. g3sharedmem [sink, collector, test] will not be built"
+        PARENT_SCOPE)
+  endif()
+endfunction()
+
+# verifyUsdtDependencies(USDT_PROBES_ERROR) 
+# if (NOT USDT_PROBES_ERROR)
+# ... sys/sdt.h (systemtap-sdt-dev) is available, the probes can be built in.
+function(verifyUsdtDependencies VARNAME)
+  include(CheckIncludeFile)
+  check_include_file("sys/sdt.h" HAVE_SYS_SDT_H)
+  if(NOT HAVE_SYS_SDT_H)
+    set(${VARNAME}
+        "Could not find sys/sdt.h (systemtap-sdt-dev). The sinks are built without USDT probes"
+        PARENT_SCOPE)
+  endif()
+endfunction()
+
 # verifyTraceloggingDependencies(TRACELOGGING_SINK_ERROR) 
 # if (NOT TRACELOGGING_SINK_ERROR)
 # ... syslog is available, start using it.
@@ -13,12 +13,18 @@ option(CHOICE_BUILD_DEBUG "Build for DEBUG" OFF)
 # TEST, EXAMPLES SETUP
 option(CHOICE_BUILD_TESTS "Build the unit tests" ON)
 option(CHOICE_BUILD_EXAMPLES "Build the examples" ON)
+option(CHOICE_BUILD_BENCHMARKS "Build g3sinks_benchmarks, if Google Benchmark is found" ON)
 
 # SINKS
 option(CHOICE_SINK_LOGROTATE "Build the logrotate sink" ON)
 option(CHOICE_SINK_SYSLOG "Build the syslog sink" ON)
+option(CHOICE_SINK_JOURNALD "Build the journald sink" ON)
+option(CHOICE_SINK_SHAREDMEM "Build the shared memory sink and collector" ON)
 option(CHOICE_SINK_SNIPPETS "Build the syslog sink" ON)
 
+# TRACING
+option(CHOICE_USDT_PROBES "Build the sinks with sys/sdt.h USDT probes, for bpftrace, perf and systemtap" OFF)
+
 if(CHOICE_BUILD_TESTS)
   enable_testing()
 endif()
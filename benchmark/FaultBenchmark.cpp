@@ -0,0 +1,140 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <benchmark/benchmark.h>
+#include <g3log/g3log.hpp>
+#include <g3log/logworker.hpp>
+#include <g3sinks/LogRotate.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "FaultInjection.h"
+#if defined(G3SINKS_FAULT_FILELOG)
+#include <fcntl.h>
+#include <g3sinks/FileLogSink.h>
+#endif
+
+namespace {
+   std::string FaultDirectory() {
+      static const std::string directory = [] {
+         std::string path = "/tmp/g3sinks_fault_benchmark_" + std::to_string(getpid()) + "/";
+         if (0 != std::system(("mkdir -p " + path).c_str())) {
+            std::fprintf(stderr, "cannot create %s\n", path.c_str());
+         }
+         return path;
+      }();
+      static const bool removed_at_exit = (0 == std::atexit([] { std::system(("rm -rf " + FaultDirectory()).c_str()); }));
+      (void)removed_at_exit;
+      return directory;
+   }
+
+   void Configure(benchmark::State& state, const std::string& faults) {
+      if (0 != g3sinks_faults_configure(("path=" + FaultDirectory() + "," + faults).c_str())) {
+         state.SkipWithError("cannot configure the faults");
+      }
+   }
+
+   void ReportFaults(benchmark::State& state) {
+      G3sinksFaultCounters counters;
+      g3sinks_faults_counters(&counters);
+      g3sinks_faults_clear();
+      state.counters["delayed_writes"] = static_cast<double>(counters.delayed_writes);
+      state.counters["short_writes"] = static_cast<double>(counters.short_writes);
+      state.counters["failed_writes"] = static_cast<double>(counters.failed_writes);
+   }
+
+   const std::string kEntry = "2026/10/18 12:00:00 123456\tINFO [Server.cpp->handle:123]\trequest 7919 completed in 12 ms\n";
+} // anonymous
+
+// LogRotate::save with a flush per entry on a disk where every Nth write() sleeps.
+// Args: write delay in us, delayed every Nth write
+static void BM_LogRotateSaveSlowDisk(benchmark::State& state) {
+   LogRotate logrotate("bm_slow_disk", FaultDirectory());
+   logrotate.setMaxLogSize(1 << 30);
+   logrotate.setFlushPolicy(1);
+   Configure(state, "write_delay_us=" + std::to_string(state.range(0)) + ",write_delay_every=" + std::to_string(state.range(1)));
+   for (auto _ : state) {
+      logrotate.save(kEntry);
+   }
+   ReportFaults(state);
+   auto stats = logrotate.stats();
+   state.counters["p99_us"] = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(stats.write_latency.percentile(99)).count());
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogRotateSaveSlowDisk)->ArgNames({"delay_us", "every"})->ArgsProduct({{0, 100, 1000}, {1, 100}})->UseRealTime();
+
+// LogRotate::save when every Nth write() fails with ENOSPC: the failed entries are counted, the others written
+static void BM_LogRotateSaveFullDisk(benchmark::State& state) {
+   LogRotate logrotate("bm_full_disk", FaultDirectory());
+   logrotate.setMaxLogSize(1 << 30);
+   logrotate.setFlushPolicy(1);
+   Configure(state, "enospc_every=" + std::to_string(state.range(0)));
+   for (auto _ : state) {
+      logrotate.save(kEntry);
+   }
+   ReportFaults(state);
+   state.counters["write_errors"] = static_cast<double>(logrotate.stats().write_errors);
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogRotateSaveFullDisk)->ArgName("every")->Arg(2)->Arg(100);
+
+// A burst of LOG calls through the LogWorker to LogRotate while every write() sleeps: the LOG calls return at
+// once and the entries queue up in the LogWorker until the sink catches up. Args: entries in the burst, write delay in us
+static void BM_LogWorkerBurstOnSlowDisk(benchmark::State& state) {
+   auto logworker = g3::LogWorker::createLogWorker();
+   g3::initializeLogging(logworker.get());
+   auto logrotate = std::make_unique<LogRotate>("bm_burst", FaultDirectory());
+   logrotate->setMaxLogSize(1 << 30);
+   logrotate->setFlushPolicy(1);
+   auto handle = logworker->addSink(std::move(logrotate), &LogRotate::save);
+   Configure(state, "write_delay_us=" + std::to_string(state.range(1)));
+
+   double produce_us = 0;
+   double drain_us = 0;
+   for (auto _ : state) {
+      auto start = std::chrono::steady_clock::now();
+      for (int64_t i = 0; i < state.range(0); ++i) {
+         LOG(INFO) << "burst entry " << i;
+      }
+      auto produced = std::chrono::steady_clock::now();
+      handle->call(&LogRotate::flush).wait(); // queued behind the burst
+      auto drained = std::chrono::steady_clock::now();
+      produce_us += std::chrono::duration<double, std::micro>(produced - start).count();
+      drain_us += std::chrono::duration<double, std::micro>(drained - start).count();
+   }
+   ReportFaults(state);
+   state.counters["produce_us"] = benchmark::Counter(produce_us, benchmark::Counter::kAvgIterations);
+   state.counters["drain_us"] = benchmark::Counter(drain_us, benchmark::Counter::kAvgIterations);
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LogWorkerBurstOnSlowDisk)->ArgNames({"entries", "delay_us"})->ArgsProduct({{1000}, {0, 200}})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+#if defined(G3SINKS_FAULT_FILELOG)
+// FileLogSink::ReceiveLogMessage when each write() writes at most N bytes, the sink writes the rest
+static void BM_FileLogSinkShortWrites(benchmark::State& state) {
+   const std::string path = FaultDirectory() + "bm_short_writes";
+   {
+      FileLogSink sink(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644), true);
+      Configure(state, "short_write=" + std::to_string(state.range(0)));
+      for (auto _ : state) {
+         g3::LogMessage message("Server.cpp", 123, "handle", INFO);
+         message.write().append(kEntry);
+         sink.ReceiveLogMessage(g3::LogMessageMover(std::move(message)));
+      }
+   }
+   ReportFaults(state);
+   std::remove(path.c_str());
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FileLogSinkShortWrites)->ArgName("max_bytes")->Arg(0)->Arg(64)->Arg(7);
+#endif
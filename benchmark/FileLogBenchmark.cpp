@@ -0,0 +1,77 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <benchmark/benchmark.h>
+#include <g3sinks/FileLogSink.h>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, const std::string& content) {
+      g3::LogMessage message("Server.cpp", 123, "handle", level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+} // anonymous
+
+// FileLogSink::ReceiveLogMessage to /dev/null, i.e. the cost of the sink and its syscalls without the storage,
+// including the creation of the LogMessage. Args: buffer size (0: a write per record), message size
+static void BM_FileLogSinkDevNull(benchmark::State& state) {
+   int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+   {
+      FileLogSink sink(fd, true);
+      FileLogSink::FlushPolicy policy;
+      policy.max_bytes = static_cast<size_t>(state.range(0));
+      sink.setFlushPolicy(policy);
+      const std::string text(static_cast<size_t>(state.range(1)), 'x');
+      for (auto _ : state) {
+         sink.ReceiveLogMessage(CreateLogEntry(INFO, text));
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FileLogSinkDevNull)->ArgNames({"buffer", "size"})->ArgsProduct({{0, 64 * 1024}, {64, 1024}});
+
+// FileLogSink::ReceiveLogMessage to a file in /tmp, started over every 64 MiB outside of the timing.
+// Args: buffer size (0: a write per record), message size
+static void BM_FileLogSinkFile(benchmark::State& state) {
+   const std::string path = "/tmp/g3sinks_benchmark_filelog_" + std::to_string(getpid());
+   int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+   if (fd < 0) {
+      state.SkipWithError("cannot create the file");
+      return;
+   }
+   {
+      FileLogSink sink(fd, false);
+      FileLogSink::FlushPolicy policy;
+      policy.max_bytes = static_cast<size_t>(state.range(0));
+      sink.setFlushPolicy(policy);
+      const std::string text(static_cast<size_t>(state.range(1)), 'x');
+      size_t written = 0;
+      for (auto _ : state) {
+         sink.ReceiveLogMessage(CreateLogEntry(INFO, text));
+         written += text.size();
+         if (written > 64 * 1024 * 1024) {
+            state.PauseTiming();
+            sink.flush();
+            if (0 != ftruncate(fd, 0)) {
+               state.SkipWithError("cannot truncate the file");
+            }
+            written = 0;
+            state.ResumeTiming();
+         }
+      }
+   }
+   close(fd);
+   unlink(path.c_str());
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FileLogSinkFile)->ArgNames({"buffer", "size"})->ArgsProduct({{0, 64 * 1024}, {64, 1024}});
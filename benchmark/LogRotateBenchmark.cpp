@@ -0,0 +1,200 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <benchmark/benchmark.h>
+#include <g3log/logmessage.hpp>
+#include <g3sinks/LogRotate.h>
+#include <g3sinks/LogRotateUtility.h>
+#include <g3sinks/LogRotateWithFilter.h>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+   const size_t kTruncateBytes = 64 * 1024 * 1024;
+
+   void RemoveDirectory(const std::string& directory) {
+      std::string command = "rm -rf " + directory;
+      if (0 != std::system(command.c_str())) {
+         std::fprintf(stderr, "cannot remove %s\n", directory.c_str());
+      }
+   }
+
+   std::string BenchmarkDirectory() {
+      static const std::string directory = [] {
+         std::string path = "/tmp/g3sinks_benchmark_" + std::to_string(getpid()) + "/";
+         std::string command = "mkdir -p " + path;
+         if (0 != std::system(command.c_str())) {
+            std::fprintf(stderr, "cannot create %s\n", path.c_str());
+         }
+         return path;
+      }();
+      static const bool removed_at_exit = (0 == std::atexit([] { RemoveDirectory(BenchmarkDirectory()); }));
+      (void)removed_at_exit;
+      return directory;
+   }
+
+   /// A log line of about @param size bytes that compresses like a real log: same layout, changing numbers
+   std::string LogLine(size_t size, uint64_t counter) {
+      std::string line = "2026/10/18 12:00:00 " + std::to_string(counter % 1000000) + " INFO [Server.cpp->handle:"
+                         + std::to_string(100 + counter % 300) + "]: request " + std::to_string(counter * 7919)
+                         + " completed in " + std::to_string(counter % 97) + " ms ";
+      while (line.size() + 1 < size) {
+         line.append("payload ").append(std::to_string(counter++ % 8191)).push_back(' ');
+      }
+      line.resize(size > 0 ? size - 1 : 0);
+      line.push_back('\n');
+      return line;
+   }
+
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, const std::string& content) {
+      g3::LogMessage message("Server.cpp", 123, "handle", level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+
+   /// Starts the log file over, outside of the timing, so long runs do not fill the disk
+   void TruncateLog(benchmark::State& state, LogRotate& logrotate, size_t& written) {
+      state.PauseTiming();
+      std::remove(logrotate.logFileName().c_str());
+      logrotate.changeLogFile(BenchmarkDirectory());
+      written = 0;
+      state.ResumeTiming();
+   }
+} // anonymous
+
+// LogRotate::save. Args: flush policy, message size
+static void BM_LogRotateSave(benchmark::State& state) {
+   LogRotate logrotate("bm_save", BenchmarkDirectory());
+   logrotate.setMaxLogSize(1 << 30);
+   logrotate.setFlushPolicy(static_cast<size_t>(state.range(0)));
+   const std::string line = LogLine(static_cast<size_t>(state.range(1)), 1);
+   size_t written = 0;
+   for (auto _ : state) {
+      logrotate.save(line);
+      written += line.size();
+      if (written > kTruncateBytes) {
+         TruncateLog(state, logrotate, written);
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+   state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(line.size()));
+   std::remove(logrotate.logFileName().c_str());
+}
+BENCHMARK(BM_LogRotateSave)->ArgNames({"flush_policy", "size"})->ArgsProduct({{0, 1, 16}, {64, 512, 4096}});
+
+// LogRotateWithFilter::save, including the creation of the LogMessage.
+// Arg: 0 no filter, 1 a filter the entry passes, 2 a filter that drops the entry,
+// 3 no filter with latency tracking, 4 no filter with repeat suppression of identical entries
+static void BM_LogRotateWithFilterSave(benchmark::State& state) {
+   const int variant = static_cast<int>(state.range(0));
+   std::vector<LEVELS> filter;
+   if (1 == variant) {
+      filter = {G3LOG_DEBUG};
+   } else if (2 == variant) {
+      filter = {G3LOG_DEBUG, INFO};
+   }
+   auto sink = LogRotateWithFilter::CreateLogRotateWithFilter("bm_filter", BenchmarkDirectory(), filter);
+   sink->setMaxLogSize(1 << 30);
+   if (3 == variant) {
+      sink->setLatencyTracking(true, std::chrono::seconds(0));
+   }
+   if (4 == variant) {
+      sink->setRepeatSuppression(std::chrono::milliseconds(100));
+   }
+   const std::string text = LogLine(128, 1);
+   size_t entries = 0;
+   for (auto _ : state) {
+      sink->save(CreateLogEntry(INFO, text));
+      if (++entries * text.size() > kTruncateBytes) {
+         state.PauseTiming();
+         std::remove(sink->logFileName().c_str());
+         sink->changeLogFile(BenchmarkDirectory());
+         entries = 0;
+         state.ResumeTiming();
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+   std::remove(sink->logFileName().c_str());
+}
+BENCHMARK(BM_LogRotateWithFilterSave)->ArgName("variant")->DenseRange(0, 4);
+
+// rotateLog(): flush, gzip compression, removal of the log and expiry of old archives. Arg: log size in bytes
+static void BM_LogRotateRotation(benchmark::State& state) {
+   const std::string directory = BenchmarkDirectory() + "rotation/";
+   RemoveDirectory(directory);
+   std::string command = "mkdir -p " + directory;
+   if (0 != std::system(command.c_str())) {
+      state.SkipWithError("cannot create the directory");
+      return;
+   }
+   LogRotate logrotate("bm_rotate", directory);
+   logrotate.setMaxLogSize(1 << 30);
+   logrotate.setMaxArchiveLogCount(2);
+   logrotate.setFlushPolicy(0);
+   const size_t log_size = static_cast<size_t>(state.range(0));
+   uint64_t counter = 0;
+   for (auto _ : state) {
+      state.PauseTiming();
+      for (size_t size = 0; size < log_size; ++counter) {
+         auto line = LogLine(200, counter);
+         logrotate.save(line);
+         size += line.size();
+      }
+      state.ResumeTiming();
+      if (!logrotate.rotateLog()) {
+         state.SkipWithError("rotation failed");
+         break;
+      }
+   }
+   state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(log_size));
+   auto stats = logrotate.stats();
+   state.counters["compression_ratio"] = stats.compression_ratio;
+   RemoveDirectory(directory);
+}
+BENCHMARK(BM_LogRotateRotation)->ArgName("log_bytes")->Arg(1 << 20)->Arg(8 << 20)->Arg(64 << 20)->Unit(benchmark::kMillisecond);
+
+// expireArchives() in a directory with N archives, as at each rotation: one archive too many is removed.
+// Arg: archives in the directory
+static void BM_ExpireArchives(benchmark::State& state) {
+   const std::string directory = BenchmarkDirectory() + "expire/";
+   RemoveDirectory(directory);
+   std::string command = "mkdir -p " + directory;
+   if (0 != std::system(command.c_str())) {
+      state.SkipWithError("cannot create the directory");
+      return;
+   }
+   const std::string app_name = "bm_expire.log";
+   time_t archive_time = 1700000000;
+   auto createArchive = [&] {
+      char date[32];
+      std::tm tm = *std::localtime(&archive_time);
+      std::strftime(date, sizeof(date), "%Y-%m-%d-%H-%M-%S", &tm);
+      std::ofstream(directory + app_name + "." + date + ".gz");
+      ++archive_time;
+   };
+   const auto archives = static_cast<unsigned long>(state.range(0));
+   for (unsigned long i = 0; i < archives; ++i) {
+      createArchive();
+   }
+
+   for (auto _ : state) {
+      state.PauseTiming();
+      createArchive();
+      state.ResumeTiming();
+      LogRotateUtility::expireArchives(directory, app_name, archives);
+   }
+   state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(archives));
+   RemoveDirectory(directory);
+}
+BENCHMARK(BM_ExpireArchives)->ArgName("archives")->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMillisecond);
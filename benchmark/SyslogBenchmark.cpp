@@ -0,0 +1,88 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <benchmark/benchmark.h>
+#include <g3log/logmessage.hpp>
+#include <g3sinks/syslogsink.hpp>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+   /// A syslog daemon stand in that reads, and discards, datagrams as fast as it can
+   class DrainingDaemon {
+    public:
+      DrainingDaemon()
+         : _path("/tmp/g3sinks_benchmark_syslog_" + std::to_string(getpid()))
+         , _socket(socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0))
+         , _stop(false) {
+         sockaddr_un address{};
+         address.sun_family = AF_UNIX;
+         std::strncpy(address.sun_path, _path.c_str(), sizeof(address.sun_path) - 1);
+         unlink(_path.c_str());
+         bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+         timeval timeout{0, 100 * 1000};
+         setsockopt(_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+         _reader = std::thread([this] {
+            char datagram[64 * 1024];
+            while (!_stop) {
+               recv(_socket, datagram, sizeof(datagram), 0);
+            }
+         });
+      }
+
+      ~DrainingDaemon() {
+         _stop = true;
+         _reader.join();
+         close(_socket);
+         unlink(_path.c_str());
+      }
+
+      const std::string& path() const { return _path; }
+
+    private:
+      std::string _path;
+      int _socket;
+      std::atomic<bool> _stop;
+      std::thread _reader;
+   };
+
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, const std::string& content) {
+      g3::LogMessage message("Server.cpp", 123, "handle", level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+} // anonymous
+
+// SyslogSink::syslog with the direct transport, including the creation of the LogMessage.
+// Args: 0 RFC 5424, 1 RFC 3164, 2 RFC 5424 with structured data, 3 RFC 5424 dropped by a rate limit; message size
+static void BM_SyslogSinkDirect(benchmark::State& state) {
+   DrainingDaemon daemon;
+   g3::SyslogSink sink("g3sinks_benchmark");
+   const int variant = static_cast<int>(state.range(0));
+   auto format = (1 == variant) ? g3::SyslogTransport::Format::RFC3164 : g3::SyslogTransport::Format::RFC5424;
+   sink.useDirectTransport(format, daemon.path());
+   if (2 == variant) {
+      sink.setStructuredData(true);
+   }
+   if (3 == variant) {
+      sink.setLevelRateLimit(INFO, 1, 1);
+   }
+   const std::string text(static_cast<size_t>(state.range(1)), 'x');
+   for (auto _ : state) {
+      sink.syslog(CreateLogEntry(INFO, text));
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyslogSinkDirect)->ArgNames({"variant", "size"})->ArgsProduct({{0, 1, 2, 3}, {64, 1024}});
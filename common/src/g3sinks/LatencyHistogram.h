@@ -0,0 +1,144 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/**
+* A fixed size latency histogram that a sink can update for every log entry.
+*
+* Durations are counted in nanoseconds in log-linear buckets: every power of two is split
+* in 8 buckets, so a bucket is at most 1/8 (12.5%) wider than its lower bound. Recording
+* is a few shifts and an increment, no allocation. Durations up to ~2^40 ns (18 minutes)
+* are kept apart, longer ones share the last bucket.
+*
+* Percentiles are reported as the upper bound of the bucket they fall in, i.e. they are
+* never under estimated by more than the bucket width.
+*
+* Not thread safe, it is meant to live inside a sink and be read through the sink handle.
+*/
+class LatencyHistogram {
+ public:
+   static const int kSubBucketBits = 3;
+   static const int kSubBuckets = 1 << kSubBucketBits;
+   static const int kMaxExponent = 40;
+   static const int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+   LatencyHistogram() { reset(); }
+
+   void record(std::chrono::nanoseconds duration) {
+      uint64_t value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+      ++_buckets[bucketIndex(value)];
+      ++_count;
+      _sum += value;
+      _max = std::max(_max, value);
+   }
+
+   void merge(const LatencyHistogram& other) {
+      for (int i = 0; i < kBucketCount; ++i) {
+         _buckets[i] += other._buckets[i];
+      }
+      _count += other._count;
+      _sum += other._sum;
+      _max = std::max(_max, other._max);
+   }
+
+   void reset() {
+      _buckets.fill(0);
+      _count = 0;
+      _sum = 0;
+      _max = 0;
+   }
+
+   uint64_t count() const { return _count; }
+   std::chrono::nanoseconds sum() const { return std::chrono::nanoseconds(_sum); }
+   std::chrono::nanoseconds max() const { return std::chrono::nanoseconds(_max); }
+   std::chrono::nanoseconds mean() const {
+      return std::chrono::nanoseconds(_count > 0 ? _sum / _count : 0);
+   }
+
+   /// @param percent 0 ... 100, e.g. 99.9
+   /// @return the duration that @param percent of the recorded durations are at or below, 0 when empty
+   std::chrono::nanoseconds percentile(double percent) const {
+      if (0 == _count) {
+         return std::chrono::nanoseconds(0);
+      }
+      percent = std::min(std::max(percent, 0.0), 100.0);
+      uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(_count) + 0.5);
+      rank = std::max(rank, uint64_t{1});
+      uint64_t seen = 0;
+      for (int i = 0; i < kBucketCount; ++i) {
+         seen += _buckets[i];
+         if (seen >= rank) {
+            return std::chrono::nanoseconds(std::min(bucketUpperBound(i), _max));
+         }
+      }
+      return std::chrono::nanoseconds(_max);
+   }
+
+   /// @return how many recorded durations are in buckets that lie completely at or below @param bound,
+   /// durations within one bucket width under @param bound can be left out
+   uint64_t countAtOrBelow(std::chrono::nanoseconds bound) const {
+      uint64_t limit = bound.count() > 0 ? static_cast<uint64_t>(bound.count()) : 0;
+      uint64_t total = 0;
+      for (int i = 0; i < kBucketCount && bucketUpperBound(i) <= limit; ++i) {
+         total += _buckets[i];
+      }
+      return total;
+   }
+
+ private:
+   static int bucketIndex(uint64_t value) {
+      if (value < kSubBuckets) {
+         return static_cast<int>(value);
+      }
+      int exponent = 63 - countLeadingZeros(value);
+      if (exponent > kMaxExponent) {
+         return kBucketCount - 1;
+      }
+      int sub = static_cast<int>((value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+      return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+   }
+
+   /// The largest value that falls in bucket @param index
+   static uint64_t bucketUpperBound(int index) {
+      if (index < kSubBuckets) {
+         return static_cast<uint64_t>(index);
+      }
+      if (index == kBucketCount - 1) {
+         return UINT64_MAX;
+      }
+      int exponent = index / kSubBuckets + kSubBucketBits - 1;
+      uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+      uint64_t width = uint64_t{1} << (exponent - kSubBucketBits);
+      return (uint64_t{1} << exponent) + (sub + 1) * width - 1;
+   }
+
+   static int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_clzll(value);
+#else
+      int zeros = 0;
+      for (uint64_t bit = uint64_t{1} << 63; 0 == (value & bit); bit >>= 1) {
+         ++zeros;
+      }
+      return zeros;
+#endif
+   }
+
+   std::array<uint64_t, kBucketCount> _buckets;
+   uint64_t _count;
+   uint64_t _sum;
+   uint64_t _max;
+};
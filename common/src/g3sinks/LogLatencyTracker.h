@@ -0,0 +1,136 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <g3sinks/LatencyHistogram.h>
+
+/// How long log entries took from their creation, the LOG call, until the sink
+/// wrote them and until they were flushed, i.e. left the process
+struct LogLatency {
+   LatencyHistogram to_write;
+   LatencyHistogram to_flush;
+};
+
+/**
+* Measures the end to end latency of log entries, for a sink to call:
+*    written(message._timestamp) when it has written, or buffered, an entry
+*    flushed() when all written entries have left the process
+*
+* The creation time is the LogMessage timestamp, the wall clock. It is converted to the steady
+* clock once, when the entry is written, so a wall clock jump only affects the entries at the jump.
+*
+* Entries that wait for a flush are remembered, up to max_unflushed. Entries after that are
+* still measured to write but not to flush.
+*
+* @ref summary gives a line with the percentiles since the previous summary, for the sink to write
+* in-band. Disabled by default, then written() and flushed() return at once.
+* Not thread safe, it is meant to live inside a sink.
+*/
+class LogLatencyTracker {
+ public:
+   using steady_time_point = std::chrono::steady_clock::time_point;
+
+   LogLatencyTracker()
+      : _enabled(false)
+      , _summary_interval(std::chrono::seconds(60))
+      , _last_summary(std::chrono::steady_clock::now())
+      , _max_unflushed(64 * 1024) {}
+
+   /// @param summary_interval how often a summary is given, 0: never
+   void enable(bool enabled, std::chrono::seconds summary_interval = std::chrono::seconds(60)) {
+      _enabled = enabled;
+      _summary_interval = summary_interval;
+      _last_summary = std::chrono::steady_clock::now();
+      if (!enabled) {
+         _unflushed.clear();
+      }
+   }
+
+   bool enabled() const { return _enabled; }
+
+   /// @param created the LogMessage::_timestamp of an entry that was just written
+   template <typename TimePoint>
+   void written(const TimePoint& created) {
+      if (!_enabled) {
+         return;
+      }
+      auto age = std::chrono::duration_cast<std::chrono::nanoseconds>(TimePoint::clock::now() - created);
+      _total.to_write.record(age);
+      _interval.to_write.record(age);
+      if (_unflushed.size() < _max_unflushed) {
+         _unflushed.push_back(std::chrono::steady_clock::now() - age);
+      }
+   }
+
+   /// All written entries have been flushed
+   void flushed() {
+      if (_unflushed.empty()) {
+         return;
+      }
+      auto now = std::chrono::steady_clock::now();
+      for (auto created : _unflushed) {
+         auto age = std::chrono::duration_cast<std::chrono::nanoseconds>(now - created);
+         _total.to_flush.record(age);
+         _interval.to_flush.record(age);
+      }
+      _unflushed.clear();
+   }
+
+   /// @return the latency of all entries since tracking was enabled
+   const LogLatency& latency() const { return _total; }
+
+   /// @return the percentiles since the last summary, or an empty string if nothing was written
+   /// or the summary interval has not yet passed. @param force ignores the interval
+   std::string summary(bool force = false) {
+      if (!_enabled || 0 == _interval.to_write.count()) {
+         return {};
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (!force && (0 == _summary_interval.count() || (now - _last_summary) < _summary_interval)) {
+         return {};
+      }
+
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_summary);
+      std::ostringstream summary;
+      summary << "g3sinks: latency of " << _interval.to_write.count() << " entries in the last "
+              << elapsed.count() << " ms, to write " << percentiles(_interval.to_write)
+              << ", to flush " << percentiles(_interval.to_flush);
+      _interval.to_write.reset();
+      _interval.to_flush.reset();
+      _last_summary = now;
+      return summary.str();
+   }
+
+ private:
+   static std::string percentiles(const LatencyHistogram& histogram) {
+      if (0 == histogram.count()) {
+         return "-";
+      }
+      auto us = [](std::chrono::nanoseconds duration) {
+         return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+      };
+      return "p50 " + us(histogram.percentile(50)) + " us, p99 " + us(histogram.percentile(99))
+             + " us, p99.9 " + us(histogram.percentile(99.9)) + " us, max " + us(histogram.max()) + " us";
+   }
+
+   bool _enabled;
+   std::chrono::seconds _summary_interval;
+   steady_time_point _last_summary;
+   LogLatency _total;
+   LogLatency _interval; // since the last summary
+   std::vector<steady_time_point> _unflushed; // creation times, on the steady clock, of entries not yet flushed
+   size_t _max_unflushed;
+};
@@ -0,0 +1,176 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <g3log/loglevels.hpp>
+
+/**
+* Per LEVELS limits that a sink can check before it spends any time on formatting a log entry.
+*
+* Sampling: keep on average 1 in N entries of a level, the choice is random (xorshift)
+*           so that periodic log patterns do not skew what is kept.
+* Rate limit: a token bucket per level. At most "per_second" entries with bursts of up to
+*           "burst" entries.
+*
+* Dropped entries are counted per level. The sink is expected to call @ref droppedReport
+* regularly and to write the (non empty) report in-band, that way the log itself tells
+* that entries are missing.
+*
+* Levels without limits are always allowed. Not thread safe, it is meant to live inside a sink.
+*/
+class LogLevelLimiter {
+ public:
+   using steady_time_point = std::chrono::steady_clock::time_point;
+
+   LogLevelLimiter()
+      : _report_interval(std::chrono::seconds(10))
+      , _last_report(std::chrono::steady_clock::now())
+      , _dropped_since_report(0)
+      , _random_state(0x9E3779B97F4A7C15ull) {}
+
+   /// @param one_in keeps on average 1 in @param one_in entries of @param level. 0 or 1 keeps all
+   void setSampling(const LEVELS& level, uint32_t one_in) {
+      limitFor(level).sample_one_in = std::max(one_in, uint32_t{1});
+   }
+
+   /// @param per_second max sustained entries per second of @param level. 0 removes the rate limit
+   /// @param burst max entries at once, defaults to @param per_second
+   void setRateLimit(const LEVELS& level, double per_second, double burst = 0) {
+      Limit& limit = limitFor(level);
+      limit.per_second = std::max(per_second, 0.0);
+      limit.burst = (burst > 0) ? burst : limit.per_second;
+      limit.tokens = limit.burst;
+      limit.refilled = std::chrono::steady_clock::now();
+   }
+
+   /// How often, at most, a dropped entries report is given
+   void setReportInterval(std::chrono::milliseconds interval) { _report_interval = interval; }
+
+   /// removes all limits, counters are kept
+   void clear() { _limits.clear(); }
+
+   bool enabled() const { return !_limits.empty(); }
+
+   /// @return true if an entry of @param level should be kept, false if it is dropped
+   bool allow(const LEVELS& level) {
+      if (_limits.empty()) {
+         return true;
+      }
+      auto it = _limits.find(level.value);
+      if (it == _limits.end()) {
+         return true;
+      }
+
+      Limit& limit = it->second;
+      if (isSampledOut(limit) || !takeToken(limit)) {
+         ++limit.dropped;
+         ++limit.dropped_since_report;
+         ++_dropped_since_report;
+         return false;
+      }
+      return true;
+   }
+
+   /// @return total dropped entries of @param level
+   uint64_t dropped(const LEVELS& level) const {
+      auto it = _limits.find(level.value);
+      return (it == _limits.end()) ? 0 : it->second.dropped;
+   }
+
+   /// @return a summary of entries dropped since the last report, or an empty string if nothing
+   /// was dropped or the report interval has not yet passed. @param force ignores the interval
+   std::string droppedReport(bool force = false) {
+      if (0 == _dropped_since_report) {
+         return {};
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (!force && (now - _last_report) < _report_interval) {
+         return {};
+      }
+
+      std::ostringstream report;
+      report << "g3sinks: dropped";
+      const char* separator = " ";
+      for (auto& entry : _limits) {
+         Limit& limit = entry.second;
+         if (limit.dropped_since_report) {
+            report << separator << limit.dropped_since_report << " " << limit.level.text;
+            separator = ", ";
+            limit.dropped_since_report = 0;
+         }
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_report);
+      report << " entries in the last " << elapsed.count() << " ms";
+      _dropped_since_report = 0;
+      _last_report = now;
+      return report.str();
+   }
+
+ private:
+   struct Limit {
+      explicit Limit(const LEVELS& lvl) : level(lvl) {}
+      LEVELS level;
+      uint32_t sample_one_in = 1;
+      double per_second = 0;
+      double burst = 0;
+      double tokens = 0;
+      steady_time_point refilled;
+      uint64_t dropped = 0;
+      uint64_t dropped_since_report = 0;
+   };
+
+   Limit& limitFor(const LEVELS& level) {
+      auto it = _limits.find(level.value);
+      if (it == _limits.end()) {
+         it = _limits.emplace(level.value, Limit{level}).first;
+      }
+      return it->second;
+   }
+
+   bool isSampledOut(Limit& limit) {
+      if (limit.sample_one_in <= 1) {
+         return false;
+      }
+      // xorshift64*
+      _random_state ^= _random_state >> 12;
+      _random_state ^= _random_state << 25;
+      _random_state ^= _random_state >> 27;
+      uint64_t random = _random_state * 0x2545F4914F6CDD1Dull;
+      return 0 != ((random >> 32) % limit.sample_one_in);
+   }
+
+   bool takeToken(Limit& limit) {
+      if (limit.per_second <= 0) {
+         return true;
+      }
+      auto now = std::chrono::steady_clock::now();
+      std::chrono::duration<double> elapsed = now - limit.refilled;
+      limit.refilled = now;
+      limit.tokens = std::min(limit.burst, limit.tokens + elapsed.count() * limit.per_second);
+      if (limit.tokens < 1.0) {
+         return false;
+      }
+      limit.tokens -= 1.0;
+      return true;
+   }
+
+   std::map<int, Limit> _limits; // key: LEVELS::value
+   std::chrono::milliseconds _report_interval;
+   steady_time_point _last_report;
+   uint64_t _dropped_since_report;
+   uint64_t _random_state;
+};
@@ -0,0 +1,52 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+/**
+* USDT (user statically defined tracing) probes of the sinks, provider "g3sinks".
+*
+* Built in with the CMake option CHOICE_USDT_PROBES, which defines G3SINKS_USDT_PROBES when
+* sys/sdt.h is found. A probe is a single nop in the code and a note in the ELF file, it costs
+* nothing until a tracer attaches to it. Without the option the probes compile to nothing.
+* The arguments are evaluated either way, keep them to values that are already at hand.
+*
+* Durations are given by the probes where the sink measures them anyway, otherwise
+* from the time between a *_start and its *_done probe. List the probes with
+*    bpftrace -l 'usdt:/usr/local/lib/libg3logrotate.so:*'
+* and e.g. see the write latency, in ns, of a running process with
+*    bpftrace -e 'usdt:/usr/local/lib/libg3logrotate.so:g3sinks:logrotate_write { @ns = hist(arg1); }' -p PID
+*
+* Probes                                      arguments
+*    logrotate_write                          bytes, latency ns (including a flush by the flush policy)
+*    logrotate_flush_start, logrotate_flush_done
+*    logrotate_rotate_start                   current log size
+*    logrotate_rotate_done                    1: rotated, 0: failed
+*    logrotate_compress_start                 log file name
+*    logrotate_compress_done                  input bytes, output bytes, 1: ok, 0: failed
+*    logrotate_expire_start
+*    logrotate_expire_done                    duration us
+*    syslog_start                             g3log level value
+*    syslog_done                              message bytes, 0 when dropped by a level limit
+*    filelog_start                            g3log level value
+*    filelog_done                             record bytes, 1: buffered, 0: written
+*/
+#if defined(G3SINKS_USDT_PROBES)
+#include <sys/sdt.h>
+#define G3SINKS_PROBE(name) DTRACE_PROBE(g3sinks, name)
+#define G3SINKS_PROBE1(name, a1) DTRACE_PROBE1(g3sinks, name, a1)
+#define G3SINKS_PROBE2(name, a1, a2) DTRACE_PROBE2(g3sinks, name, a1, a2)
+#define G3SINKS_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(g3sinks, name, a1, a2, a3)
+#else
+#define G3SINKS_PROBE(name) ((void)0)
+#define G3SINKS_PROBE1(name, a1) ((void)(a1))
+#define G3SINKS_PROBE2(name, a1, a2) ((void)(a1), (void)(a2))
+#define G3SINKS_PROBE3(name, a1, a2, a3) ((void)(a1), (void)(a2), (void)(a3))
+#endif
@@ -0,0 +1,240 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+// The sink configurations of g3sinks_loadgen and g3sinks_replay: a counting sink that is always added,
+// and a choice of LogRotate, LogRotateWithFilter, SyslogSink and FileLogSink with their latency measured
+
+#include <g3log/logworker.hpp>
+#include <g3sinks/LatencyHistogram.h>
+#include <g3sinks/LogLatencyTracker.h>
+#include <g3sinks/LogRotate.h>
+#include <g3sinks/LogRotateWithFilter.h>
+#if defined(G3SINKS_LOADGEN_SYSLOG)
+#include <g3sinks/syslogsink.hpp>
+#endif
+#if defined(G3SINKS_LOADGEN_FILELOG)
+#include <g3sinks/FileLogSink.h>
+#include <fcntl.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/// @return the user and system CPU time of the process, all threads
+inline std::chrono::microseconds processCpuTime() {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+   FILETIME creation, exit, kernel, user;
+   if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+      return std::chrono::microseconds(0);
+   }
+   auto us = [](const FILETIME& time) { // in 100 ns ticks
+      ULARGE_INTEGER ticks;
+      ticks.LowPart = time.dwLowDateTime;
+      ticks.HighPart = time.dwHighDateTime;
+      return std::chrono::microseconds(ticks.QuadPart / 10);
+   };
+   return us(kernel) + us(user);
+#else
+   rusage usage{};
+   getrusage(RUSAGE_SELF, &usage);
+   auto us = [](const timeval& time) { return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec); };
+   return us(usage.ru_utime) + us(usage.ru_stime);
+#endif
+}
+
+struct LoadSinkOptions {
+   std::string sinks = "logrotate";
+   std::string directory = "./";
+   std::string log_prefix = "g3sinks_load";
+   size_t flush_policy = 1;
+   std::string syslog_socket = "/dev/log";
+   std::string filelog_path = "/dev/null";
+   size_t filelog_buffer = 0;
+
+   static const char* usage() {
+      return "[--sinks logrotate,filter,syslog,filelog,null] [--dir DIRECTORY] [--flush-policy N]\n"
+             "   [--syslog-socket PATH] [--filelog-path PATH] [--filelog-buffer BYTES]";
+   }
+
+   /// @return true if argv[i] is a sink option, @param i is then moved past its value
+   bool parse(int argc, char** argv, int& i) {
+      std::string argument = argv[i];
+      if (i + 1 >= argc) {
+         return false;
+      }
+      if ("--sinks" == argument) {
+         sinks = argv[++i];
+      } else if ("--dir" == argument) {
+         directory = argv[++i];
+      } else if ("--flush-policy" == argument) {
+         flush_policy = std::strtoul(argv[++i], nullptr, 10);
+      } else if ("--syslog-socket" == argument) {
+         syslog_socket = argv[++i];
+      } else if ("--filelog-path" == argument) {
+         filelog_path = argv[++i];
+      } else if ("--filelog-buffer" == argument) {
+         filelog_buffer = std::strtoul(argv[++i], nullptr, 10);
+      } else {
+         return false;
+      }
+      return true;
+   }
+
+   bool has(const std::string& name) const {
+      std::stringstream list(sinks);
+      std::string sink;
+      while (std::getline(list, sink, ',')) {
+         if (sink == name) {
+            return true;
+         }
+      }
+      return false;
+   }
+};
+
+/// Counts what g3log delivers and measures the time from the LOG call until it is delivered.
+/// The count is atomic so that it can be read while the sink is behind, a sink handle call would wait
+struct CountingSink {
+   std::atomic<uint64_t> received{0};
+   LogLatencyTracker latency;
+
+   CountingSink() { latency.enable(true, std::chrono::seconds(0)); }
+
+   void ReceiveLogMessage(g3::LogMessageMover message) {
+      latency.written(message.get()._timestamp);
+      received.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   LogLatency latencies() { return latency.latency(); }
+};
+
+/// Adds the sinks of the options to a LogWorker and collects their latency
+class LoadSinks {
+ public:
+   LoadSinks(g3::LogWorker& logworker, const LoadSinkOptions& options) {
+      using namespace g3;
+      auto counting = std::make_unique<CountingSink>();
+      _counting = counting.get(); // owned by the worker, only the atomic count is read directly
+      _countingHandle = logworker.addSink(std::move(counting), &CountingSink::ReceiveLogMessage);
+
+      if (options.has("logrotate")) {
+         auto logrotate = std::make_unique<LogRotate>(options.log_prefix, options.directory);
+         logrotate->setFlushPolicy(options.flush_policy);
+         _logrotateHandle = logworker.addSink(std::move(logrotate), &LogRotate::save);
+      }
+      if (options.has("filter")) {
+         auto filter = LogRotateWithFilter::CreateLogRotateWithFilter(options.log_prefix + "_filtered", options.directory, {G3LOG_DEBUG});
+         filter->setFlushPolicy(options.flush_policy);
+         filter->setLatencyTracking(true, std::chrono::seconds(0));
+         _filterHandle = logworker.addSink(std::move(filter), &LogRotateWithFilter::save);
+      }
+#if defined(G3SINKS_LOADGEN_SYSLOG)
+      if (options.has("syslog")) {
+         auto syslog = std::make_unique<SyslogSink>(options.log_prefix.c_str());
+         syslog->useDirectTransport(SyslogTransport::Format::RFC5424, options.syslog_socket);
+         syslog->setLatencyTracking(true, std::chrono::seconds(0));
+         _syslogHandle = logworker.addSink(std::move(syslog), &SyslogSink::syslog);
+      }
+#endif
+#if defined(G3SINKS_LOADGEN_FILELOG)
+      if (options.has("filelog")) {
+         int fd = open(options.filelog_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+         if (fd < 0) {
+            std::cerr << "cannot open " << options.filelog_path << std::endl;
+            _ok = false;
+            return;
+         }
+         auto filelog = std::make_unique<FileLogSink>(fd, true);
+         FileLogSink::FlushPolicy policy;
+         policy.max_bytes = options.filelog_buffer;
+         filelog->setFlushPolicy(policy);
+         filelog->setLatencyTracking(true, std::chrono::seconds(0));
+         _filelogHandle = logworker.addSink(std::move(filelog), &FileLogSink::ReceiveLogMessage);
+      }
+#endif
+   }
+
+   bool ok() const { return _ok; }
+
+   /// Messages delivered by g3log, can be read at any time
+   uint64_t received() const { return _counting->received.load(std::memory_order_relaxed); }
+
+   /// Waits for the sinks to catch up, the calls are queued behind the log messages
+   /// @return the latency histograms by name
+   std::vector<std::pair<std::string, LatencyHistogram>> latencies() {
+      std::vector<std::pair<std::string, LatencyHistogram>> latencies;
+      latencies.emplace_back("LOG call to g3log dispatch", _countingHandle->call(&CountingSink::latencies).get().to_write);
+      if (_logrotateHandle) {
+         latencies.emplace_back("LogRotate write", _logrotateHandle->call(&LogRotate::stats).get().write_latency);
+      }
+      if (_filterHandle) {
+         auto latency = _filterHandle->call(&LogRotateWithFilter::latency).get();
+         latencies.emplace_back("LOG call to LogRotateWithFilter write", latency.to_write);
+         latencies.emplace_back("LOG call to LogRotateWithFilter flush", latency.to_flush);
+      }
+#if defined(G3SINKS_LOADGEN_SYSLOG)
+      if (_syslogHandle) {
+         auto latency = _syslogHandle->call(&g3::SyslogSink::latency).get();
+         latencies.emplace_back("LOG call to SyslogSink write", latency.to_write);
+         latencies.emplace_back("LOG call to SyslogSink send", latency.to_flush);
+      }
+#endif
+#if defined(G3SINKS_LOADGEN_FILELOG)
+      if (_filelogHandle) {
+         auto latency = _filelogHandle->call(&FileLogSink::latency).get();
+         latencies.emplace_back("LOG call to FileLogSink write", latency.to_write);
+         latencies.emplace_back("LOG call to FileLogSink flush", latency.to_flush);
+      }
+#endif
+      return latencies;
+   }
+
+   static void printLatency(const std::string& name, const LatencyHistogram& histogram) {
+      if (0 == histogram.count()) {
+         return;
+      }
+      auto us = [](std::chrono::nanoseconds duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+      std::cout << "   " << std::left << std::setw(38) << name << std::right
+                << " p50 " << std::setw(8) << us(histogram.percentile(50)) << " us"
+                << "   p99 " << std::setw(8) << us(histogram.percentile(99)) << " us"
+                << "   p99.9 " << std::setw(8) << us(histogram.percentile(99.9)) << " us"
+                << "   max " << std::setw(8) << us(histogram.max()) << " us" << std::endl;
+   }
+
+ private:
+   bool _ok = true;
+   CountingSink* _counting = nullptr;
+   std::unique_ptr<g3::SinkHandle<CountingSink>> _countingHandle;
+   std::unique_ptr<g3::SinkHandle<LogRotate>> _logrotateHandle;
+   std::unique_ptr<g3::SinkHandle<LogRotateWithFilter>> _filterHandle;
+#if defined(G3SINKS_LOADGEN_SYSLOG)
+   std::unique_ptr<g3::SinkHandle<g3::SyslogSink>> _syslogHandle;
+#endif
+#if defined(G3SINKS_LOADGEN_FILELOG)
+   std::unique_ptr<g3::SinkHandle<FileLogSink>> _filelogHandle;
+#endif
+};
@@ -0,0 +1,59 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+// The times on the command lines of g3sinks_grep and g3sinks_merge, and their entries as they are in the log
+
+#include <g3sinks/LogFileReader.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+namespace LogEntryFormat {
+   /// @param text a time as in the log, "2026/10/18 12:00:00"
+   inline bool parseTime(const std::string& text, std::chrono::system_clock::time_point& result) {
+      return text.size() == LogFileParser::parseTimestamp(text.data(), text.size(), result);
+   }
+
+   /// @param text e.g. 90s, 15m, 2h or 1d
+   inline bool parseDuration(const std::string& text, std::chrono::seconds& result) {
+      char* end = nullptr;
+      long long count = std::strtoll(text.c_str(), &end, 10);
+      if (end == text.c_str() || count < 0) {
+         return false;
+      }
+      std::string unit(end);
+      const long long seconds = ("" == unit || "s" == unit) ? 1 : ("m" == unit) ? 60 : ("h" == unit) ? 3600 : ("d" == unit) ? 86400 : 0;
+      result = std::chrono::seconds(count * seconds);
+      return seconds > 0;
+   }
+
+   /// The entry as g3log's DefaultLogDetailsToString wrote it
+   inline std::string formatted(const LogFileEntry& entry) {
+      auto seconds = std::chrono::system_clock::to_time_t(entry.timestamp);
+      auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(entry.timestamp - std::chrono::system_clock::from_time_t(seconds));
+      struct tm local = {};
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+      localtime_s(&local, &seconds);
+#else
+      localtime_r(&seconds, &local);
+#endif
+      char timestamp[64];
+      size_t length = std::strftime(timestamp, sizeof(timestamp), "%Y/%m/%d %H:%M:%S", &local);
+      std::snprintf(timestamp + length, sizeof(timestamp) - length, " %06lld", static_cast<long long>(microseconds.count()));
+
+      std::string details = entry.thread.empty() ? "" : entry.thread + " ";
+      return std::string(timestamp) + "\t" + entry.level + " [" + details + entry.file + "->" + entry.function + ":"
+             + std::to_string(entry.line) + "]\t" + entry.message;
+   }
+} // LogEntryFormat
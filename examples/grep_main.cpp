@@ -0,0 +1,105 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_grep: searches the current log and the archives of a LogRotate by time range, level and text with
+// LogQueryEngine. The files are decompressed in parallel and the matches printed in timestamp order:
+//
+//    g3sinks_grep --source-dir DIRECTORY --prefix LOG_PREFIX [--from TIME] [--to TIME | --last DURATION]
+//                 [--level LEVEL,...] [-i] [-w] [--threads N] [TEXT]
+//
+// TIME is as in the log, "2026/10/18 12:00:00", DURATION is e.g. 90s, 15m, 2h or 1d before now.
+// -w matches TEXT as whole words, e.g. a request ID, which lets the archive Bloom filters check all its words.
+// Each match is printed as "file:line:" and the entry as it is in the log, a summary goes to stderr.
+
+#include <g3sinks/LogQuery.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "LogEntryFormat.h"
+
+namespace {
+   void usage() {
+      std::cerr << "usage: g3sinks_grep --source-dir DIRECTORY --prefix LOG_PREFIX [--from \"YYYY/mm/dd HH:MM:SS\"]\n"
+                << "   [--to \"YYYY/mm/dd HH:MM:SS\" | --last DURATION (e.g. 15m)] [--level LEVEL,...] [-i] [-w] [--threads N] [TEXT]"
+                << std::endl;
+   }
+
+   std::vector<std::string> split(const std::string& text) {
+      std::vector<std::string> parts;
+      std::stringstream stream(text);
+      std::string part;
+      while (std::getline(stream, part, ',')) {
+         if (!part.empty()) {
+            parts.push_back(part);
+         }
+      }
+      return parts;
+   }
+} // anonymous
+
+using namespace LogEntryFormat;
+
+int main(int argc, char** argv) {
+   std::string source_directory;
+   std::string prefix;
+   LogQuery query;
+   for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool has_value = i + 1 < argc;
+      std::chrono::seconds last{0};
+      if ("--source-dir" == arg && has_value) {
+         source_directory = argv[++i];
+      } else if ("--prefix" == arg && has_value) {
+         prefix = argv[++i];
+      } else if ("--from" == arg && has_value && parseTime(argv[i + 1], query.from)) {
+         ++i;
+      } else if ("--to" == arg && has_value && parseTime(argv[i + 1], query.to)) {
+         ++i;
+      } else if ("--last" == arg && has_value && parseDuration(argv[i + 1], last)) {
+         ++i;
+         query.from = std::chrono::system_clock::now() - last;
+      } else if ("--level" == arg && has_value) {
+         query.levels = split(argv[++i]);
+      } else if ("-i" == arg || "--ignore-case" == arg) {
+         query.ignore_case = true;
+      } else if ("-w" == arg || "--words" == arg) {
+         query.whole_words = true;
+      } else if ("--threads" == arg && has_value) {
+         query.threads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+      } else if (query.text.empty() && 0 != arg.compare(0, 1, "-")) {
+         query.text = arg;
+      } else {
+         usage();
+         return 1;
+      }
+   }
+   if (source_directory.empty() || prefix.empty()) {
+      usage();
+      return 1;
+   }
+   if ('/' != source_directory.back()) {
+      source_directory += "/";
+   }
+
+   auto start = std::chrono::steady_clock::now();
+   auto stats = LogQueryEngine::searchDirectory(source_directory, prefix, query, [](const std::string& path, const LogFileEntry& entry) {
+      std::cout << path << ":" << entry.line_number << ":" << formatted(entry) << "\n";
+      return true;
+   });
+   std::cout << std::flush;
+   auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cerr << stats.matches << " matches in " << stats.entries << " entries, " << (stats.bytes >> 20) << " MiB, " << elapsed << " s. "
+             << stats.files << " files: " << stats.skipped_by_time << " outside of the time range, " << stats.skipped_by_filter
+             << " ruled out by their Bloom filter" << std::endl;
+   return stats.matches > 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#include <g3log/g3log.hpp>
+#include <g3log/logworker.hpp>
+#include <g3log/loglevels.hpp>
+#include <memory>
+#include "g3sinks/journaldsink.hpp"
+
+// View the result with: journalctl -t g3journald -o verbose
+int main() {
+   using namespace g3;
+   {
+      auto sink = std::make_unique<g3::JournaldSink>("g3journald");
+
+      std::unique_ptr<LogWorker> logworker {LogWorker::createLogWorker()};
+      g3::initializeLogging(logworker.get());
+      auto sinkHandle = logworker->addSink(std::move(sink), &g3::JournaldSink::journal);
+
+      LOGF(INFO, "Hi journal %d", 123);
+      LOG(G3LOG_DEBUG) << "Test journal DEBUG";
+      LOG(WARNING) << "A message\nover several lines";
+      LOG(INFO) << "A large message that is sent with a memfd: " << std::string(1024 * 1024, '.');
+   }
+   return 0;
+}
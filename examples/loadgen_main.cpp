@@ -0,0 +1,232 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_loadgen: N producer threads LOG through g3log's LogWorker into a chosen set of sinks,
+// at a target rate or flat out. Reports, every second and at the end, the sustained throughput, how far
+// the sinks fall behind the producers (queue growth), the CPU time per message and latency percentiles.
+//
+//    g3sinks_loadgen [--threads N] [--rate MSG_PER_SECOND_PER_THREAD] [--duration SECONDS] [--size BYTES]
+//                    [--levels DEBUG:10,INFO:80,WARNING:10] [--sinks logrotate,filter,syslog,filelog,null]
+//                    [--dir DIRECTORY] [--flush-policy N] [--syslog-socket PATH] [--filelog-path PATH]
+//                    [--filelog-buffer BYTES]
+//
+// --rate 0 is flat out. "null" only counts the messages, i.e. it measures g3log itself.
+// A counting sink is always added: it gives the consumed count, and the latency from the LOG call until
+// g3log has dispatched the message. The other latencies are measured by the sinks themselves.
+
+#include <g3log/g3log.hpp>
+#include <g3log/logworker.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "LoadSinks.h"
+
+namespace {
+   using Clock = std::chrono::steady_clock;
+
+   struct Options {
+      size_t threads = 4;
+      double rate = 0; // per thread, 0: flat out
+      double duration = 10; // seconds
+      size_t size = 128;
+      std::string levels = "DEBUG:10,INFO:80,WARNING:10";
+      LoadSinkOptions sinks;
+   };
+
+   void usage() {
+      std::cerr << "usage: g3sinks_loadgen [--threads N] [--rate MSG_PER_SECOND_PER_THREAD] [--duration SECONDS] [--size BYTES]\n"
+                << "   [--levels DEBUG:10,INFO:80,WARNING:10] " << LoadSinkOptions::usage() << std::endl;
+   }
+
+   /// @return 100 levels, in the proportion of the "LEVEL:weight,..." mix, to pick from round robin
+   std::vector<LEVELS> levelMix(const std::string& mix) {
+      std::vector<std::pair<LEVELS, double>> weights;
+      double total = 0;
+      std::stringstream entries(mix);
+      std::string entry;
+      while (std::getline(entries, entry, ',')) {
+         auto colon = entry.find(':');
+         std::string name = entry.substr(0, colon);
+         double weight = (colon == std::string::npos) ? 1 : std::atof(entry.c_str() + colon + 1);
+         if ("DEBUG" == name) {
+            weights.emplace_back(G3LOG_DEBUG, weight);
+         } else if ("INFO" == name) {
+            weights.emplace_back(INFO, weight);
+         } else if ("WARNING" == name) {
+            weights.emplace_back(WARNING, weight);
+         } else {
+            std::cerr << "g3sinks_loadgen: unknown level " << name << ", use DEBUG, INFO or WARNING" << std::endl;
+            continue;
+         }
+         total += weight;
+      }
+      std::vector<LEVELS> levels;
+      for (auto& weight : weights) {
+         size_t count = static_cast<size_t>(weight.second / total * 100 + 0.5);
+         levels.insert(levels.end(), count, weight.first);
+      }
+      if (levels.empty()) {
+         levels.push_back(INFO);
+      }
+      return levels;
+   }
+
+   struct alignas(64) ProducerCounter {
+      std::atomic<uint64_t> produced{0};
+   };
+
+   void produce(const Options& options, const std::vector<LEVELS>& levels, const std::string& payload,
+                std::atomic<bool>& stop, ProducerCounter& counter, size_t thread_index) {
+      auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.rate > 0 ? 1.0 / options.rate : 0));
+      auto next = Clock::now();
+      size_t level_index = thread_index * 37;
+      uint64_t produced = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+         if (options.rate > 0) {
+            next += interval;
+            auto now = Clock::now();
+            if (next > now) {
+               std::this_thread::sleep_until(next);
+            } else if (now - next > std::chrono::seconds(1)) {
+               next = now; // too far behind the target rate, do not try to catch up in a burst
+            }
+         }
+         LOG(levels[level_index++ % levels.size()]) << payload << " #" << produced;
+         counter.produced.store(++produced, std::memory_order_relaxed);
+      }
+   }
+
+   uint64_t totalProduced(const std::vector<ProducerCounter>& counters) {
+      uint64_t total = 0;
+      for (auto& counter : counters) {
+         total += counter.produced.load(std::memory_order_relaxed);
+      }
+      return total;
+   }
+} // anonymous
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      std::string argument = argv[i];
+      bool has_value = (i + 1 < argc);
+      if ("--threads" == argument && has_value) {
+         options.threads = std::strtoul(argv[++i], nullptr, 10);
+      } else if ("--rate" == argument && has_value) {
+         options.rate = std::atof(argv[++i]);
+      } else if ("--duration" == argument && has_value) {
+         options.duration = std::atof(argv[++i]);
+      } else if ("--size" == argument && has_value) {
+         options.size = std::strtoul(argv[++i], nullptr, 10);
+      } else if ("--levels" == argument && has_value) {
+         options.levels = argv[++i];
+      } else if (options.sinks.parse(argc, argv, i)) {
+         // a sink option and its value
+      } else if ("-h" == argument || "--help" == argument) {
+         usage();
+         return 0;
+      } else {
+         std::cerr << "g3sinks_loadgen: unknown argument " << argument << std::endl;
+         usage();
+         return 1;
+      }
+   }
+   options.threads = std::max(options.threads, size_t{1});
+
+   const auto levels = levelMix(options.levels);
+   const std::string payload(options.size, 'x');
+   std::vector<ProducerCounter> counters(options.threads);
+   uint64_t produced = 0;
+   uint64_t consumed = 0;
+   auto cpu_start = processCpuTime();
+   auto start = Clock::now();
+   double produce_seconds = 0;
+   double drain_seconds = 0;
+   std::vector<std::pair<std::string, LatencyHistogram>> latencies;
+   {
+      using namespace g3;
+      std::unique_ptr<LogWorker> logworker{LogWorker::createLogWorker()};
+      initializeLogging(logworker.get());
+
+      options.sinks.log_prefix = "g3sinks_loadgen";
+      LoadSinks sinks(*logworker, options.sinks);
+      if (!sinks.ok()) {
+         return 1;
+      }
+
+      std::cout << "g3sinks_loadgen: " << options.threads << " threads, "
+                << (options.rate > 0 ? std::to_string(static_cast<uint64_t>(options.rate)) + " msg/s each" : std::string("flat out"))
+                << ", " << options.size << " bytes, levels " << options.levels << ", sinks " << options.sinks.sinks << std::endl;
+      std::cout << "   time s     produced/s     consumed/s        backlog" << std::endl;
+
+      std::atomic<bool> stop{false};
+      std::vector<std::thread> producers;
+      for (size_t i = 0; i < options.threads; ++i) {
+         producers.emplace_back(produce, std::cref(options), std::cref(levels), std::cref(payload), std::ref(stop), std::ref(counters[i]), i);
+      }
+
+      // the backlog is what the producers have logged but the counting sink has not yet received
+      auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+      auto report = start;
+      uint64_t last_produced = 0;
+      uint64_t last_consumed = 0;
+      while (Clock::now() < end) {
+         report += std::chrono::seconds(1);
+         std::this_thread::sleep_until(std::min(report, end));
+         auto now_produced = totalProduced(counters);
+         auto now_consumed = sinks.received();
+         double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+         std::cout << std::fixed << std::setprecision(1) << std::setw(9) << seconds
+                   << std::setw(15) << (now_produced - last_produced) << std::setw(15) << (now_consumed - last_consumed)
+                   << std::setw(15) << (now_produced - now_consumed) << std::endl;
+         last_produced = now_produced;
+         last_consumed = now_consumed;
+      }
+      stop = true;
+      for (auto& producer : producers) {
+         producer.join();
+      }
+      produced = totalProduced(counters);
+      auto produce_end = Clock::now();
+      produce_seconds = std::chrono::duration<double>(produce_end - start).count();
+
+      // every sink has caught up when it answers, the calls are queued behind the log messages
+      while (sinks.received() < produced) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      consumed = sinks.received();
+      latencies = sinks.latencies();
+      drain_seconds = std::chrono::duration<double>(Clock::now() - produce_end).count();
+   } // the sinks and the worker exit
+   auto cpu = processCpuTime() - cpu_start;
+
+   std::cout << "\nlatency" << std::endl;
+   for (auto& latency : latencies) {
+      LoadSinks::printLatency(latency.first, latency.second);
+   }
+
+   std::cout << std::fixed << std::setprecision(0)
+             << "\nproduced " << produced << " messages in " << std::setprecision(2) << produce_seconds << " s, "
+             << std::setprecision(0) << produced / std::max(produce_seconds, 1e-9) << " msg/s" << std::endl;
+   std::cout << "sustained " << consumed / std::max(produce_seconds + drain_seconds, 1e-9) << " msg/s, the sinks needed "
+             << std::setprecision(2) << drain_seconds << " s to catch up after the producers stopped" << std::endl;
+   std::cout << "cpu " << std::setprecision(3) << static_cast<double>(cpu.count()) / std::max<double>(static_cast<double>(produced), 1)
+             << " us per message (all threads)" << std::endl;
+   return 0;
+}
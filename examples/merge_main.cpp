@@ -0,0 +1,110 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_merge: merges the archives and current logs of several LogRotates, e.g. of the processes of a
+// service, into one stream in timestamp order with LogMerger. With --follow it goes on with what is
+// written, like tail -f, and through the rotations (not on Windows):
+//
+//    g3sinks_merge --source DIRECTORY:LOG_PREFIX --source ... [--from TIME | --last DURATION]
+//                  [--follow] [--follow-delay MILLISECONDS]
+//
+// TIME is as in the log, "2026/10/18 12:00:00", DURATION is e.g. 90s, 15m, 2h or 1d before now.
+// Each entry is printed as "[LOG_PREFIX]" and the entry as it is in the log.
+
+#include <g3sinks/LogMerge.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "LogEntryFormat.h"
+
+namespace {
+   LogMerger* g_merger = nullptr;
+
+   void usage() {
+      std::cerr << "usage: g3sinks_merge --source DIRECTORY:LOG_PREFIX [--source DIRECTORY:LOG_PREFIX ...]\n"
+                << "   [--from \"YYYY/mm/dd HH:MM:SS\" | --last DURATION (e.g. 15m)] [--follow] [--follow-delay MILLISECONDS]"
+                << std::endl;
+   }
+
+   bool parseSource(const std::string& text, LogMergeSource& source) {
+      auto colon = text.rfind(':');
+      if (std::string::npos == colon || 0 == colon || colon + 1 == text.size()) {
+         return false;
+      }
+      source.dir = text.substr(0, colon);
+      source.prefix = text.substr(colon + 1);
+      if ('/' != source.dir.back()) {
+         source.dir += "/";
+      }
+      return true;
+   }
+
+   void stopFollowing(int) {
+      if (nullptr != g_merger) {
+         g_merger->stop();
+      }
+   }
+} // anonymous
+
+using namespace LogEntryFormat;
+
+int main(int argc, char** argv) {
+   std::vector<LogMergeSource> sources;
+   LogMergeOptions options;
+   for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool has_value = i + 1 < argc;
+      std::chrono::seconds last{0};
+      LogMergeSource source;
+      if ("--source" == arg && has_value && parseSource(argv[i + 1], source)) {
+         ++i;
+         sources.push_back(source);
+      } else if ("--from" == arg && has_value && parseTime(argv[i + 1], options.from)) {
+         ++i;
+      } else if ("--last" == arg && has_value && parseDuration(argv[i + 1], last)) {
+         ++i;
+         options.from = std::chrono::system_clock::now() - last;
+      } else if ("--follow" == arg || "-f" == arg) {
+         options.follow = true;
+      } else if ("--follow-delay" == arg && has_value) {
+         options.follow_delay = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+      } else {
+         usage();
+         return 1;
+      }
+   }
+   if (sources.empty()) {
+      usage();
+      return 1;
+   }
+
+   LogMerger merger(sources, options);
+   g_merger = &merger;
+   std::signal(SIGINT, stopFollowing);
+   std::signal(SIGTERM, stopFollowing);
+
+   LogFileEntry entry;
+   size_t source = 0;
+   uint64_t entries = 0;
+   while (merger.next(entry, source)) {
+      std::cout << "[" << sources[source].prefix << "] " << formatted(entry) << "\n";
+      if (options.follow) {
+         std::cout << std::flush;
+      }
+      ++entries;
+   }
+   std::cout << std::flush;
+   g_merger = nullptr;
+   std::cerr << entries << " entries from " << sources.size() << " sources" << std::endl;
+   return 0;
+}
@@ -0,0 +1,254 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_replay: replays real logs written by LogRotate, the current .log and the .log.*.gz archives,
+// through g3log's LogWorker into a chosen set of sinks. Every entry is logged again with its original level,
+// file, line, function and message, multi line messages such as stack traces included, at its original
+// time relative to the first entry, divided by --speed. Bursts and quiet periods are kept as they were.
+//
+//    g3sinks_replay (--source-dir DIRECTORY --prefix LOG_PREFIX | --file LOG_OR_ARCHIVE ...)
+//                   [--speed FACTOR] [--max-gap SECONDS] [--sinks logrotate,filter,syslog,filelog,null] [--dir DIRECTORY] ...
+//
+// --speed 1 replays in real time, 10 ten times faster, 0 as fast as possible. --max-gap shortens quiet periods.
+// The replayed entries get new timestamps, the latency percentiles are measured from when they are replayed.
+
+#include <g3log/g3log.hpp>
+#include <g3log/logworker.hpp>
+#include <g3sinks/LatencyHistogram.h>
+#include <g3sinks/LogFileReader.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "LoadSinks.h"
+
+namespace {
+   using Clock = std::chrono::steady_clock;
+
+   struct Options {
+      std::string source_directory;
+      std::string prefix;
+      std::vector<std::string> files;
+      double speed = 1; // 0: as fast as possible
+      double max_gap = 0; // seconds, 0: quiet periods are kept
+      LoadSinkOptions sinks;
+   };
+
+   void usage() {
+      std::cerr << "usage: g3sinks_replay (--source-dir DIRECTORY --prefix LOG_PREFIX | --file LOG_OR_ARCHIVE ...)\n"
+                << "   [--speed FACTOR] [--max-gap SECONDS] " << LoadSinkOptions::usage() << std::endl;
+   }
+
+   /// @return the g3log level of a level name from a log, levels that g3log does not know keep their name
+   LEVELS levelFromName(const std::string& name) {
+      static std::map<std::string, LEVELS> levels = {
+         {G3LOG_DEBUG.text, G3LOG_DEBUG}, {INFO.text, INFO}, {WARNING.text, WARNING}, {FATAL.text, FATAL}};
+      auto level = levels.find(name);
+      if (level == levels.end()) {
+         level = levels.emplace(name, LEVELS(INFO.value, name)).first;
+      }
+      return level->second;
+   }
+
+   /// What the replayed logs look like
+   struct TraceShape {
+      uint64_t entries = 0;
+      uint64_t bytes = 0;
+      size_t largest_entry = 0;
+      uint64_t multi_line_entries = 0;
+      std::map<std::string, uint64_t> levels;
+      std::chrono::nanoseconds span{0}; // original time from the first to the last entry
+      std::chrono::nanoseconds longest_gap{0};
+      uint64_t busiest_second = 0; // most entries within one second of original time
+   };
+} // anonymous
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      std::string argument = argv[i];
+      bool has_value = (i + 1 < argc);
+      if ("--source-dir" == argument && has_value) {
+         options.source_directory = argv[++i];
+      } else if ("--prefix" == argument && has_value) {
+         options.prefix = argv[++i];
+      } else if ("--file" == argument && has_value) {
+         options.files.push_back(argv[++i]);
+      } else if ("--speed" == argument && has_value) {
+         options.speed = std::atof(argv[++i]);
+      } else if ("--max-gap" == argument && has_value) {
+         options.max_gap = std::atof(argv[++i]);
+      } else if (options.sinks.parse(argc, argv, i)) {
+         // a sink option and its value
+      } else if ("-h" == argument || "--help" == argument) {
+         usage();
+         return 0;
+      } else {
+         std::cerr << "g3sinks_replay: unknown argument " << argument << std::endl;
+         usage();
+         return 1;
+      }
+   }
+   if (!options.prefix.empty()) {
+      auto files = LogRotateUtility::getLogFileSet(options.source_directory.empty() ? "./" : options.source_directory, options.prefix);
+      options.files.insert(options.files.end(), files.begin(), files.end());
+   }
+   if (options.files.empty()) {
+      std::cerr << "g3sinks_replay: no logs to replay" << std::endl;
+      usage();
+      return 1;
+   }
+
+   TraceShape shape;
+   LatencyHistogram schedule_lag; // how late entries were replayed compared to their original timing
+   std::atomic<uint64_t> replayed{0};
+   uint64_t consumed = 0;
+   auto cpu_start = processCpuTime();
+   auto start = Clock::now();
+   double replay_seconds = 0;
+   double drain_seconds = 0;
+   std::vector<std::pair<std::string, LatencyHistogram>> latencies;
+   {
+      using namespace g3;
+      std::unique_ptr<LogWorker> logworker{LogWorker::createLogWorker()};
+      initializeLogging(logworker.get());
+
+      options.sinks.log_prefix = "g3sinks_replay";
+      LoadSinks sinks(*logworker, options.sinks);
+      if (!sinks.ok()) {
+         return 1;
+      }
+
+      std::cout << "g3sinks_replay: " << options.files.size() << " logs, speed "
+                << (options.speed > 0 ? std::to_string(options.speed) : std::string("flat out")) << ", sinks " << options.sinks.sinks << std::endl;
+      std::cout << "   time s     replayed/s     consumed/s        backlog" << std::endl;
+
+      // the backlog is what was replayed but the counting sink has not yet received
+      std::atomic<bool> done{false};
+      std::thread reporter([&] {
+         auto report = start;
+         uint64_t last_replayed = 0;
+         uint64_t last_consumed = 0;
+         while (!done.load()) {
+            report += std::chrono::seconds(1);
+            while (!done.load() && Clock::now() < report) {
+               std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            auto now_replayed = replayed.load(std::memory_order_relaxed);
+            auto now_consumed = sinks.received();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::cout << std::fixed << std::setprecision(1) << std::setw(9) << seconds
+                      << std::setw(15) << (now_replayed - last_replayed) << std::setw(15) << (now_consumed - last_consumed)
+                      << std::setw(15) << (now_replayed - now_consumed) << std::endl;
+            last_replayed = now_replayed;
+            last_consumed = now_consumed;
+         }
+      });
+
+      const auto max_gap = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(options.max_gap));
+      bool first = true;
+      std::chrono::system_clock::time_point previous;
+      std::chrono::nanoseconds schedule{0}; // original time since the first entry, with the gaps shortened
+      std::chrono::system_clock::time_point second_start;
+      uint64_t in_second = 0;
+      LogFileEntry entry;
+      for (auto& file : options.files) {
+         LogFileReader reader(file);
+         while (reader.next(entry)) {
+            auto gap = first ? std::chrono::nanoseconds(0) : std::chrono::duration_cast<std::chrono::nanoseconds>(entry.timestamp - previous);
+            gap = std::max(gap, std::chrono::nanoseconds(0)); // the clock was set back
+            shape.span += gap;
+            shape.longest_gap = std::max(shape.longest_gap, gap);
+            if (max_gap.count() > 0) {
+               gap = std::min(gap, max_gap);
+            }
+            schedule += gap;
+            if (first || entry.timestamp - second_start >= std::chrono::seconds(1)) {
+               second_start = entry.timestamp;
+               in_second = 0;
+            }
+            shape.busiest_second = std::max(shape.busiest_second, ++in_second);
+            previous = entry.timestamp;
+            first = false;
+
+            if (options.speed > 0) {
+               auto due = start + std::chrono::duration_cast<Clock::duration>(schedule / options.speed);
+               auto now = Clock::now();
+               if (due > now) {
+                  std::this_thread::sleep_until(due);
+               } else {
+                  schedule_lag.record(now - due);
+               }
+            }
+
+            std::unique_ptr<LogMessage> message(new LogMessage(entry.file, entry.line, entry.function, levelFromName(entry.level)));
+            message->write().append(entry.message);
+            logworker->save(LogMessagePtr(std::move(message)));
+            replayed.fetch_add(1, std::memory_order_relaxed);
+
+            ++shape.entries;
+            shape.bytes += entry.size;
+            shape.largest_entry = std::max(shape.largest_entry, entry.size);
+            shape.multi_line_entries += (entry.message.find('\n') != std::string::npos) ? 1 : 0;
+            ++shape.levels[entry.level];
+         }
+         if (reader.skippedLines() > 0) {
+            std::cerr << "g3sinks_replay: " << reader.skippedLines() << " lines in " << file << " are not part of a log entry" << std::endl;
+         }
+      }
+      auto replay_end = Clock::now();
+      replay_seconds = std::chrono::duration<double>(replay_end - start).count();
+
+      // every sink has caught up when it answers, the calls are queued behind the log messages
+      while (sinks.received() < shape.entries) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      consumed = sinks.received();
+      latencies = sinks.latencies();
+      drain_seconds = std::chrono::duration<double>(Clock::now() - replay_end).count();
+      done = true;
+      reporter.join();
+   } // the sinks and the worker exit
+   auto cpu = processCpuTime() - cpu_start;
+
+   auto seconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double>(duration).count(); };
+   std::cout << std::fixed << std::setprecision(2)
+             << "\ntrace: " << shape.entries << " entries, " << shape.bytes << " bytes over " << seconds(shape.span) << " s, "
+             << "largest entry " << shape.largest_entry << " bytes, " << shape.multi_line_entries << " multi line entries, "
+             << "busiest second " << shape.busiest_second << " entries, longest gap " << seconds(shape.longest_gap) << " s" << std::endl;
+   std::cout << "levels:";
+   for (auto& level : shape.levels) {
+      std::cout << " " << level.first << " " << level.second;
+   }
+   std::cout << std::endl;
+
+   std::cout << "\nlatency" << std::endl;
+   for (auto& latency : latencies) {
+      LoadSinks::printLatency(latency.first, latency.second);
+   }
+   LoadSinks::printLatency("replay behind the original timing", schedule_lag);
+
+   std::cout << std::setprecision(0)
+             << "\nreplayed " << shape.entries << " entries in " << std::setprecision(2) << replay_seconds << " s, "
+             << std::setprecision(0) << shape.entries / std::max(replay_seconds, 1e-9) << " msg/s" << std::endl;
+   std::cout << "sustained " << consumed / std::max(replay_seconds + drain_seconds, 1e-9) << " msg/s, the sinks needed "
+             << std::setprecision(2) << drain_seconds << " s to catch up after the replay" << std::endl;
+   std::cout << "cpu " << std::setprecision(3) << static_cast<double>(cpu.count()) / std::max<double>(static_cast<double>(shape.entries), 1)
+             << " us per message, reading and parsing the logs included" << std::endl;
+   return 0;
+}
@@ -0,0 +1,122 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_search: finds the log entries that contain a text, e.g. a request ID, in the archives and the
+// current log of a LogRotate. Archives with a Bloom filter, see LogRotate::setArchiveBloomFilter, are only
+// decompressed when their filter says they may contain the text.
+//
+//    g3sinks_search --source-dir DIRECTORY --prefix LOG_PREFIX [--substring] TEXT
+//
+// Entries are printed as "file:line: LEVEL message", a summary of the searched and skipped archives goes to
+// stderr. TEXT is matched as whole words, e.g. a request ID, so that the filters can check each of its words.
+// --substring also matches TEXT inside longer words. The filters then cannot check the first and the last
+// word of TEXT, which may be the end and the start of longer words, and skip fewer archives.
+
+#include <g3sinks/LogFileReader.h>
+#include <g3sinks/TokenBloomFilter.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   struct Options {
+      std::string source_directory;
+      std::string prefix;
+      std::string text;
+      bool whole_words = true;
+   };
+
+   void usage() {
+      std::cerr << "usage: g3sinks_search --source-dir DIRECTORY --prefix LOG_PREFIX [--substring] TEXT" << std::endl;
+   }
+
+   bool isWordChar(char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+   }
+
+   bool matches(const std::string& message, const Options& options) {
+      for (size_t found = message.find(options.text); found != std::string::npos; found = message.find(options.text, found + 1)) {
+         if (!options.whole_words) {
+            return true;
+         }
+         // a word of TEXT cannot continue before or after it
+         size_t end = found + options.text.size();
+         bool starts_word = !isWordChar(options.text.front()) || 0 == found || !isWordChar(message[found - 1]);
+         bool ends_word = !isWordChar(options.text.back()) || message.size() == end || !isWordChar(message[end]);
+         if (starts_word && ends_word) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   bool isArchive(const std::string& path) {
+      return path.size() > 3 && 0 == path.compare(path.size() - 3, 3, ".gz");
+   }
+} // anonymous
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      if ("--source-dir" == arg && i + 1 < argc) {
+         options.source_directory = argv[++i];
+      } else if ("--prefix" == arg && i + 1 < argc) {
+         options.prefix = argv[++i];
+      } else if ("--substring" == arg) {
+         options.whole_words = false;
+      } else if (options.text.empty() && 0 != arg.compare(0, 2, "--")) {
+         options.text = arg;
+      } else {
+         usage();
+         return 1;
+      }
+   }
+   if (options.source_directory.empty() || options.prefix.empty() || options.text.empty()) {
+      usage();
+      return 1;
+   }
+   if ('/' != options.source_directory.back()) {
+      options.source_directory += "/";
+   }
+
+   auto start = std::chrono::steady_clock::now();
+   uint64_t archives = 0;
+   uint64_t skipped = 0;
+   uint64_t without_filter = 0;
+   uint64_t matched = 0;
+   for (auto& file : LogRotateUtility::getLogFileSet(options.source_directory, options.prefix)) {
+      if (isArchive(file)) {
+         ++archives;
+         TokenBloomFilter filter;
+         if (!filter.load(ArchiveBloomFilter::filterFileName(file))) {
+            ++without_filter;
+         } else if (!filter.mayContain(options.text, options.whole_words)) {
+            ++skipped;
+            continue;
+         }
+      }
+      LogFileReader reader(file);
+      LogFileEntry entry;
+      while (reader.next(entry)) {
+         if (matches(entry.message, options)) {
+            ++matched;
+            std::cout << file << ":" << entry.line_number << ": " << entry.level << " " << entry.message << "\n";
+         }
+      }
+   }
+   auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+   std::cout << std::flush;
+   std::cerr << matched << " entries found in " << elapsed.count() << " ms. " << archives << " archives: " << (archives - skipped)
+             << " searched (" << without_filter << " without a Bloom filter), " << skipped << " skipped by their Bloom filter" << std::endl;
+   return matched > 0 ? 0 : 1;
+}
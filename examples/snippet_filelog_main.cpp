@@ -73,14 +73,16 @@ int main(int argc, char** argv) {
    LOG(INFO) << "This content is written to the first memory file descriptor";
    sleep(1); // TODO: wait for the logger to finish, in a cleaner way...
    int fd2 = new_mem_fd("memfile_2");
-   std::future<void> to_wait = sinkHandle->call(&FileLogSink::Rotate, fd2, true);
-   to_wait.wait();
+   // Rotate() returns at once, the old file descriptor is synced by a helper thread
+   std::future<std::future<bool>> rotated = sinkHandle->call(&FileLogSink::Rotate, fd2, true);
+   std::future<bool> synced = rotated.get();
+   std::cerr << "first memory file is synced: " << std::boolalpha << synced.get() << std::endl;
    content_to_stderr(fd1);
    close(fd1);
 
    LOG(INFO) << "This content is written to the second memory file descriptor";
    sleep(1); // TODO: wait for the logger to finish, in a cleaner way...
-   to_wait = sinkHandle->call(&FileLogSink::sync);
+   std::future<void> to_wait = sinkHandle->call(&FileLogSink::sync);
    to_wait.wait();
    content_to_stderr(fd2);
    close(fd2);
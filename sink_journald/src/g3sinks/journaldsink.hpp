@@ -0,0 +1,75 @@
+/* 2026, g3sinks
+ *
+ * A G3Log sink that writes to the systemd journal with journald's native protocol.
+ * It does not depend on libsystemd.
+ *
+ * Each log entry is sent as one datagram to the journal socket, /run/systemd/journal/socket,
+ * with the g3log details as separate journal fields:
+ *    MESSAGE, PRIORITY, CODE_FILE, CODE_LINE, CODE_FUNC, TID,
+ *    SYSLOG_IDENTIFIER, SYSLOG_FACILITY and G3LOG_LEVEL
+ * That way entries can be filtered on source location without parsing the message text, e.g.
+ *    journalctl CODE_FILE=main.cpp CODE_LINE=42
+ *
+ * TID is the g3log thread id of the LOG call, not the kernel thread id, since the entry is
+ * sent from the g3log worker thread.
+ *
+ * Entries that are too big for a datagram are written to a sealed memfd that is passed to
+ * journald over the socket. This is how journald itself expects large entries.
+ *
+ * Mapping between g3log LEVELS and journal PRIORITY is the same as for the SyslogSink
+ * and can be changed with setLevel() and setLevelMap().
+ *
+ * By default MESSAGE is the log message only, the details are already in the other fields.
+ * Use setFormatter() to add details to MESSAGE.
+ */
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace g3 {
+
+   struct LogMessage;
+
+   class JournaldSink {
+    public:
+      using LogLevel = LEVELS;
+      using LogDetailsFunc = std::string (*) (const LogMessage&);
+
+      explicit JournaldSink(const char* identity = "g3log", const std::string& socket_path = "/run/systemd/journal/socket");
+      virtual ~JournaldSink();
+
+      void journal(LogMessageMover message);
+
+      void setFormatter(LogDetailsFunc func) { _log_details_func = func; }
+      void setIdentity(const std::string& identity) { _identity = identity; }
+      void setFacility(int facility) { _facility = facility; } // LOG_USER, LOG_LOCAL0, ...
+      void setLevelMap(std::map<int, int> const& m) { _levelMap = m; }
+      void setLevel(LogLevel level, int priority) { _levelMap[level.value] = priority; }
+
+      uint64_t dropped() const { return _dropped; } // entries that journald did not get
+      bool isConnected() const { return _socket >= 0; }
+
+      static std::string NoDetails(const LogMessage&) { return {}; }
+
+    private:
+      bool connect();
+      void appendField(const char* name, const std::string& value);
+      void appendField(const char* name, const char* value, size_t size);
+      bool sendDatagram();
+      bool sendMemfd();
+      int priority(const LogLevel& level) const;
+
+      std::string _socket_path;
+      int _socket;
+      LogDetailsFunc _log_details_func;
+      std::map<int, int> _levelMap;
+      std::string _identity;
+      int _facility;
+      std::string _buffer; // the entry, reused between entries
+      uint64_t _dropped;
+
+      JournaldSink& operator=(JournaldSink const&) = delete;
+      JournaldSink(JournaldSink const& other) = delete;
+   };
+}
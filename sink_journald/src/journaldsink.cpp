@@ -0,0 +1,182 @@
+#include "g3log/logmessage.hpp"
+#include "g3sinks/journaldsink.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+namespace g3 {
+
+   JournaldSink::JournaldSink(const char* identity, const std::string& socket_path)
+      : _socket_path(socket_path)
+      , _socket(-1)
+      , _log_details_func(&JournaldSink::NoDetails)
+      , _identity(identity)
+      , _facility(LOG_USER)
+      , _dropped(0) {
+      _levelMap[G3LOG_DEBUG.value] = LOG_DEBUG;
+      _levelMap[INFO.value] = LOG_INFO;
+      _levelMap[(INFO.value + WARNING.value) / 2] = LOG_NOTICE;
+      _levelMap[WARNING.value] = LOG_WARNING;
+      _levelMap[FATAL.value] = LOG_CRIT;
+      _buffer.reserve(4096);
+      connect();
+   }
+
+   JournaldSink::~JournaldSink() {
+      if (_socket >= 0) {
+         ::close(_socket);
+      }
+   }
+
+   // The actual log receiving function
+   void JournaldSink::journal(LogMessageMover message) {
+      const LogMessage& entry = message.get();
+      _buffer.clear();
+
+      std::string text = entry.toString(_log_details_func);
+      size_t size = text.size();
+      while (size > 0 && '\n' == text[size - 1]) {
+         --size;
+      }
+      appendField("MESSAGE", text.data(), size);
+      appendField("PRIORITY", std::to_string(priority(entry._level)));
+      appendField("CODE_FILE", entry._file_path);
+      appendField("CODE_LINE", std::to_string(entry._line));
+      appendField("CODE_FUNC", entry._function);
+      appendField("TID", entry.threadID());
+      appendField("SYSLOG_IDENTIFIER", _identity);
+      appendField("SYSLOG_FACILITY", std::to_string(_facility >> 3));
+      appendField("G3LOG_LEVEL", entry._level.text);
+
+      if (_socket < 0 && !connect()) {
+         ++_dropped;
+         return;
+      }
+      if (!sendDatagram() && !sendMemfd()) {
+         ++_dropped;
+      }
+   }
+
+   bool JournaldSink::connect() {
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      if (_socket_path.size() >= sizeof(address.sun_path)) {
+         return false;
+      }
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, _socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+      _socket = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+      if (_socket < 0) {
+         return false;
+      }
+      if (0 != ::connect(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+         ::close(_socket);
+         _socket = -1;
+         return false;
+      }
+      return true;
+   }
+
+   void JournaldSink::appendField(const char* name, const std::string& value) {
+      appendField(name, value.data(), value.size());
+   }
+
+   /// Journal export format: NAME=value\n, or for values that contain a new line
+   /// NAME\n<64 bit little endian size><value>\n
+   void JournaldSink::appendField(const char* name, const char* value, size_t size) {
+      _buffer.append(name);
+      if (nullptr == std::memchr(value, '\n', size)) {
+         _buffer.push_back('=');
+         _buffer.append(value, size);
+         _buffer.push_back('\n');
+         return;
+      }
+
+      _buffer.push_back('\n');
+      uint64_t length = size;
+      for (int byte = 0; byte < 8; ++byte) {
+         _buffer.push_back(static_cast<char>((length >> (8 * byte)) & 0xff));
+      }
+      _buffer.append(value, size);
+      _buffer.push_back('\n');
+   }
+
+   bool JournaldSink::sendDatagram() {
+      for (int attempt = 0; attempt < 2; ++attempt) {
+         if (::send(_socket, _buffer.data(), _buffer.size(), MSG_NOSIGNAL) >= 0) {
+            return true;
+         }
+         if (EINTR == errno) {
+            continue;
+         }
+         if (ECONNREFUSED == errno || ENOTCONN == errno) {
+            ::close(_socket); // journald was restarted
+            _socket = -1;
+            if (connect()) {
+               continue;
+            }
+         }
+         break;
+      }
+      return false;
+   }
+
+   /// Too big for a datagram: the entry is written to a memfd that is sealed, so that journald can
+   /// trust its content, and the file descriptor is passed to journald
+   bool JournaldSink::sendMemfd() {
+      if (_socket < 0 || (EMSGSIZE != errno && ENOBUFS != errno)) {
+         return false;
+      }
+      int fd = ::memfd_create("g3sinks-journal", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+      if (fd < 0) {
+         return false;
+      }
+
+      bool sent = false;
+      size_t written = 0;
+      while (written < _buffer.size()) {
+         auto result = ::write(fd, _buffer.data() + written, _buffer.size() - written);
+         if (result < 0 && EINTR == errno) {
+            continue;
+         }
+         if (result <= 0) {
+            break;
+         }
+         written += static_cast<size_t>(result);
+      }
+
+      if (written == _buffer.size() && 0 == ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)) {
+         union {
+            cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(int))];
+         } control;
+         std::memset(&control, 0, sizeof(control));
+         msghdr message;
+         std::memset(&message, 0, sizeof(message));
+         message.msg_control = &control;
+         message.msg_controllen = sizeof(control);
+         cmsghdr* rights = CMSG_FIRSTHDR(&message);
+         rights->cmsg_level = SOL_SOCKET;
+         rights->cmsg_type = SCM_RIGHTS;
+         rights->cmsg_len = CMSG_LEN(sizeof(int));
+         std::memcpy(CMSG_DATA(rights), &fd, sizeof(int));
+         sent = (::sendmsg(_socket, &message, MSG_NOSIGNAL) >= 0);
+      }
+      ::close(fd);
+      return sent;
+   }
+
+   int JournaldSink::priority(const LogLevel& level) const {
+      auto left = _levelMap.lower_bound(level.value);
+      if (left == _levelMap.end()) {
+         return LOG_DEBUG;
+      }
+      return left->second;
+   }
+}
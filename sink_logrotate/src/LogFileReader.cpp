@@ -0,0 +1,337 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/LogFileReader.h"
+#include "g3sinks/LogRotateUtility.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+
+namespace {
+   bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+   int number(const char* text, size_t digits) {
+      int value = 0;
+      for (size_t i = 0; i < digits; ++i) {
+         value = value * 10 + (text[i] - '0');
+      }
+      return value;
+   }
+
+   /// The lines that LogRotate itself writes: the file header, the shutdown line and the rotation note
+   bool isLogRotateLine(const std::string& line) {
+      static const char* kLines[] = {"g3log: created log file at:", "g3log file shutdown at:", "Log rotated Archived file name:"};
+      for (auto start : kLines) {
+         if (0 == line.compare(0, std::strlen(start), start)) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   void removeLineBreak(std::string& line) {
+      while (!line.empty() && ('\n' == line.back() || '\r' == line.back())) {
+         line.pop_back();
+      }
+   }
+} // anonymous
+
+namespace LogFileParser {
+   size_t parseTimestamp(const char* text, size_t size, std::chrono::system_clock::time_point& result) {
+      // "YYYY/MM/DD HH:MM:SS"
+      static const char kLayout[] = "dddd/dd/dd dd:dd:dd";
+      const size_t kLength = sizeof(kLayout) - 1;
+      if (size < kLength) {
+         return 0;
+      }
+      for (size_t i = 0; i < kLength; ++i) {
+         if ('d' == kLayout[i] ? !isDigit(text[i]) : kLayout[i] != text[i]) {
+            return 0;
+         }
+      }
+
+      // mktime is slow, it is only called when the minute changes
+      struct MinuteCache {
+         char key[16];
+         time_t minute;
+      };
+      thread_local MinuteCache cache = {{0}, 0};
+      if (0 != std::memcmp(cache.key, text, sizeof(cache.key))) {
+         struct tm tm = {};
+         tm.tm_year = number(text, 4) - 1900;
+         tm.tm_mon = number(text + 5, 2) - 1;
+         tm.tm_mday = number(text + 8, 2);
+         tm.tm_hour = number(text + 11, 2);
+         tm.tm_min = number(text + 14, 2);
+         tm.tm_isdst = -1;
+         time_t minute = mktime(&tm);
+         if (-1 == minute) {
+            return 0;
+         }
+         std::memcpy(cache.key, text, sizeof(cache.key));
+         cache.minute = minute;
+      }
+
+      size_t length = kLength;
+      long long nanoseconds = 0;
+      if (length + 1 < size && ' ' == text[length] && isDigit(text[length + 1])) {
+         size_t digits = 0;
+         ++length;
+         for (; length < size && isDigit(text[length]); ++length) {
+            if (digits < 9) {
+               nanoseconds = nanoseconds * 10 + (text[length] - '0');
+               ++digits;
+            }
+         }
+         for (; digits < 9; ++digits) {
+            nanoseconds *= 10;
+         }
+      }
+      result = std::chrono::system_clock::from_time_t(cache.minute + number(text + 17, 2))
+               + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds));
+      return length;
+   }
+
+   bool parseLine(const std::string& line, LogFileEntry& entry) {
+      std::chrono::system_clock::time_point timestamp;
+      size_t pos = parseTimestamp(line.data(), line.size(), timestamp);
+      if (0 == pos) {
+         return false;
+      }
+      while (pos < line.size() && (' ' == line[pos] || '\t' == line[pos])) {
+         ++pos;
+      }
+      size_t level_end = line.find_first_of(" \t", pos);
+      if (level_end == std::string::npos || level_end == pos) {
+         return false;
+      }
+      size_t open = line.find('[', level_end);
+      if (open == std::string::npos) {
+         return false;
+      }
+      size_t close = line.find("]\t", open);
+      if (close == std::string::npos) {
+         close = line.find(']', open);
+         if (close == std::string::npos) {
+            return false;
+         }
+      }
+
+      std::string details = line.substr(open + 1, close - open - 1);
+      std::string thread;
+      std::string file = details;
+      std::string function;
+      int line_number = 0;
+      size_t arrow = details.find("->");
+      if (arrow != std::string::npos) {
+         file = details.substr(0, arrow);
+         size_t space = file.rfind(' ');
+         if (space != std::string::npos) {
+            thread = file.substr(0, space);
+            file.erase(0, space + 1);
+         }
+         function = details.substr(arrow + 2);
+         size_t colon = function.rfind(':');
+         if (colon != std::string::npos) {
+            line_number = std::atoi(function.c_str() + colon + 1);
+            function.erase(colon);
+         }
+      }
+
+      size_t message = close + 1;
+      if (message < line.size() && ':' == line[message]) {
+         ++message;
+      }
+      if (message < line.size() && ('\t' == line[message] || ' ' == line[message])) {
+         ++message;
+      }
+
+      entry.timestamp = timestamp;
+      entry.level = line.substr(pos, level_end - pos);
+      entry.thread = std::move(thread);
+      entry.file = std::move(file);
+      entry.function = std::move(function);
+      entry.line = line_number;
+      entry.message = line.substr(std::min(message, line.size()));
+      removeLineBreak(entry.message);
+      return true;
+   }
+} // LogFileParser
+
+
+LogFileReader::LogFileReader(const std::string& file_path)
+   : _path(file_path)
+   , _file(gzopen(file_path.c_str(), "rb"))
+   , _offset(0)
+   , _line_number(0)
+   , _skipped_lines(0)
+   , _has_pending(false)
+   , _has_current(false)
+   , _follow(false)
+   , _hold(std::chrono::milliseconds(1000)) {
+   if (nullptr == _file) {
+      std::cerr << "Cannot open log file: " << file_path << std::endl;
+      return;
+   }
+   gzbuffer(_file, 128 * 1024);
+}
+
+LogFileReader::~LogFileReader() {
+   if (nullptr != _file) {
+      gzclose(_file);
+   }
+}
+
+void LogFileReader::clearEndOfFile() {
+   if (nullptr != _file) {
+      gzclearerr(_file);
+   }
+}
+
+bool LogFileReader::seek(std::chrono::system_clock::time_point from) {
+   if (!isOpen()) {
+      return false;
+   }
+   auto points = SeekableGzip::readIndex(SeekableGzip::indexFileName(_path));
+   auto point = SeekableGzip::findPoint(points, from);
+   if (nullptr == point || point->uncompressed_offset <= _offset) {
+      return false; // reading on is as fast
+   }
+   std::unique_ptr<SeekableGzipReader> reader(new SeekableGzipReader(_path, point->compressed_offset));
+   if (!reader->isOpen()) {
+      return false;
+   }
+   _archive_reader = std::move(reader);
+   _offset = point->uncompressed_offset;
+   _line_number = point->line_number - 1;
+   _has_pending = false;
+   _has_current = false;
+   return true;
+}
+
+uint64_t LogFileReader::readRange(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+                                  const std::function<bool(const LogFileEntry&)>& callback) {
+   seek(from);
+   uint64_t passed = 0;
+   LogFileEntry entry;
+   while (next(entry) && entry.timestamp < to) {
+      if (entry.timestamp < from) {
+         continue;
+      }
+      ++passed;
+      if (!callback(entry)) {
+         break;
+      }
+   }
+   return passed;
+}
+
+/// @return false when there are no more lines
+bool LogFileReader::readLine(std::string& line) {
+   line.swap(_partial);
+   _partial.clear();
+   if (_archive_reader) {
+      _archive_reader->getLine(line);
+   } else {
+      char buffer[8192];
+      while (nullptr != gzgets(_file, buffer, sizeof(buffer))) {
+         line.append(buffer);
+         if ('\n' == line.back()) {
+            break;
+         }
+      }
+   }
+   if (line.empty()) {
+      return false;
+   }
+   if (_follow && '\n' != line.back()) {
+      _partial.swap(line); // the rest of the line is not written yet
+      return false;
+   }
+   _offset += line.size();
+   ++_line_number;
+   return true;
+}
+
+bool LogFileReader::next(LogFileEntry& entry) {
+   if (!isOpen()) {
+      return false;
+   }
+   if (!_has_current) {
+      while (!_has_pending) {
+         uint64_t offset = _offset;
+         if (!readLine(_line)) {
+            return false;
+         }
+         if (LogFileParser::parseLine(_line, _pending)) {
+            _pending.offset = offset;
+            _pending.line_number = _line_number;
+            _pending.size = _line.size();
+            _has_pending = true;
+         } else {
+            ++_skipped_lines;
+         }
+      }
+      _current = std::move(_pending);
+      _has_pending = false;
+      _has_current = true;
+      _current_read = std::chrono::steady_clock::now();
+   }
+
+   bool ended = false; // by the next entry or a LogRotate line
+   uint64_t offset = _offset;
+   while (readLine(_line)) {
+      if (LogFileParser::parseLine(_line, _pending)) {
+         _pending.offset = offset;
+         _pending.line_number = _line_number;
+         _pending.size = _line.size();
+         _has_pending = true;
+         ended = true;
+         break;
+      }
+      if (isLogRotateLine(_line)) {
+         ++_skipped_lines;
+         ended = true;
+         break;
+      }
+      _current.size += _line.size();
+      removeLineBreak(_line);
+      _current.message.push_back('\n');
+      _current.message.append(_line);
+      offset = _offset;
+      _current_read = std::chrono::steady_clock::now();
+   }
+   if (!ended && _follow && std::chrono::steady_clock::now() - _current_read < _hold) {
+      return false; // more lines of its message may still be written
+   }
+
+   entry = std::move(_current);
+   _has_current = false;
+   removeLineBreak(entry.message); // the empty lines before a LogRotate line
+   return true;
+}
+
+
+namespace LogRotateUtility {
+   std::vector<std::string> getLogFileSet(const std::string& dir, const std::string& log_prefix) {
+      std::vector<std::string> files;
+      const std::string log_name = addLogSuffix(log_prefix);
+      for (auto& archive : getLogFilesInDirectory(dir, log_name)) {
+         files.push_back(createPath(dir, archive.second));
+      }
+      std::string current = createPath(dir, log_name);
+      if (std::ifstream(current).good()) {
+         files.push_back(current);
+      }
+      return files;
+   }
+} // LogRotateUtility
@@ -0,0 +1,223 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/LogMerge.h"
+#include "g3sinks/LogQuery.h"
+#include "g3sinks/LogRotateUtility.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <sys/stat.h>
+
+namespace {
+   /// @return the inode of @param path, 0 if there is no such file. There are no inodes on Windows,
+   /// where LogMerger does not follow
+   uint64_t fileId(const std::string& path, uint64_t* size = nullptr) {
+      struct stat status;
+      if (0 != stat(path.c_str(), &status)) {
+         return 0;
+      }
+      if (nullptr != size) {
+         *size = static_cast<uint64_t>(status.st_size);
+      }
+      return static_cast<uint64_t>(status.st_ino);
+   }
+} // anonymous
+
+namespace LogMergeDetail {
+   /// Reads the files of one source in order. When following, the current log is read on as it is
+   /// written, and again from its start when LogRotate replaced it at a rotation
+   class SourceReader {
+    public:
+      SourceReader(const LogMergeSource& source, const LogMergeOptions& options)
+         : _options(options)
+         , _current_log(LogRotateUtility::createPath(source.dir, LogRotateUtility::addLogSuffix(source.prefix)))
+         , _next_file(0)
+         , _is_current_log(false)
+         , _current_log_id(0)
+         , _read_to(0)
+         , _done(false) {
+         for (auto& file : LogQueryEngine::logFiles(source.dir, source.prefix)) {
+            if (file.newest >= options.from) {
+               _files.push_back(file.path);
+            }
+         }
+      }
+
+      /// @return false when there is no entry, for now when following
+      bool fetch(LogFileEntry& entry) {
+         while (true) {
+            if (!_reader && !open()) {
+               return false;
+            }
+            if (nextFrom(entry)) {
+               return true;
+            }
+            if (!_is_current_log || !_options.follow) {
+               _reader.reset();
+               continue;
+            }
+
+            // at the end of the current log: what was written before a rotation is read before moving on.
+            // The new log can get the inode of the removed one, but is then shorter than what was read
+            _reader->clearEndOfFile();
+            uint64_t size = 0;
+            bool rotated = (fileId(_current_log, &size) != _current_log_id || size < _read_to);
+            if (rotated) {
+               _reader->setFollow(false); // nothing more is written to it, its last entry is complete
+            }
+            if (nextFrom(entry)) {
+               return true;
+            }
+            if (!rotated) {
+               return false;
+            }
+            _reader.reset();
+         }
+      }
+
+      /// @return true when there is nothing more to read, never when following
+      bool finished() const { return _done; }
+
+    private:
+      bool nextFrom(LogFileEntry& entry) {
+         while (_reader->next(entry)) {
+            _read_to = entry.offset + entry.size;
+            if (entry.timestamp >= _options.from) {
+               return true;
+            }
+         }
+         return false;
+      }
+
+      /// Opens the next file that can be opened, an archive can have expired since the files were listed
+      bool open() {
+         while (true) {
+            std::string path;
+            if (_next_file < _files.size()) {
+               path = _files[_next_file++];
+            } else if (_options.follow) {
+               path = _current_log; // started, or started again after a rotation
+            } else {
+               _done = true;
+               return false;
+            }
+            _is_current_log = (path == _current_log);
+            _read_to = 0;
+            // the log is identified before and after it is opened, a rotation in between would mix up the files
+            for (int attempt = 0; attempt < 3; ++attempt) {
+               uint64_t id = _is_current_log ? fileId(path) : 0;
+               if (_is_current_log && _options.follow && 0 == id) {
+                  return false; // not created yet
+               }
+               _reader.reset(new LogFileReader(path));
+               _current_log_id = id;
+               if (!_is_current_log || id == fileId(path)) {
+                  break;
+               }
+            }
+            if (_reader->isOpen()) {
+               break;
+            }
+            _reader.reset();
+            if (_is_current_log && _options.follow) {
+               return false; // tried again at the next poll
+            }
+         }
+         _reader->setFollow(_is_current_log && _options.follow, _options.follow_delay);
+         if (_options.from != std::chrono::system_clock::time_point::min()) {
+            _reader->seek(_options.from);
+         }
+         return true;
+      }
+
+      const LogMergeOptions& _options;
+      std::string _current_log;
+      std::vector<std::string> _files;
+      size_t _next_file;
+      std::unique_ptr<LogFileReader> _reader;
+      bool _is_current_log;
+      uint64_t _current_log_id;
+      uint64_t _read_to; // of the entries read from the file
+      bool _done;
+   };
+} // LogMergeDetail
+
+LogMerger::LogMerger(const std::vector<LogMergeSource>& sources, const LogMergeOptions& options)
+   : _sources(sources)
+   , _options(options)
+   , _heads(sources.size())
+   , _has_head(sources.size(), false)
+   , _stopped(false) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+   if (_options.follow) {
+      std::cerr << "LogMerger cannot follow the logs on Windows, they are merged up to their current end" << std::endl;
+      _options.follow = false;
+   }
+#endif
+   for (auto& source : _sources) {
+      _readers.emplace_back(new LogMergeDetail::SourceReader(source, _options));
+   }
+   for (size_t source = 0; source < _sources.size(); ++source) {
+      fill(source);
+   }
+   _last_poll = std::chrono::steady_clock::now();
+}
+
+LogMerger::~LogMerger() = default;
+
+/// Reads the next entry of @param source onto the heap
+void LogMerger::fill(size_t source) {
+   if (!_has_head[source] && _readers[source]->fetch(_heads[source])) {
+      _has_head[source] = true;
+      _heap.push_back(source);
+      std::push_heap(_heap.begin(), _heap.end(), [this](size_t a, size_t b) { return later(a, b); });
+   }
+}
+
+/// The heap order: timestamp, then source
+bool LogMerger::later(size_t a, size_t b) const {
+   return _heads[a].timestamp > _heads[b].timestamp || (_heads[a].timestamp == _heads[b].timestamp && a > b);
+}
+
+bool LogMerger::next(LogFileEntry& entry, size_t& source) {
+   while (!_stopped) {
+      auto now = std::chrono::steady_clock::now();
+      bool poll = _options.follow && now - _last_poll >= _options.poll_interval;
+      if (poll) {
+         _last_poll = now;
+         for (size_t i = 0; i < _sources.size(); ++i) {
+            fill(i);
+         }
+      }
+      bool all_sources_ahead = true; // every source has its next entry, or has ended
+      for (size_t i = 0; i < _sources.size(); ++i) {
+         all_sources_ahead = all_sources_ahead && (_has_head[i] || _readers[i]->finished());
+      }
+
+      if (!_heap.empty()) {
+         size_t top = _heap.front();
+         bool held_back = !all_sources_ahead && _heads[top].timestamp > std::chrono::system_clock::now() - _options.follow_delay;
+         if (!held_back) {
+            std::pop_heap(_heap.begin(), _heap.end(), [this](size_t a, size_t b) { return later(a, b); });
+            _heap.pop_back();
+            entry = std::move(_heads[top]);
+            source = top;
+            _has_head[top] = false;
+            fill(top); // the source that was read from is likely to have more
+            return true;
+         }
+      } else if (!_options.follow) {
+         return false;
+      }
+      std::this_thread::sleep_for(std::min(_options.poll_interval, std::chrono::milliseconds(50)));
+   }
+   return false;
+}
@@ -0,0 +1,59 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/LogMessageRing.h"
+
+/// @param max_bytes is the approximate memory budget of the ring
+LogMessageRing::LogMessageRing(size_t max_bytes)
+    : _max_bytes(max_bytes)
+    , _bytes(0)
+    , _evicted(0)
+    {}
+
+
+void LogMessageRing::setMaxBytes(size_t max_bytes) {
+   _max_bytes = max_bytes;
+   evict();
+}
+
+
+void LogMessageRing::push(g3::LogMessage&& entry) {
+   _bytes += footprint(entry);
+   _entries.push_back(std::move(entry));
+   evict();
+}
+
+
+size_t LogMessageRing::drain(const std::function<void(const g3::LogMessage&)>& receiver) {
+   size_t drained = _entries.size();
+   for (const auto& entry : _entries) {
+      receiver(entry);
+   }
+   _entries.clear();
+   _bytes = 0;
+   _evicted = 0;
+   return drained;
+}
+
+
+/// @return approximate heap and object size of an entry
+size_t LogMessageRing::footprint(const g3::LogMessage& entry) {
+   return sizeof(g3::LogMessage) + entry._message.capacity() + entry._file.capacity()
+      + entry._file_path.capacity() + entry._function.capacity() + entry._expression.capacity();
+}
+
+
+void LogMessageRing::evict() {
+   while (_bytes > _max_bytes && !_entries.empty()) {
+      _bytes -= footprint(_entries.front());
+      _entries.pop_front();
+      ++_evicted;
+   }
+}
@@ -0,0 +1,328 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/LogQuery.h"
+#include "g3sinks/LogRotateUtility.h"
+#include "g3sinks/SubstringScanner.h"
+#include "g3sinks/TokenBloomFilter.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace {
+   using TimePoint = std::chrono::system_clock::time_point;
+
+   /// Entries are timestamped when they are logged and written when g3log gets to them, an entry can
+   /// end up in the archive after the one of its time
+   const std::chrono::seconds kRotationSlack(60);
+
+   /// Matches of a file that are read ahead of the merge
+   const size_t kQueuedMatches = 1024;
+
+   bool isArchive(const std::string& path) {
+      return path.size() > 3 && 0 == path.compare(path.size() - 3, 3, ".gz");
+   }
+
+   /// The characters of the tokens of TokenBloomFilter
+   bool isWordChar(char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+   }
+
+   /// @return true if @param message has the needle of @param scanner, with @param whole_words not as
+   /// part of a longer word
+   bool containsText(const std::string& message, const SubstringScanner& scanner, bool whole_words) {
+      const std::string& text = scanner.needle();
+      if (!whole_words || text.empty()) {
+         return scanner.contains(message);
+      }
+      for (size_t from = 0; from < message.size();) {
+         size_t found = scanner.find(message.data() + from, message.size() - from);
+         if (std::string::npos == found) {
+            return false;
+         }
+         found += from;
+         size_t end = found + text.size();
+         bool starts_word = !isWordChar(text.front()) || 0 == found || !isWordChar(message[found - 1]);
+         bool ends_word = !isWordChar(text.back()) || message.size() == end || !isWordChar(message[end]);
+         if (starts_word && ends_word) {
+            return true;
+         }
+         from = found + 1;
+      }
+      return false;
+   }
+
+   /// Reads the matches of a file one at a time
+   class FileSearch {
+    public:
+      FileSearch(const LogQueryFile& file, const LogQuery& query, const SubstringScanner& scanner,
+                 const std::atomic<bool>& stopped, LogQueryStats& stats)
+         : _query(query)
+         , _scanner(scanner)
+         , _stopped(stopped)
+         , _stats(stats) {
+         if (file.newest < query.from || file.oldest >= query.to) {
+            ++_stats.skipped_by_time;
+            return;
+         }
+         if (!query.text.empty() && isArchive(file.path) && !ArchiveBloomFilter::mayContain(file.path, query.text, query.whole_words)) {
+            ++_stats.skipped_by_filter;
+            return;
+         }
+         _reader.reset(new LogFileReader(file.path));
+         _reader->seek(query.from);
+      }
+
+      /// @return false when the file has no more matches in the time range
+      bool next(LogFileEntry& match) {
+         while (_reader && !_stopped && _reader->next(match) && match.timestamp < _query.to) {
+            if (match.timestamp < _query.from) {
+               continue;
+            }
+            ++_stats.entries;
+            _stats.bytes += match.size;
+            if (!_query.levels.empty() && std::find(_query.levels.begin(), _query.levels.end(), match.level) == _query.levels.end()) {
+               continue;
+            }
+            if (containsText(match.message, _scanner, _query.whole_words)) {
+               ++_stats.matches;
+               return true;
+            }
+         }
+         _reader.reset();
+         return false;
+      }
+
+    private:
+      const LogQuery& _query;
+      const SubstringScanner& _scanner;
+      const std::atomic<bool>& _stopped;
+      LogQueryStats& _stats;
+      std::unique_ptr<LogFileReader> _reader;
+   };
+
+   /// The matches of a file on their way to the merge
+   struct FileQueue {
+      std::deque<LogFileEntry> matches;
+      bool claimed = false; // by a worker, or by the merge
+      bool done = false;
+      std::unique_ptr<FileSearch> search; // when the merge reads the file itself
+      LogQueryStats stats;
+   };
+
+   /// Streams the matches of the files to the merge. The workers take the files in order and queue up
+   /// to kQueuedMatches of a file ahead of the merge. When the merge needs a file that no worker has
+   /// taken while all of them wait for the merge, it reads that file itself
+   class MatchStreams {
+    public:
+      MatchStreams(const std::vector<LogQueryFile>& files, const LogQuery& query, size_t threads)
+         : _files(files)
+         , _query(query)
+         , _scanner(query.text, query.ignore_case)
+         , _queues(files.size())
+         , _next_file(0)
+         , _workers(threads)
+         , _waiting(0)
+         , _stopped(false) {
+         for (size_t i = 0; i < _workers; ++i) {
+            _pool.emplace_back([this] { work(); });
+         }
+      }
+
+      ~MatchStreams() {
+         stop();
+      }
+
+      /// Waits for the next match of @param file
+      /// @return false when the file has no more matches
+      bool head(size_t file, TimePoint& timestamp) {
+         std::unique_lock<std::mutex> lock(_mutex);
+         FileQueue& queue = _queues[file];
+         while (queue.matches.empty() && !queue.done) {
+            if (!queue.claimed && _waiting == _workers) {
+               queue.claimed = true;
+               lock.unlock();
+               queue.search.reset(new FileSearch(_files[file], _query, _scanner, _stopped, queue.stats));
+               lock.lock();
+            }
+            if (queue.search) {
+               LogFileEntry match;
+               lock.unlock();
+               bool found = queue.search->next(match);
+               lock.lock();
+               if (found) {
+                  queue.matches.push_back(std::move(match));
+               } else {
+                  queue.done = true;
+               }
+            } else {
+               _changed.wait(lock);
+            }
+         }
+         if (queue.matches.empty()) {
+            return false;
+         }
+         timestamp = queue.matches.front().timestamp;
+         return true;
+      }
+
+      /// @return the match of head()
+      LogFileEntry pop(size_t file) {
+         std::lock_guard<std::mutex> lock(_mutex);
+         FileQueue& queue = _queues[file];
+         if (queue.matches.size() == kQueuedMatches) {
+            _changed.notify_all();
+         }
+         LogFileEntry match = std::move(queue.matches.front());
+         queue.matches.pop_front();
+         return match;
+      }
+
+      void stop() {
+         {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopped = true;
+         }
+         _changed.notify_all();
+         for (auto& thread : _pool) {
+            thread.join();
+         }
+         _pool.clear();
+      }
+
+      /// @return the totals of the files, after stop()
+      LogQueryStats stats() const {
+         LogQueryStats stats;
+         stats.files = _files.size();
+         for (auto& queue : _queues) {
+            stats.skipped_by_time += queue.stats.skipped_by_time;
+            stats.skipped_by_filter += queue.stats.skipped_by_filter;
+            stats.entries += queue.stats.entries;
+            stats.bytes += queue.stats.bytes;
+            stats.matches += queue.stats.matches;
+         }
+         return stats;
+      }
+
+    private:
+      void work() {
+         std::unique_lock<std::mutex> lock(_mutex);
+         while (!_stopped) {
+            while (_next_file < _queues.size() && _queues[_next_file].claimed) {
+               ++_next_file;
+            }
+            if (_next_file == _queues.size()) {
+               return;
+            }
+            size_t file = _next_file++;
+            FileQueue& queue = _queues[file];
+            queue.claimed = true;
+            lock.unlock();
+            FileSearch search(_files[file], _query, _scanner, _stopped, queue.stats);
+            LogFileEntry match;
+            bool found = search.next(match);
+            lock.lock();
+            while (found && !_stopped) {
+               if (queue.matches.size() == kQueuedMatches) {
+                  ++_waiting;
+                  _changed.notify_all();
+                  _changed.wait(lock, [&] { return queue.matches.size() < kQueuedMatches || _stopped; });
+                  --_waiting;
+                  continue;
+               }
+               if (queue.matches.empty()) {
+                  _changed.notify_all();
+               }
+               queue.matches.push_back(std::move(match));
+               lock.unlock();
+               found = search.next(match);
+               lock.lock();
+            }
+            queue.done = true;
+            _changed.notify_all();
+         }
+      }
+
+      const std::vector<LogQueryFile>& _files;
+      const LogQuery& _query;
+      SubstringScanner _scanner;
+      std::vector<FileQueue> _queues;
+      size_t _next_file;
+      const size_t _workers;
+      size_t _waiting; // workers whose queue is full
+      std::atomic<bool> _stopped;
+      std::mutex _mutex;
+      std::condition_variable _changed;
+      std::vector<std::thread> _pool;
+   };
+} // anonymous
+
+namespace LogQueryEngine {
+   LogQueryStats search(const std::vector<LogQueryFile>& files, const LogQuery& query, const MatchCallback& callback) {
+      size_t threads = query.threads > 0 ? query.threads : std::max(1u, std::thread::hardware_concurrency());
+      MatchStreams streams(files, query, std::min(threads, files.size()));
+
+      // k-way merge of the files' matches: timestamp, then file order. A file's matches are taken in
+      // the order they were written, which is the time order give or take the queueing in g3log
+      using Head = std::pair<TimePoint, size_t>; // timestamp, file
+      std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+      TimePoint timestamp;
+      for (size_t file = 0; file < files.size(); ++file) {
+         if (streams.head(file, timestamp)) {
+            heads.emplace(timestamp, file);
+         }
+      }
+      while (!heads.empty()) {
+         size_t file = heads.top().second;
+         heads.pop();
+         if (!callback(files[file].path, streams.pop(file))) {
+            break;
+         }
+         if (streams.head(file, timestamp)) {
+            heads.emplace(timestamp, file);
+         }
+      }
+      streams.stop();
+      return streams.stats();
+   }
+
+   std::vector<LogQueryFile> logFiles(const std::string& dir, const std::string& log_prefix) {
+      using namespace LogRotateUtility;
+      const std::string log_name = addLogSuffix(log_prefix);
+      std::vector<LogQueryFile> files;
+      TimePoint previous_rotation = TimePoint::min();
+      for (auto& archive : getLogFilesInDirectory(dir, log_name)) {
+         LogQueryFile file;
+         file.path = createPath(dir, archive.second);
+         auto rotated = std::chrono::system_clock::from_time_t(static_cast<time_t>(archive.first));
+         file.oldest = (previous_rotation == TimePoint::min()) ? previous_rotation : previous_rotation - kRotationSlack;
+         file.newest = rotated + std::chrono::seconds(1); // the name has whole seconds
+         previous_rotation = rotated;
+         files.push_back(file);
+      }
+      LogQueryFile current;
+      current.path = createPath(dir, log_name);
+      if (std::ifstream(current.path).good()) {
+         current.oldest = (previous_rotation == TimePoint::min()) ? previous_rotation : previous_rotation - kRotationSlack;
+         files.push_back(current);
+      }
+      return files;
+   }
+
+   LogQueryStats searchDirectory(const std::string& dir, const std::string& log_prefix, const LogQuery& query, const MatchCallback& callback) {
+      return search(logFiles(dir, log_prefix), query, callback);
+   }
+} // LogQueryEngine
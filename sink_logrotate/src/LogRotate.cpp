@@ -12,6 +12,7 @@
 #include "g3sinks/LogRotate.h"
 #include "LogRotateHelper.ipp"
 #include <iostream>
+#include <sstream>
 
 
 /// @param log_prefix to use for the file
@@ -91,4 +92,85 @@ int LogRotate::getMaxLogSize() {
 
 bool LogRotate::rotateLog(){
     return pimpl_->rotateLog();
-}
\ No newline at end of file
+}
+
+/// @return a copy of the runtime numbers, call it on the sink thread with sinkHandle->call
+LogRotateStats LogRotate::stats() {
+   return pimpl_->stats_;
+}
+
+/// @return the number of flushes so far, the same as stats().flushes
+uint64_t LogRotate::getFlushCount() {
+   return pimpl_->stats_.flushes;
+}
+
+/**
+* Regularly write the stats as Prometheus text
+* @param file_path is replaced by a new file each time, empty disables the dump
+* @param interval minimum time between two dumps
+*/
+void LogRotate::setStatsDump(const std::string& file_path, std::chrono::seconds interval) {
+   pimpl_->setStatsDump(file_path, interval);
+}
+
+/**
+* Make the archives seekable by time
+* @param every_bytes of log between two sync points, 0: not by size
+* @param every seconds of log time between two sync points, 0: not by time
+*/
+void LogRotate::setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every) {
+   pimpl_->setArchiveSyncPoints(every_bytes, every);
+}
+
+/// Build a token Bloom filter of each log while it is archived
+void LogRotate::setArchiveBloomFilter(bool enabled) {
+   pimpl_->setArchiveBloomFilter(enabled);
+}
+
+/// fsync each archive before its log is removed
+void LogRotate::setArchiveSync(bool enabled) {
+   pimpl_->setArchiveSync(enabled);
+}
+
+
+namespace {
+   void metric(std::ostringstream& out, const std::string& name, const std::string& type,
+               const std::string& help, const std::string& label, double value) {
+      out << "# HELP " << name << " " << help << "\n";
+      out << "# TYPE " << name << " " << type << "\n";
+      out << name << "{" << label << "} " << value << "\n";
+   }
+
+   double seconds(std::chrono::nanoseconds duration) {
+      return std::chrono::duration<double>(duration).count();
+   }
+} // anonymous
+
+std::string LogRotateStats::prometheusText(const std::string& log_name) const {
+   const std::string label = "log=\"" + log_name + "\"";
+   std::ostringstream out;
+   out.precision(9);
+   metric(out, "g3sinks_logrotate_bytes_written_total", "counter", "Bytes written to the log file.", label, static_cast<double>(bytes_written));
+   metric(out, "g3sinks_logrotate_records_written_total", "counter", "Entries written to the log file.", label, static_cast<double>(records_written));
+   metric(out, "g3sinks_logrotate_flushes_total", "counter", "Flushes of the log file.", label, static_cast<double>(flushes));
+   metric(out, "g3sinks_logrotate_write_errors_total", "counter", "Failed writes or flushes of the log file.", label, static_cast<double>(write_errors));
+   metric(out, "g3sinks_logrotate_fsyncs_total", "counter", "Synced archives.", label, static_cast<double>(fsyncs));
+   metric(out, "g3sinks_logrotate_rotations_total", "counter", "Log rotations.", label, static_cast<double>(rotations));
+   metric(out, "g3sinks_logrotate_compressed_input_bytes_total", "counter", "Log bytes that were compressed.", label, static_cast<double>(compressed_input_bytes));
+   metric(out, "g3sinks_logrotate_compressed_output_bytes_total", "counter", "Archive bytes.", label, static_cast<double>(compressed_output_bytes));
+   metric(out, "g3sinks_logrotate_compression_ratio", "gauge", "Log bytes per archive byte.", label, compression_ratio);
+   metric(out, "g3sinks_logrotate_compress_seconds_total", "counter", "Time spent compressing.", label, seconds(total_compress_duration));
+   metric(out, "g3sinks_logrotate_expire_seconds_total", "counter", "Time spent removing old archives.", label, seconds(total_expire_duration));
+
+   const std::string histogram = "g3sinks_logrotate_write_latency_seconds";
+   out << "# HELP " << histogram << " Time to write, and flush, an entry.\n";
+   out << "# TYPE " << histogram << " histogram\n";
+   for (auto bound : {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000}) {
+      std::chrono::microseconds le(bound);
+      out << histogram << "_bucket{" << label << ",le=\"" << seconds(le) << "\"} " << write_latency.countAtOrBelow(le) << "\n";
+   }
+   out << histogram << "_bucket{" << label << ",le=\"+Inf\"} " << write_latency.count() << "\n";
+   out << histogram << "_sum{" << label << "} " << seconds(write_latency.sum()) << "\n";
+   out << histogram << "_count{" << label << "} " << write_latency.count() << "\n";
+   return out.str();
+}
@@ -27,7 +27,15 @@
 #include <ctime>
 #include <iostream>
 #include <sstream>
+#include "g3sinks/LogRotate.h"
 #include "g3sinks/LogRotateUtility.h"
+#include "g3sinks/SeekableGzip.h"
+#include "g3sinks/SinkProbes.h"
+#include "g3sinks/TokenBloomFilter.h"
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 using namespace LogRotateUtility;
@@ -40,6 +48,8 @@ using namespace LogRotateUtility;
  * 0 is never (system decides, and when there is a log rotation)
  * 1 ... N means every x entry (1 is every time, 2 is every other time etc)
  * Default is to flush every single time
+ *
+ * stats_ is only touched by the sink thread, it is read with a copy through LogRotate::stats()
  */
 struct LogRotateHelper {
    LogRotateHelper& operator=(const LogRotateHelper&) = delete;
@@ -58,6 +68,7 @@ struct LogRotateHelper {
    void flushPolicy();
    void setFlushPolicy(size_t flush_policy);
    void flush();
+   void checkStream();
 
    std::string changeLogFile(const std::string& directory, const std::string& new_name = "");
    std::string logFileName();
@@ -68,6 +79,13 @@ struct LogRotateHelper {
    bool rotateLog();
    void setLogSizeCounter();
    bool createCompressedFile(std::string file_name, std::string gzip_file_name);
+   bool compressFile(const std::string& file_name, const std::string& gzip_file_name, uint64_t& input_bytes, TokenBloomFilter* filter);
+   bool syncFile(const std::string& file_name);
+   void setStatsDump(const std::string& file_path, std::chrono::seconds interval);
+   void setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every);
+   void setArchiveBloomFilter(bool enabled);
+   void setArchiveSync(bool enabled);
+   void dumpStats();
    std::ofstream& filestream() {
       return *(outptr_.get());
    }
@@ -82,6 +100,13 @@ struct LogRotateHelper {
    std::streamoff cur_log_size_;
    size_t flush_policy_;
    size_t flush_policy_counter_;
+   LogRotateStats stats_;
+   std::string stats_dump_path_;
+   std::chrono::seconds stats_dump_interval_;
+   steady_time_point next_stats_dump_;
+   SeekableGzipPolicy archive_sync_points_;
+   bool archive_bloom_filter_;
+   bool archive_sync_;
 };
 
 LogRotateHelper::LogRotateHelper(const std::string& log_prefix, const std::string& log_directory, size_t flush_policy)
@@ -91,7 +116,10 @@ LogRotateHelper::LogRotateHelper(const std::string& log_prefix, const std::strin
    , outptr_(new std::ofstream)
    , steady_start_time_(std::chrono::steady_clock::now())
    , flush_policy_(flush_policy)
-   , flush_policy_counter_(flush_policy) {
+   , flush_policy_counter_(flush_policy)
+   , stats_dump_interval_(0)
+   , archive_bloom_filter_(false)
+   , archive_sync_(false) {
    log_prefix_backup_ = prefixSanityFix(log_prefix);
    max_log_size_ = 524288000;
    max_archive_log_count_ = 10;
@@ -138,6 +166,9 @@ LogRotateHelper::~LogRotateHelper() {
    auto now = std::chrono::system_clock::now();
    ss_exit << "\ng3log file shutdown at: " << g3::localtime_formatted(now, g3::internal::time_formatted) << "\n\n";
    filestream() << ss_exit.str() << std::flush;
+   if (!stats_dump_path_.empty()) {
+      dumpStats();
+   }
 }
 
 void LogRotateHelper::fileWrite(std::string message) {
@@ -148,10 +179,21 @@ void LogRotateHelper::fileWrite(std::string message) {
 }
 
 void LogRotateHelper::fileWriteWithoutRotate(std::string message) {
+   auto start = std::chrono::steady_clock::now();
    std::ofstream& out(filestream());
    out << message;
    flushPolicy();
+   checkStream();
    cur_log_size_ += message.size();
+   auto now = std::chrono::steady_clock::now();
+   G3SINKS_PROBE2(logrotate_write, message.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+   stats_.write_latency.record(now - start);
+   stats_.bytes_written += message.size();
+   ++stats_.records_written;
+   if (!stats_dump_path_.empty() && now >= next_stats_dump_) {
+      dumpStats();
+      next_stats_dump_ = now + stats_dump_interval_;
+   }
 }
 
 
@@ -173,7 +215,21 @@ void LogRotateHelper::setFlushPolicy(size_t flush_policy) {
 
 
 void LogRotateHelper::flush() {
+   G3SINKS_PROBE(logrotate_flush_start);
    filestream() << std::flush;
+   G3SINKS_PROBE(logrotate_flush_done);
+   ++stats_.flushes;
+   checkStream();
+}
+
+/// A failed write, e.g. on a full disk, leaves the stream failed and every later write would be
+/// ignored. The error is counted and cleared so the log continues when the disk recovers
+void LogRotateHelper::checkStream() {
+   std::ofstream& out(filestream());
+   if (!out) {
+      ++stats_.write_errors;
+      out.clear();
+   }
 }
 
 
@@ -210,14 +266,20 @@ std::string LogRotateHelper::changeLogFile(const std::string& directory, const s
 bool LogRotateHelper::rotateLog() {
    std::ofstream& is(filestream());
    if (is.is_open()) {
-      is << std::flush;
+      G3SINKS_PROBE1(logrotate_rotate_start, static_cast<long long>(cur_log_size_));
+      flush();
       std::ostringstream gz_file_name;
       gz_file_name << log_file_with_path_ << ".";
       auto now = std::chrono::system_clock::now();
       gz_file_name << g3::localtime_formatted(now, "%Y-%m-%d-%H-%M-%S");
       gz_file_name << ".gz";
-      if (!createCompressedFile(log_file_with_path_, gz_file_name.str())) {
+      auto compress_start = std::chrono::steady_clock::now();
+      bool compressed = createCompressedFile(log_file_with_path_, gz_file_name.str());
+      stats_.last_compress_duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - compress_start);
+      stats_.total_compress_duration += stats_.last_compress_duration;
+      if (!compressed) {
          fileWriteWithoutRotate("Failed to compress log!");
+         G3SINKS_PROBE1(logrotate_rotate_done, 0);
          return false;
       }
       is.close();
@@ -231,7 +293,14 @@ bool LogRotateHelper::rotateLog() {
       ss.clear();
       ss.str("");
       ss << log_prefix_backup_ << ".log";
+      auto expire_start = std::chrono::steady_clock::now();
+      G3SINKS_PROBE(logrotate_expire_start);
       expireArchives(log_directory_, ss.str(), max_archive_log_count_);
+      stats_.last_expire_duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - expire_start);
+      G3SINKS_PROBE1(logrotate_expire_done, stats_.last_expire_duration.count());
+      stats_.total_expire_duration += stats_.last_expire_duration;
+      ++stats_.rotations;
+      G3SINKS_PROBE1(logrotate_rotate_done, 1);
       return true;
    }
    return false;
@@ -258,24 +327,64 @@ void LogRotateHelper::setLogSizeCounter() {
  * @return
  */
 bool LogRotateHelper::createCompressedFile(std::string file_name, std::string gzip_file_name) {
+   G3SINKS_PROBE1(logrotate_compress_start, file_name.c_str());
+   uint64_t input_bytes = 0;
+   // the Bloom filter gets the text of the log while it is compressed, the log is read once
+   std::unique_ptr<TokenBloomFilter> filter;
+   if (archive_bloom_filter_) {
+      filter.reset(new TokenBloomFilter(ArchiveBloomFilter::forLog(static_cast<uint64_t>(std::max(std::streamoff{0}, cur_log_size_)))));
+   }
+   bool close_status = archive_sync_points_.enabled() ? SeekableGzip::compress(file_name, gzip_file_name, archive_sync_points_, input_bytes, filter.get())
+                                                      : compressFile(file_name, gzip_file_name, input_bytes, filter.get());
+   uint64_t output_bytes = 0;
+   if (close_status && filter) {
+      ArchiveBloomFilter::save(*filter, gzip_file_name);
+   }
+   if (close_status) {
+      if (archive_sync_) {
+         syncFile(gzip_file_name); // the log is removed next, the archive should be on disk first
+      }
+      std::ifstream archive(gzip_file_name, std::ios::binary | std::ios::ate);
+      output_bytes = static_cast<uint64_t>(std::max(std::streamoff{0}, std::streamoff(archive.tellg())));
+      stats_.compressed_input_bytes += input_bytes;
+      stats_.compressed_output_bytes += output_bytes;
+      if (stats_.compressed_output_bytes > 0) {
+         stats_.compression_ratio = static_cast<double>(stats_.compressed_input_bytes) / static_cast<double>(stats_.compressed_output_bytes);
+      }
+   }
+   G3SINKS_PROBE3(logrotate_compress_done, input_bytes, output_bytes, close_status ? 1 : 0);
+   return close_status;
+
+}
+
+/// One deflate stream, without sync points
+bool LogRotateHelper::compressFile(const std::string& file_name, const std::string& gzip_file_name, uint64_t& input_bytes, TokenBloomFilter* filter) {
    const int buffer_size = 16184;
    char buffer[buffer_size];
    FILE* input = fopen(file_name.c_str(), "rb");
    gzFile output = gzopen(gzip_file_name.c_str(), "wb");
 
    if (input == NULL || output == NULL) {
+      if (input != NULL) {
+         fclose(input);
+      }
+      if (output != NULL) {
+         gzclose(output);
+      }
       return false;
    }
 
    size_t N;
    while ((N = fread(buffer, 1, buffer_size, input)) > 0) {
       gzwrite(output, buffer, N);
+      input_bytes += N;
+      if (nullptr != filter) {
+         filter->addText(buffer, N);
+      }
    }
    bool close_status = (gzclose(output) == Z_OK);
    close_status = (fclose(input) == 0)  && close_status;
-
    return close_status;
-
 }
 
 std::string LogRotateHelper::logFileName() {
@@ -285,3 +394,61 @@ std::string LogRotateHelper::logFileName() {
 void LogRotateHelper::addLogFileHeader() {
    filestream() << header();
 }
+
+
+/// fsync of a closed file, a no-op on Windows
+bool LogRotateHelper::syncFile(const std::string& file_name) {
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+   int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0) {
+      return false;
+   }
+   bool synced = (0 == fsync(fd));
+   close(fd);
+   if (synced) {
+      ++stats_.fsyncs;
+   }
+   return synced;
+#else
+   (void)file_name;
+   return true;
+#endif
+}
+
+
+void LogRotateHelper::setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every) {
+   archive_sync_points_.every_bytes = every_bytes;
+   archive_sync_points_.every = every;
+}
+
+void LogRotateHelper::setArchiveBloomFilter(bool enabled) {
+   archive_bloom_filter_ = enabled;
+}
+
+void LogRotateHelper::setArchiveSync(bool enabled) {
+   archive_sync_ = enabled;
+}
+
+void LogRotateHelper::setStatsDump(const std::string& file_path, std::chrono::seconds interval) {
+   stats_dump_path_ = file_path;
+   stats_dump_interval_ = interval;
+   next_stats_dump_ = std::chrono::steady_clock::now();
+}
+
+/// The stats are written to a temporary file that then replaces the dump file,
+/// readers never see a partial dump
+void LogRotateHelper::dumpStats() {
+   const std::string temporary = stats_dump_path_ + ".tmp";
+   {
+      std::ofstream out(temporary, std::ios::trunc);
+      if (!out) {
+         std::cerr << "g3log: cannot write stats to " << temporary << std::endl;
+         return;
+      }
+      out << stats_.prometheusText(log_prefix_backup_);
+   }
+   if (0 != std::rename(temporary.c_str(), stats_dump_path_.c_str())) {
+      std::remove(stats_dump_path_.c_str()); // Windows does not replace an existing file
+      std::rename(temporary.c_str(), stats_dump_path_.c_str());
+   }
+}
@@ -11,6 +11,8 @@
 * ********************************************* */
 
 #include "g3sinks/LogRotateUtility.h"
+#include "g3sinks/SeekableGzip.h"
+#include "g3sinks/TokenBloomFilter.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -171,6 +173,8 @@ namespace  LogRotateUtility {
 
             std::string filename_with_path(createPath(dir, it->second));
             remove(filename_with_path.c_str());
+            remove(SeekableGzip::indexFileName(filename_with_path).c_str()); // the sidecars, if the archive has them
+            remove(ArchiveBloomFilter::filterFileName(filename_with_path).c_str());
             --logs_to_delete;
          }
       }
@@ -11,6 +11,7 @@
 #include "g3sinks/LogRotateWithFilter.h"
 #include <memory>
 #include <algorithm>
+#include <functional>
 #include <iostream> // to remove
 
 // helper function to create an logging sink with filter
@@ -27,21 +28,137 @@ LogRotateWithFilter::LogRotateWithFilter(LogRotateUniquePtr logToFile, IgnoreLog
     : _logger(std::move(logToFile))
     , _filter(std::move(ignoreLevels))
     , _log_details_func(&g3::LogMessage::DefaultLogDetailsToString)
+    , _repeat_window(0)
+    , _crash_ring_trigger(FATAL)
+    , _overload_enabled(false)
+    , _overload_dropped(0)
+    , _overload_sample_counter(0)
+    , _flush_count(0)
      {}
 
 
-LogRotateWithFilter::~LogRotateWithFilter() {}
+LogRotateWithFilter::~LogRotateWithFilter() {
+    drainSpill();
+    saveRepeatSummary();
+    saveDroppedReport(true);
+    saveLatencySummary(true);
+}
 
 /// @param logEntry saves log entry that are not in the filter
 void LogRotateWithFilter::save(g3::LogMessageMover logEntry) {
     auto level = logEntry.get()._level;
+    if (!_crash_ring_levels.empty()) {
+       if (isCrashRingLevel(level)) {
+          _crash_ring.push(std::move(logEntry.get()));
+          return;
+       }
+       if (level.value >= _crash_ring_trigger.value) {
+          dumpCrashRing();
+       }
+    }
+
     bool isNotInFilter_ = (_filter.end() == std::find(_filter.begin(), _filter.end(), level));
 
-    if(isNotInFilter_) {
-      _logger->save(logEntry.get().toString(_log_details_func));
+    if(isNotInFilter_ && !isHandledByOverload(logEntry.get()) && _limiter.allow(level) && !isRepeated(logEntry.get())) {
+      writeEntry(logEntry.get());
+   }
+   saveDroppedReport();
+   saveLatencySummary();
+}
+
+/// Writes the entry, and measures the write latency when the overload policy needs it
+void LogRotateWithFilter::writeEntry(const g3::LogMessage& message) {
+   if (0 == _overload_policy.max_write_latency.count()) {
+      _logger->save(message.toString(_log_details_func));
+   } else {
+      auto start = std::chrono::steady_clock::now();
+      _logger->save(message.toString(_log_details_func));
+      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      auto& average = _overload_status.write_latency;
+      average += (latency - average) / 8;
+   }
+
+   if (_latency.enabled()) {
+      _latency.written(message._timestamp);
+      updateFlushed();
    }
 }
 
+/// The LogRotate flushes according to its flush policy, and at rotation, a changed
+/// flush count means that all entries written so far are flushed
+void LogRotateWithFilter::updateFlushed() {
+   auto flush_count = _logger->getFlushCount();
+   if (flush_count != _flush_count) {
+      _flush_count = flush_count;
+      _latency.flushed();
+   }
+}
+
+void LogRotateWithFilter::saveLatencySummary(bool force) {
+   auto summary = _latency.summary(force);
+   if (!summary.empty()) {
+      saveInternalEntry(INFO, summary);
+   }
+}
+
+/// @return true if @param message repeats the previous entry within the suppression window.
+/// A repeated message is kept (moved) so that the summary can be formatted like a normal entry
+bool LogRotateWithFilter::isRepeated(g3::LogMessage& message) {
+   if (0 == _repeat_window.count()) {
+      return false;
+   }
+
+   auto now = std::chrono::steady_clock::now();
+   auto hash = std::hash<std::string>{}(message._message);
+   bool sameEntry = (_repeated.line == message._line && _repeated.hash == hash && _repeated.file == message._file_path);
+   if (sameEntry && (now - _repeated.first_seen) < _repeat_window) {
+      ++_repeated.count;
+      _repeated.last = std::make_unique<g3::LogMessage>(std::move(message));
+      return true;
+   }
+
+   saveRepeatSummary();
+   _repeated.file = message._file_path;
+   _repeated.line = message._line;
+   _repeated.hash = hash;
+   _repeated.first_seen = now;
+   return false;
+}
+
+/// Ends the current run of repeated entries. If any entries were suppressed then
+/// one summary entry, with the details of the last suppressed entry, is written instead
+void LogRotateWithFilter::saveRepeatSummary() {
+   if (0 == _repeated.count) {
+      _repeated = RepeatedEntry{};
+      return;
+   }
+
+   auto& summary = *_repeated.last;
+   summary._message = "last message repeated " + std::to_string(_repeated.count) + " times";
+   _logger->save(summary.toString(_log_details_func));
+   _repeated = RepeatedEntry{};
+}
+
+/// Writes how many entries the level limits have dropped, at most once per report interval
+/// unless @param force is set
+void LogRotateWithFilter::saveDroppedReport(bool force) {
+   auto report = _limiter.droppedReport(force);
+   if (!report.empty()) {
+      saveInternalEntry(WARNING, report);
+   }
+}
+
+bool LogRotateWithFilter::isCrashRingLevel(const LEVELS& level) const {
+   return _crash_ring_levels.end() != std::find(_crash_ring_levels.begin(), _crash_ring_levels.end(), level);
+}
+
+/// Writes an entry that originates from the sink itself, formatted as any other entry
+void LogRotateWithFilter::saveInternalEntry(const LEVELS& level, const std::string& text) {
+   g3::LogMessage entry(__FILE__, __LINE__, __FUNCTION__, level);
+   entry.write() = text;
+   _logger->save(entry.toString(_log_details_func));
+}
+
 std::string LogRotateWithFilter::changeLogFile(const std::string& log_directory) {
     return _logger->changeLogFile(log_directory);
 }
@@ -75,6 +192,7 @@ void LogRotateWithFilter::setMaxLogSize(int max_file_size) {
 */
 void LogRotateWithFilter::setFlushPolicy(size_t flush_policy){
    _logger->setFlushPolicy(flush_policy);
+   updateFlushed();
 }
 
 /**
@@ -83,7 +201,53 @@ void LogRotateWithFilter::setFlushPolicy(size_t flush_policy){
 * the logs faster than the flush_policy
 */
 void LogRotateWithFilter::flush(){
+   drainSpill();
+   saveRepeatSummary();
+   saveDroppedReport(true);
    _logger->flush();
+   updateFlushed();
+}
+
+/**
+* End to end latency of the entries, from their creation (the LOG call) until the LogRotate has
+* written them, and until it has flushed them. With the default flush policy of 1 the two are the same.
+* A summary line with the percentiles since the previous summary is written every @param summary_interval
+* Spilled entries count from their creation until they are written. Crash ring dumps, repeat summaries
+* and the sink's own reports are not measured.
+*/
+void LogRotateWithFilter::setLatencyTracking(bool enabled, std::chrono::seconds summary_interval) {
+   _latency.enable(enabled, summary_interval);
+   _flush_count = _logger->getFlushCount();
+}
+
+/// @return the latency histograms since tracking was enabled, use e.g. latency().to_write.percentile(99)
+LogLatency LogRotateWithFilter::latency() {
+   return _latency.latency();
+}
+
+/// @return the numbers of the wrapped LogRotate, see @ref LogRotate::stats
+LogRotateStats LogRotateWithFilter::stats() {
+   return _logger->stats();
+}
+
+/// see @ref LogRotate::setStatsDump
+void LogRotateWithFilter::setStatsDump(const std::string& file_path, std::chrono::seconds interval) {
+   _logger->setStatsDump(file_path, interval);
+}
+
+/// see @ref LogRotate::setArchiveSyncPoints
+void LogRotateWithFilter::setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every) {
+   _logger->setArchiveSyncPoints(every_bytes, every);
+}
+
+/// see @ref LogRotate::setArchiveBloomFilter
+void LogRotateWithFilter::setArchiveBloomFilter(bool enabled) {
+   _logger->setArchiveBloomFilter(enabled);
+}
+
+/// see @ref LogRotate::setArchiveSync
+void LogRotateWithFilter::setArchiveSync(bool enabled) {
+   _logger->setArchiveSync(enabled);
 }
 
 
@@ -93,4 +257,190 @@ void LogRotateWithFilter::flush(){
 */
 void LogRotateWithFilter::overrideLogDetails(g3::LogMessage::LogDetailsFunc func) {
    _log_details_func = func;
-}
\ No newline at end of file
+}
+
+
+/**
+* Suppress repeated log entries. An entry is a repeat if it comes from the same call site
+* (file and line) with the same message as the previous entry. Repeats are counted, not written,
+* until a different entry arrives, the window since the first entry expires or at flush/exit.
+* The count is then written as "last message repeated N times".
+*
+* @param window for how long a sequence of repeats can be collapsed. 0 disables suppression
+*/
+void LogRotateWithFilter::setRepeatSuppression(std::chrono::milliseconds window) {
+   saveRepeatSummary();
+   _repeat_window = window;
+}
+
+/**
+* Sampling of a log level. On average 1 in @param one_in entries of @param level are kept.
+* Which entries are kept is random. 0 or 1 keeps all entries
+*/
+void LogRotateWithFilter::setLevelSampling(LEVELS level, uint32_t one_in) {
+   _limiter.setSampling(level, one_in);
+}
+
+/**
+* Token bucket rate limit of a log level.
+* @param per_second is the max sustained number of entries per second, 0 removes the limit
+* @param burst is the max number of entries at once, by default the same as @param per_second
+*/
+void LogRotateWithFilter::setLevelRateLimit(LEVELS level, double per_second, double burst) {
+   _limiter.setRateLimit(level, per_second, burst);
+}
+
+/// @param interval at most this often the number of dropped entries are written to the log
+void LogRotateWithFilter::setDroppedReportInterval(std::chrono::milliseconds interval) {
+   _limiter.setReportInterval(interval);
+}
+
+/**
+* Crash ring: entries with @param ring_levels are not written but kept in memory, as unformatted
+* entries, up to @param max_bytes. When full the oldest entries are evicted. The ring is written
+* to the log when an entry at or above the trigger level arrives (see @ref setCrashRingTrigger)
+* or on demand with @ref dumpCrashRing.
+*
+* Typical use is to always capture DEBUG without paying for disk writes, and still get
+* the full context around a failure.
+*/
+void LogRotateWithFilter::setCrashRing(std::vector<LEVELS> ring_levels, size_t max_bytes) {
+   if (ring_levels.empty() || 0 == max_bytes) {
+      ring_levels.clear();
+      max_bytes = 0;
+   }
+   _crash_ring_levels = std::move(ring_levels);
+   _crash_ring.setMaxBytes(max_bytes);
+}
+
+/// @param trigger entries with this level value or higher dump the crash ring before they are written
+void LogRotateWithFilter::setCrashRingTrigger(LEVELS trigger) {
+   _crash_ring_trigger = trigger;
+}
+
+/**
+* Writes the crash ring content, oldest entry first, to the log and empties the ring
+* @return the number of dumped entries
+*/
+size_t LogRotateWithFilter::dumpCrashRing() {
+   if (0 == _crash_ring.size()) {
+      return 0;
+   }
+
+   std::string begin = "g3sinks: crash ring dump of " + std::to_string(_crash_ring.size()) + " entries";
+   if (_crash_ring.evicted()) {
+      begin += ", " + std::to_string(_crash_ring.evicted()) + " older entries were evicted";
+   }
+   saveInternalEntry(WARNING, begin);
+   auto dumped = _crash_ring.drain([this](const g3::LogMessage& entry) {
+      _logger->save(entry.toString(_log_details_func));
+   });
+   saveInternalEntry(WARNING, "g3sinks: crash ring dump end");
+   return dumped;
+}
+
+/**
+* Overload protection of the sink. See @ref OverloadPolicy. With action kNone the backlog and
+* write latency are measured, and overload is reported in-band, but no entries are dropped.
+*
+* The backlog is measured with the LogMessage timestamp, i.e. the wall clock. A wall clock jump
+* can give a false overload, or hide one, for a short while.
+*/
+void LogRotateWithFilter::setOverloadPolicy(OverloadPolicy policy) {
+   drainSpill();
+   policy.sample_one_in = std::max(policy.sample_one_in, uint32_t{1});
+   _overload_policy = policy;
+   _overload_enabled = true;
+   _spill.setMaxBytes(policy.spill_max_bytes);
+}
+
+/// @return the overload measurements and counters
+LogRotateWithFilter::OverloadStatus LogRotateWithFilter::overloadStatus() {
+   OverloadStatus status = _overload_status;
+   status.dropped += _spill.evicted();
+   status.spilled = _spill.size();
+   return status;
+}
+
+/// Starts, or ends, overload depending on the backlog of @param message and the write latency
+void LogRotateWithFilter::updateOverload(const g3::LogMessage& message) {
+   auto now = decltype(message._timestamp)::clock::now();
+   auto backlog = std::chrono::duration_cast<std::chrono::microseconds>(now - message._timestamp);
+   _overload_status.backlog = backlog;
+   auto max_latency = _overload_policy.max_write_latency;
+   auto latency = _overload_status.write_latency;
+   bool checkLatency = (max_latency.count() > 0);
+
+   if (!_overload_status.overloaded) {
+      if (backlog > _overload_policy.max_backlog || (checkLatency && latency > max_latency)) {
+         _overload_status.overloaded = true;
+         _overload_dropped = 0;
+         saveInternalEntry(WARNING, "g3sinks: overload started, backlog " + std::to_string(backlog.count() / 1000)
+                           + " ms, write latency " + std::to_string(latency.count()) + " us");
+      }
+      return;
+   }
+
+   // while spilling nothing is written so the write latency is not updated
+   bool latencyIsCalm = (!checkLatency || OverloadPolicy::kSpill == _overload_policy.action || latency < max_latency / 2);
+   if (backlog < _overload_policy.max_backlog / 2 && latencyIsCalm) {
+      endOverload();
+   }
+}
+
+/// @return true if @param message was dropped or spilled by the overload policy
+bool LogRotateWithFilter::isHandledByOverload(g3::LogMessage& message) {
+   if (!_overload_enabled) {
+      return false;
+   }
+
+   updateOverload(message);
+   if (!_overload_status.overloaded) {
+      return false;
+   }
+
+   bool keep = (message._level.value >= _overload_policy.keep_level.value);
+   switch (_overload_policy.action) {
+      case OverloadPolicy::kDropBelowLevel:
+         break;
+      case OverloadPolicy::kSample:
+         keep = keep || (0 == _overload_sample_counter++ % _overload_policy.sample_one_in);
+         break;
+      case OverloadPolicy::kSpill:
+         if (keep || g3::internal::wasFatal(message._level)) {
+            drainSpill(); // written through, after the spilled entries to keep the order
+            return false;
+         }
+         _spill.push(std::move(message));
+         return true;
+      default:
+         return false;
+   }
+
+   if (!keep) {
+      ++_overload_dropped;
+      ++_overload_status.dropped;
+   }
+   return !keep;
+}
+
+void LogRotateWithFilter::endOverload() {
+   _overload_status.overloaded = false;
+   auto evicted = _spill.evicted();
+   auto spilled = _spill.size();
+   drainSpill();
+   saveInternalEntry(WARNING, "g3sinks: overload ended, dropped " + std::to_string(_overload_dropped + evicted)
+                     + " entries, wrote " + std::to_string(spilled) + " spilled entries");
+   _overload_dropped = 0;
+}
+
+/// Writes, in order, the entries kept in memory during overload
+void LogRotateWithFilter::drainSpill() {
+   if (0 == _spill.size() && 0 == _spill.evicted()) {
+      return;
+   }
+   _overload_status.dropped += _spill.evicted();
+   _spill.drain([this](const g3::LogMessage& entry) {
+      writeEntry(entry);
+   });
+}
@@ -0,0 +1,217 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/SeekableGzip.h"
+#include "g3sinks/LogFileReader.h"
+#include "g3sinks/TokenBloomFilter.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <zlib.h>
+
+namespace {
+   const char* kIndexHeader = "# g3sinks seekable gzip index 1: compressed_offset uncompressed_offset line_number timestamp_us";
+   const size_t kWriteChunk = 64 * 1024;
+
+   bool writeChunk(gzFile output, std::string& chunk) {
+      if (chunk.empty()) {
+         return true;
+      }
+      bool written = (gzwrite(output, chunk.data(), static_cast<unsigned>(chunk.size())) == static_cast<int>(chunk.size()));
+      chunk.clear();
+      return written;
+   }
+} // anonymous
+
+namespace SeekableGzip {
+   std::string indexFileName(const std::string& archive) {
+      return archive + ".idx";
+   }
+
+   bool compress(const std::string& file_name, const std::string& gzip_file_name, const SeekableGzipPolicy& policy, uint64_t& input_bytes,
+                 TokenBloomFilter* filter) {
+      input_bytes = 0;
+      std::ifstream input(file_name, std::ios::binary);
+      gzFile output = gzopen(gzip_file_name.c_str(), "wb");
+      if (!input.is_open() || output == NULL) {
+         if (output != NULL) {
+            gzclose(output);
+         }
+         return false;
+      }
+
+      std::vector<SeekableGzipPoint> points;
+      uint64_t point_offset = 0; // of the last sync point, or of the start
+      std::chrono::system_clock::time_point point_time; // of the last sync point, or of the first entry
+      bool has_point_time = false;
+      uint64_t line_number = 0;
+      bool ok = true;
+      std::string line;
+      std::string chunk;
+      chunk.reserve(kWriteChunk);
+      while (ok && std::getline(input, line)) {
+         ++line_number;
+         if (!input.eof()) {
+            line.push_back('\n');
+         }
+         bool bytes_due = policy.every_bytes > 0 && input_bytes - point_offset >= policy.every_bytes;
+         std::chrono::system_clock::time_point timestamp;
+         if ((bytes_due || policy.every.count() > 0) && LogFileParser::parseTimestamp(line.data(), line.size(), timestamp) > 0) {
+            bool time_due = policy.every.count() > 0 && has_point_time && timestamp - point_time >= policy.every;
+            if (bytes_due || time_due) {
+               ok = writeChunk(output, chunk) && (Z_OK == gzflush(output, Z_FULL_FLUSH));
+               SeekableGzipPoint point;
+               point.compressed_offset = static_cast<uint64_t>(gzoffset(output));
+               point.uncompressed_offset = input_bytes;
+               point.line_number = line_number;
+               point.timestamp = timestamp;
+               points.push_back(point);
+               point_offset = input_bytes;
+            }
+            if (bytes_due || time_due || !has_point_time) {
+               point_time = timestamp;
+               has_point_time = true;
+            }
+         }
+         chunk.append(line);
+         input_bytes += line.size();
+         if (nullptr != filter) {
+            filter->addText(line.data(), line.size());
+         }
+         if (chunk.size() >= kWriteChunk) {
+            ok = writeChunk(output, chunk);
+         }
+      }
+      ok = writeChunk(output, chunk) && ok;
+      ok = (gzclose(output) == Z_OK) && ok;
+      if (ok && !points.empty() && !writeIndex(indexFileName(gzip_file_name), points)) {
+         std::cerr << "Cannot write the index of " << gzip_file_name << std::endl;
+      }
+      return ok;
+   }
+
+   bool writeIndex(const std::string& index_file, const std::vector<SeekableGzipPoint>& points) {
+      std::ofstream out(index_file, std::ios::trunc);
+      out << kIndexHeader << "\n";
+      for (auto& point : points) {
+         auto us = std::chrono::duration_cast<std::chrono::microseconds>(point.timestamp.time_since_epoch()).count();
+         out << point.compressed_offset << " " << point.uncompressed_offset << " " << point.line_number << " " << us << "\n";
+      }
+      out.close();
+      return !out.fail();
+   }
+
+   std::vector<SeekableGzipPoint> readIndex(const std::string& index_file) {
+      std::ifstream in(index_file);
+      std::string line;
+      if (!std::getline(in, line) || line != kIndexHeader) {
+         return {};
+      }
+      std::vector<SeekableGzipPoint> points;
+      while (std::getline(in, line)) {
+         std::istringstream fields(line);
+         SeekableGzipPoint point;
+         long long us = 0;
+         if (!(fields >> point.compressed_offset >> point.uncompressed_offset >> point.line_number >> us)) {
+            return {};
+         }
+         point.timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(us)));
+         points.push_back(point);
+      }
+      return points;
+   }
+
+   const SeekableGzipPoint* findPoint(const std::vector<SeekableGzipPoint>& points, std::chrono::system_clock::time_point from) {
+      const SeekableGzipPoint* found = nullptr;
+      for (auto& point : points) {
+         if (point.timestamp > from) {
+            break;
+         }
+         found = &point;
+      }
+      return found;
+   }
+} // SeekableGzip
+
+SeekableGzipReader::SeekableGzipReader(const std::string& archive, uint64_t compressed_offset)
+   : _file(std::fopen(archive.c_str(), "rb"))
+   , _stream(new z_stream_s)
+   , _in(64 * 1024)
+   , _out(128 * 1024)
+   , _out_start(0)
+   , _out_end(0)
+   , _end(false) {
+   std::memset(_stream.get(), 0, sizeof(z_stream_s));
+   if (nullptr == _file) {
+      std::cerr << "Cannot open archive: " << archive << std::endl;
+      return;
+   }
+   // raw deflate: a sync point has no gzip header
+   if (0 != std::fseek(_file, static_cast<long>(compressed_offset), SEEK_SET) || Z_OK != inflateInit2(_stream.get(), -MAX_WBITS)) {
+      std::cerr << "Cannot read archive: " << archive << " from offset " << compressed_offset << std::endl;
+      std::fclose(_file);
+      _file = nullptr;
+   }
+}
+
+SeekableGzipReader::~SeekableGzipReader() {
+   if (nullptr != _file) {
+      inflateEnd(_stream.get());
+      std::fclose(_file);
+   }
+}
+
+/// Decompresses the next part of the archive. @return false at the end
+bool SeekableGzipReader::fill() {
+   _out_start = 0;
+   _out_end = 0;
+   while (!_end && 0 == _out_end) {
+      if (0 == _stream->avail_in) {
+         size_t read = std::fread(_in.data(), 1, _in.size(), _file);
+         if (0 == read) {
+            _end = true;
+            break;
+         }
+         _stream->next_in = _in.data();
+         _stream->avail_in = static_cast<uInt>(read);
+      }
+      _stream->next_out = reinterpret_cast<Bytef*>(_out.data());
+      _stream->avail_out = static_cast<uInt>(_out.size());
+      int status = inflate(_stream.get(), Z_NO_FLUSH);
+      _out_end = _out.size() - _stream->avail_out;
+      if (Z_STREAM_END == status) {
+         _end = true; // the gzip trailer follows
+      } else if (Z_OK != status && Z_BUF_ERROR != status) {
+         std::cerr << "Corrupt archive data: " << (nullptr == _stream->msg ? "" : _stream->msg) << std::endl;
+         _end = true;
+      }
+   }
+   return _out_end > 0;
+}
+
+bool SeekableGzipReader::getLine(std::string& line) {
+   if (!isOpen()) {
+      return false;
+   }
+   size_t size = line.size();
+   while (_out_start < _out_end || fill()) {
+      const char* start = _out.data() + _out_start;
+      const char* newline = static_cast<const char*>(std::memchr(start, '\n', _out_end - _out_start));
+      size_t length = (nullptr == newline) ? (_out_end - _out_start) : static_cast<size_t>(newline - start) + 1;
+      line.append(start, length);
+      _out_start += length;
+      if (nullptr != newline) {
+         break;
+      }
+   }
+   return line.size() > size;
+}
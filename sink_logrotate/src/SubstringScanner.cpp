@@ -0,0 +1,116 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/SubstringScanner.h"
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define G3SINKS_SCANNER_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+   char lower(char c) {
+      return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+   }
+
+   char upper(char c) {
+      return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+   }
+
+#if defined(G3SINKS_SCANNER_SSE2)
+   unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return static_cast<unsigned>(index);
+#else
+      return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+   }
+
+   /// @return a bit per byte of @param block that is @param either[0] or @param either[1]
+   __m128i equalTo(__m128i block, const char either[2]) {
+      __m128i equal = _mm_cmpeq_epi8(block, _mm_set1_epi8(either[0]));
+      if (either[1] != either[0]) {
+         equal = _mm_or_si128(equal, _mm_cmpeq_epi8(block, _mm_set1_epi8(either[1])));
+      }
+      return equal;
+   }
+#endif
+} // anonymous
+
+SubstringScanner::SubstringScanner(const std::string& needle, bool ignore_case)
+   : _needle(needle)
+   , _ignore_case(ignore_case)
+   , _first{0, 0}
+   , _last{0, 0} {
+   if (_ignore_case) {
+      for (auto& c : _needle) {
+         c = lower(c);
+      }
+   }
+   if (!_needle.empty()) {
+      _first[0] = _first[1] = _needle.front();
+      _last[0] = _last[1] = _needle.back();
+      if (_ignore_case) {
+         _first[1] = upper(_needle.front());
+         _last[1] = upper(_needle.back());
+      }
+   }
+}
+
+bool SubstringScanner::equalAt(const char* text) const {
+   if (!_ignore_case) {
+      return 0 == std::memcmp(text, _needle.data(), _needle.size());
+   }
+   for (size_t i = 0; i < _needle.size(); ++i) {
+      if (lower(text[i]) != _needle[i]) {
+         return false;
+      }
+   }
+   return true;
+}
+
+size_t SubstringScanner::find(const char* text, size_t size) const {
+   const size_t length = _needle.size();
+   if (0 == length) {
+      return 0;
+   }
+   if (size < length) {
+      return std::string::npos;
+   }
+   const size_t last_start = size - length; // the last position where the needle fits
+   size_t position = 0;
+#if defined(G3SINKS_SCANNER_SSE2)
+   for (; position + 16 <= last_start + 1; position += 16) {
+      __m128i firsts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + position));
+      __m128i lasts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + position + length - 1));
+      unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(equalTo(firsts, _first), equalTo(lasts, _last))));
+      while (0 != mask) {
+         unsigned bit = lowestBit(mask);
+         if (equalAt(text + position + bit)) {
+            return position + bit;
+         }
+         mask &= mask - 1;
+      }
+   }
+#endif
+   for (; position <= last_start; ++position) {
+      char first = text[position];
+      char last = text[position + length - 1];
+      if ((first == _first[0] || first == _first[1]) && (last == _last[0] || last == _last[1]) && equalAt(text + position)) {
+         return position;
+      }
+   }
+   return std::string::npos;
+}
@@ -0,0 +1,241 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/TokenBloomFilter.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+   const uint64_t kFnvOffset = 14695981039346656037ULL;
+   const uint64_t kFnvPrime = 1099511628211ULL;
+   const uint64_t kMaxBits = uint64_t(1) << 30; // 128 MiB while building
+   const char kMagic[8] = {'G', '3', 'B', 'L', 'O', 'O', 'M', '1'};
+
+   bool isTokenChar(unsigned char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+   }
+
+   uint64_t hashChar(uint64_t hash, unsigned char c) {
+      if (c >= 'A' && c <= 'Z') {
+         c = static_cast<unsigned char>(c - 'A' + 'a');
+      }
+      return (hash ^ c) * kFnvPrime;
+   }
+
+   /// splitmix64 finalizer, FNV-1a alone spreads short tokens poorly over the low bits
+   uint64_t mix(uint64_t hash) {
+      hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+      return hash ^ (hash >> 31);
+   }
+
+   uint64_t powerOfTwo(uint64_t bits) {
+      uint64_t rounded = 64;
+      while (rounded < bits && rounded < kMaxBits) {
+         rounded <<= 1;
+      }
+      return rounded;
+   }
+
+   size_t popcount(uint64_t word) {
+      size_t count = 0;
+      for (; word; word &= word - 1) {
+         ++count;
+      }
+      return count;
+   }
+} // anonymous
+
+TokenBloomFilter::TokenBloomFilter(uint64_t bits)
+   : _words(powerOfTwo(bits) / 64, 0)
+   , _token_hash(kFnvOffset)
+   , _token_size(0) {}
+
+uint64_t TokenBloomFilter::hashToken(const char* token, size_t size) {
+   uint64_t hash = kFnvOffset;
+   for (size_t i = 0; i < size; ++i) {
+      hash = hashChar(hash, static_cast<unsigned char>(token[i]));
+   }
+   return hash;
+}
+
+void TokenBloomFilter::addText(const char* text, size_t size) {
+   for (size_t i = 0; i < size; ++i) {
+      unsigned char c = static_cast<unsigned char>(text[i]);
+      if (isTokenChar(c)) {
+         _token_hash = hashChar(_token_hash, c);
+         ++_token_size;
+      } else if (_token_size > 0) {
+         finish();
+      }
+   }
+}
+
+void TokenBloomFilter::finish() {
+   if (_token_size >= kMinTokenLength) {
+      addHash(_token_hash);
+   }
+   _token_hash = kFnvOffset;
+   _token_size = 0;
+}
+
+/// Double hashing, h1 + i * h2, on the mixed hash
+void TokenBloomFilter::addHash(uint64_t hash) {
+   uint64_t h1 = mix(hash);
+   uint64_t h2 = mix(h1) | 1;
+   uint64_t mask = bits() - 1;
+   for (unsigned i = 0; i < kHashes; ++i) {
+      uint64_t bit = (h1 + i * h2) & mask;
+      _words[bit >> 6] |= uint64_t(1) << (bit & 63);
+   }
+}
+
+bool TokenBloomFilter::mayContainHash(uint64_t hash) const {
+   uint64_t h1 = mix(hash);
+   uint64_t h2 = mix(h1) | 1;
+   uint64_t mask = bits() - 1;
+   for (unsigned i = 0; i < kHashes; ++i) {
+      uint64_t bit = (h1 + i * h2) & mask;
+      if (0 == (_words[bit >> 6] & (uint64_t(1) << (bit & 63)))) {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool TokenBloomFilter::mayContain(const std::string& text, bool whole_words) const {
+   size_t i = 0;
+   while (i < text.size()) {
+      if (!isTokenChar(static_cast<unsigned char>(text[i]))) {
+         ++i;
+         continue;
+      }
+      size_t start = i;
+      while (i < text.size() && isTokenChar(static_cast<unsigned char>(text[i]))) {
+         ++i;
+      }
+      bool partial = !whole_words && (0 == start || text.size() == i);
+      if (!partial && i - start >= kMinTokenLength && !mayContainHash(hashToken(text.data() + start, i - start))) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/// Bit b of a filter of m bits is bit b mod m/2 of the folded filter, which is what addHash() and
+/// mayContainHash() look up with the smaller mask
+void TokenBloomFilter::compact(uint64_t min_bits) {
+   while (bits() / 2 >= min_bits && _words.size() >= 2) {
+      size_t half = _words.size() / 2;
+      size_t folded_bits = 0;
+      for (size_t i = 0; i < half; ++i) {
+         folded_bits += popcount(_words[i] | _words[i + half]);
+      }
+      if (folded_bits * 2 > half * 64) {
+         return;
+      }
+      for (size_t i = 0; i < half; ++i) {
+         _words[i] |= _words[i + half];
+      }
+      _words.resize(half);
+   }
+}
+
+double TokenBloomFilter::fillRatio() const {
+   size_t set = 0;
+   for (auto word : _words) {
+      set += popcount(word);
+   }
+   return static_cast<double>(set) / static_cast<double>(bits());
+}
+
+bool TokenBloomFilter::save(const std::string& file_path) const {
+   std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+   uint32_t header[2] = {kHashes, 0};
+   uint64_t bit_count = bits();
+   out.write(kMagic, sizeof(kMagic));
+   out.write(reinterpret_cast<const char*>(header), sizeof(header));
+   out.write(reinterpret_cast<const char*>(&bit_count), sizeof(bit_count));
+   out.write(reinterpret_cast<const char*>(_words.data()), static_cast<std::streamsize>(_words.size() * sizeof(uint64_t)));
+   out.close();
+   return !out.fail();
+}
+
+bool TokenBloomFilter::load(const std::string& file_path) {
+   std::ifstream in(file_path, std::ios::binary);
+   char magic[sizeof(kMagic)] = {};
+   uint32_t header[2] = {};
+   uint64_t bit_count = 0;
+   in.read(magic, sizeof(magic));
+   in.read(reinterpret_cast<char*>(header), sizeof(header));
+   in.read(reinterpret_cast<char*>(&bit_count), sizeof(bit_count));
+   if (!in || 0 != std::memcmp(magic, kMagic, sizeof(kMagic)) || kHashes != header[0] || bit_count < 64
+       || bit_count > kMaxBits || 0 != (bit_count & (bit_count - 1))) {
+      return false;
+   }
+   std::vector<uint64_t> words(bit_count / 64);
+   in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));
+   if (!in) {
+      return false;
+   }
+   _words.swap(words);
+   return true;
+}
+
+namespace ArchiveBloomFilter {
+   std::string filterFileName(const std::string& archive) {
+      return archive + ".bloom";
+   }
+
+   TokenBloomFilter forLog(uint64_t log_bytes) {
+      // half a bit per byte of log is room for a distinct token every few bytes, compact() shrinks it
+      return TokenBloomFilter(log_bytes / 2);
+   }
+
+   bool save(TokenBloomFilter& filter, const std::string& archive) {
+      filter.finish();
+      filter.compact();
+      if (!filter.save(filterFileName(archive))) {
+         std::cerr << "Cannot write the Bloom filter of " << archive << std::endl;
+         std::remove(filterFileName(archive).c_str());
+         return false;
+      }
+      return true;
+   }
+
+   bool build(const std::string& file_name, const std::string& archive) {
+      FILE* input = std::fopen(file_name.c_str(), "rb");
+      if (nullptr == input) {
+         return false;
+      }
+      std::fseek(input, 0, SEEK_END);
+      long size = std::ftell(input);
+      std::fseek(input, 0, SEEK_SET);
+
+      TokenBloomFilter filter = forLog(static_cast<uint64_t>(size > 0 ? size : 0));
+      std::vector<char> buffer(64 * 1024);
+      size_t read;
+      while ((read = std::fread(buffer.data(), 1, buffer.size(), input)) > 0) {
+         filter.addText(buffer.data(), read);
+      }
+      std::fclose(input);
+      return save(filter, archive);
+   }
+
+   bool mayContain(const std::string& archive, const std::string& text, bool whole_words) {
+      TokenBloomFilter filter;
+      if (!filter.load(filterFileName(archive))) {
+         return true;
+      }
+      return filter.mayContain(text, whole_words);
+   }
+} // ArchiveBloomFilter
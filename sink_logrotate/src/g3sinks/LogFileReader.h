@@ -0,0 +1,126 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "g3sinks/SeekableGzip.h"
+
+struct gzFile_s;
+
+/// One log entry as LogRotate wrote it: the line with the g3log details and the lines that
+/// continue its message, e.g. of a stack trace
+struct LogFileEntry {
+   std::chrono::system_clock::time_point timestamp;
+   std::string level;
+   std::string thread; // only with g3log's FullLogDetailsToString
+   std::string file;
+   std::string function;
+   int line = 0;
+   std::string message; // continuation lines included, without the last line break
+   uint64_t offset = 0; // of the first line, in the uncompressed log
+   uint64_t line_number = 0; // of the first line, 1 based
+   size_t size = 0; // bytes in the log, details and line breaks included
+};
+
+namespace LogFileParser {
+   /// Parses the g3log default timestamp "%Y/%m/%d %H:%M:%S" with an optional fraction, e.g. " 123456",
+   /// in local time. @return the length of the timestamp, 0 if @param text does not start with one
+   size_t parseTimestamp(const char* text, size_t size, std::chrono::system_clock::time_point& result);
+
+   /// Parses a line formatted by g3log's DefaultLogDetailsToString or FullLogDetailsToString:
+   ///    2026/10/18 12:00:00 123456<tab>INFO [file.cpp->function:123]<tab>message
+   /// @return false for lines that do not start an entry, @param entry is then unchanged
+   bool parseLine(const std::string& line, LogFileEntry& entry);
+} // LogFileParser
+
+/**
+* Reads the entries of a LogRotate log, or of a gzip archive of one. Lines that are not part of
+* an entry, e.g. the file header and the shutdown line, are skipped and counted. Not thread safe.
+*
+*    LogFileReader reader("/var/log/app.log.2026-10-18-12-00-00.gz");
+*    LogFileEntry entry;
+*    while (reader.next(entry)) { ... }
+*
+* Archives written with sync points, see SeekableGzip.h, are read from the sync point before a given time
+* instead of from the start:
+*    reader.readRange(from, to, [](const LogFileEntry& entry) { ...; return true; });
+*/
+class LogFileReader {
+ public:
+   LogFileReader(const LogFileReader&) = delete;
+   LogFileReader& operator=(const LogFileReader&) = delete;
+
+   /// @param file_path a log or a .gz archive, zlib reads both
+   explicit LogFileReader(const std::string& file_path);
+   virtual ~LogFileReader();
+
+   bool isOpen() const { return nullptr != _file; }
+   const std::string& path() const { return _path; }
+
+   /// @return false at the end of the file
+   bool next(LogFileEntry& entry);
+
+   /// Continues reading at the last sync point of the archive index at or before @param from. The entries from
+   /// there to @param from are still returned by next(). @return false if there is no index or no such sync
+   /// point, the reader is then unchanged
+   bool seek(std::chrono::system_clock::time_point from);
+
+   /// Calls @param callback with the entries from @param from up to, not including, @param to. Stops at the
+   /// first entry at or after @param to, or when @param callback returns false. @return the entries passed
+   uint64_t readRange(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+                      const std::function<bool(const LogFileEntry&)>& callback);
+
+   /// Forgets the end of file so that next() sees what was appended since, for a log that is written to
+   void clearEndOfFile();
+
+   /// For a log that is written to: a last line without its line break is kept until the rest of it is
+   /// written, instead of being read as it is. The last entry is kept until the next one starts, or until
+   /// nothing was added to it for @param hold, the rest of its message, e.g. of a stack trace, may be
+   /// flushed later
+   void setFollow(bool follow, std::chrono::milliseconds hold = std::chrono::milliseconds(1000)) {
+      _follow = follow;
+      _hold = hold;
+   }
+
+   /// Lines that were not part of an entry
+   uint64_t skippedLines() const { return _skipped_lines; }
+
+ private:
+   bool readLine(std::string& line);
+
+   std::string _path;
+   gzFile_s* _file;
+   std::unique_ptr<SeekableGzipReader> _archive_reader; // after seek(), instead of _file
+   uint64_t _offset; // of the next line to read
+   uint64_t _line_number; // of the last line read
+   uint64_t _skipped_lines;
+   bool _has_pending; // a read line that starts the next entry
+   bool _has_current; // the entry that next() reads the message lines of, when following
+   bool _follow;
+   std::chrono::milliseconds _hold;
+   std::chrono::steady_clock::time_point _current_read; // when a line was last added to the current entry
+   std::string _partial; // the start of the last line, when following
+   LogFileEntry _pending;
+   LogFileEntry _current;
+   std::string _line;
+};
+
+namespace LogRotateUtility {
+   /// @return the archives of @param log_prefix in @param dir, oldest first, followed by the current log
+   /// if it exists. The paths include @param dir
+   std::vector<std::string> getLogFileSet(const std::string& dir, const std::string& log_prefix);
+} // LogRotateUtility
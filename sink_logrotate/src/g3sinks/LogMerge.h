@@ -0,0 +1,83 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "g3sinks/LogFileReader.h"
+
+/// The file set of one LogRotate: its archives, oldest first, then its current log
+struct LogMergeSource {
+   std::string dir;
+   std::string prefix;
+};
+
+struct LogMergeOptions {
+   std::chrono::system_clock::time_point from = std::chrono::system_clock::time_point::min(); // earlier entries are skipped
+
+   // Following: at the end of a current log the merger waits for what is written next, and moves on to the
+   // new log when the current one is rotated. While a source has nothing new, the entries of the others are
+   // held back for follow_delay, in case it writes an earlier one. The last entry of a log is also held for
+   // follow_delay until the next one starts, the rest of its message may be flushed later. The rotations are told apart by the
+   // inode of the log, following is POSIX only: on Windows LogMerger ignores it
+   bool follow = false;
+   std::chrono::milliseconds follow_delay{1000};
+   std::chrono::milliseconds poll_interval{200}; // of the logs at their end
+};
+
+namespace LogMergeDetail {
+   class SourceReader;
+} // LogMergeDetail
+
+/**
+* Merges the entries of several LogRotate file sets, e.g. of several processes on a host, into one stream
+* in timestamp order. Each source is read one entry ahead, from one file at a time, so the memory does not
+* grow with the size of the logs. The entries are ordered with a heap on their parsed timestamps, equal
+* timestamps in source order.
+*
+*    LogMerger merger({{"/var/log/api/", "api"}, {"/var/log/worker/", "worker"}}, options);
+*    LogFileEntry entry;
+*    size_t source;
+*    while (merger.next(entry, source)) { ... }
+*/
+class LogMerger {
+ public:
+   LogMerger(const LogMerger&) = delete;
+   LogMerger& operator=(const LogMerger&) = delete;
+
+   LogMerger(const std::vector<LogMergeSource>& sources, const LogMergeOptions& options);
+   virtual ~LogMerger();
+
+   /// @return false at the end of all sources. When following it waits for new entries and returns
+   /// false only after stop(). @param source is the index of the entry's source
+   bool next(LogFileEntry& entry, size_t& source);
+
+   /// Ends a following next(), from another thread
+   void stop() { _stopped = true; }
+
+   const std::vector<LogMergeSource>& sources() const { return _sources; }
+
+ private:
+   void fill(size_t source);
+   bool later(size_t a, size_t b) const;
+
+   std::vector<LogMergeSource> _sources;
+   LogMergeOptions _options;
+   std::vector<std::unique_ptr<LogMergeDetail::SourceReader>> _readers;
+   std::vector<LogFileEntry> _heads; // the next entry of each source
+   std::vector<bool> _has_head;
+   std::vector<size_t> _heap; // of the sources with a head, earliest on top
+   std::chrono::steady_clock::time_point _last_poll;
+   std::atomic<bool> _stopped;
+};
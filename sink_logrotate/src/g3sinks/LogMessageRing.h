@@ -0,0 +1,46 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <g3log/logmessage.hpp>
+
+/**
+* A memory bounded ring of unformatted log entries. The entries are moved in, so
+* keeping an entry costs no formatting and no copy of the message text. When the
+* memory budget is exceeded the oldest entries are evicted.
+*/
+class LogMessageRing {
+  public:
+    explicit LogMessageRing(size_t max_bytes = 0);
+
+    void setMaxBytes(size_t max_bytes);
+    size_t maxBytes() const { return _max_bytes; }
+    size_t bytes() const { return _bytes; }
+    size_t size() const { return _entries.size(); }
+    size_t evicted() const { return _evicted; }
+
+    void push(g3::LogMessage&& entry);
+
+    /// moves all entries, oldest first, to @param receiver and empties the ring
+    /// @return the number of entries drained
+    size_t drain(const std::function<void(const g3::LogMessage&)>& receiver);
+
+  private:
+    static size_t footprint(const g3::LogMessage& entry);
+    void evict();
+
+    std::deque<g3::LogMessage> _entries;
+    size_t _max_bytes;
+    size_t _bytes;
+    size_t _evicted;
+};
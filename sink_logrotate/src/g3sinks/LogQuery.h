@@ -0,0 +1,73 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "g3sinks/LogFileReader.h"
+
+/// What to look for. An entry matches when it is in the time range, has one of the levels and its
+/// message contains the text. With whole_words the text is not part of longer words, e.g. of a longer
+/// ID, and the Bloom filters of the archives can check all of its words, see TokenBloomFilter::mayContain
+struct LogQuery {
+   std::chrono::system_clock::time_point from = std::chrono::system_clock::time_point::min();
+   std::chrono::system_clock::time_point to = std::chrono::system_clock::time_point::max(); // not included
+   std::vector<std::string> levels; // empty: all levels
+   std::string text; // empty: all entries
+   bool ignore_case = false;
+   bool whole_words = false;
+   size_t threads = 0; // that read the files in parallel, 0: one per core
+};
+
+/// A log or archive to search, with the time its entries are known to be in
+struct LogQueryFile {
+   std::string path;
+   std::chrono::system_clock::time_point oldest = std::chrono::system_clock::time_point::min();
+   std::chrono::system_clock::time_point newest = std::chrono::system_clock::time_point::max();
+};
+
+struct LogQueryStats {
+   uint64_t files = 0;
+   uint64_t skipped_by_time = 0; // files outside of the time range, not opened
+   uint64_t skipped_by_filter = 0; // archives whose Bloom filter rules the text out, not opened
+   uint64_t entries = 0; // read in the time range
+   uint64_t bytes = 0; // of these entries
+   uint64_t matches = 0; // found, fewer than all when the callback stopped the search
+};
+
+/**
+* Searches LogRotate logs and archives. The files are read on a pool of threads, each from the sync point
+* before the start of the time range when it is a seekable archive, see SeekableGzip.h. The messages are
+* matched with a SubstringScanner. The matches of all files are merged in timestamp order as they are found,
+* each thread reads at most a thousand or so matches ahead of the merge.
+*
+*    LogQuery query;
+*    query.text = "req-7f3a9c";
+*    query.whole_words = true;
+*    LogQueryEngine::searchDirectory("/var/log/myapp/", "myapp", query,
+*                                    [](const std::string& path, const LogFileEntry& entry) { ...; return true; });
+*/
+namespace LogQueryEngine {
+   using MatchCallback = std::function<bool(const std::string& path, const LogFileEntry& entry)>;
+
+   /// Calls @param callback for the matches in timestamp order, until it returns false
+   LogQueryStats search(const std::vector<LogQueryFile>& files, const LogQuery& query, const MatchCallback& callback);
+
+   /// Searches the archives of @param log_prefix in @param dir and its current log. Their times are
+   /// taken from the archive names, an archive holds the entries since the previous rotation
+   LogQueryStats searchDirectory(const std::string& dir, const std::string& log_prefix, const LogQuery& query, const MatchCallback& callback);
+
+   /// @return the files of searchDirectory(), oldest first
+   std::vector<LogQueryFile> logFiles(const std::string& dir, const std::string& log_prefix);
+} // LogQueryEngine
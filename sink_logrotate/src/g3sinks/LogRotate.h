@@ -13,11 +13,39 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
+#include <cstdint>
+#include <g3sinks/LatencyHistogram.h>
 
 
 
 struct LogRotateHelper;
 
+/**
+* Runtime numbers of a LogRotate. Read them on the sink thread, e.g.
+*    auto stats = sinkHandle->call(&LogRotate::stats).get();
+* or let LogRotate write them regularly as Prometheus text, see @ref LogRotate::setStatsDump
+*/
+struct LogRotateStats {
+   uint64_t bytes_written = 0;
+   uint64_t records_written = 0;
+   uint64_t flushes = 0;
+   uint64_t write_errors = 0; // failed writes or flushes, e.g. on a full disk. Writing continues with the next entry
+   uint64_t fsyncs = 0; // archives synced before the log they replace is removed, see setArchiveSync()
+   uint64_t rotations = 0;
+   uint64_t compressed_input_bytes = 0;
+   uint64_t compressed_output_bytes = 0;
+   double compression_ratio = 0; // input / output bytes of all archives, 0 before the first rotation
+   std::chrono::microseconds last_compress_duration{0};
+   std::chrono::microseconds total_compress_duration{0};
+   std::chrono::microseconds last_expire_duration{0};
+   std::chrono::microseconds total_expire_duration{0};
+   LatencyHistogram write_latency; // per save(), including the flush when the flush policy asks for it
+
+   /// @return the stats in the Prometheus text exposition format, labeled with @param log_name
+   std::string prometheusText(const std::string& log_name) const;
+};
+
 /**
 * \param log_prefix is the 'name' of the binary, this give the log name 'LOG-'name'-...
 * \param log_directory gives the directory to put the log files */
@@ -49,6 +77,27 @@ class LogRotate {
 
     bool rotateLog();
 
+    LogRotateStats stats();
+    uint64_t getFlushCount(); // cheap, unlike stats()
+
+    // Writes stats() as Prometheus text to file_path, at most once per interval, checked when
+    // an entry is saved. The file is replaced atomically, e.g. for the node_exporter textfile collector.
+    // An empty file_path disables it (default)
+    void setStatsDump(const std::string& file_path, std::chrono::seconds interval);
+
+    // Archives get a sync point every every_bytes of log or every seconds of log time, whichever
+    // comes first, and a "<archive>.idx" index of them, see SeekableGzip.h. LogFileReader then reads
+    // an archive from a given time without decompressing what comes before. 0, 0: disabled (default)
+    void setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every);
+
+    // Archives get a Bloom filter of their tokens, "<archive>.bloom", see TokenBloomFilter.h. A search
+    // for a word or an ID then skips the archives that cannot contain it. Default: disabled
+    void setArchiveBloomFilter(bool enabled);
+
+    // Archives are fsync'ed before the log they replace is removed, so a power loss right after a
+    // rotation loses neither. The fsync is on the sink thread. Default: disabled
+    void setArchiveSync(bool enabled);
+
   private:
     std::unique_ptr<LogRotateHelper> pimpl_;
 };
@@ -12,21 +12,58 @@
 #pragma once
 
 #include <g3sinks/LogRotate.h>
+#include <g3sinks/LogLevelLimiter.h>
+#include <g3sinks/LogLatencyTracker.h>
+#include <g3sinks/LogMessageRing.h>
 #include <utility>
 #include <memory>
 #include <vector>
+#include <chrono>
 #include <g3log/loglevels.hpp>
 #include <g3log/logmessage.hpp>
 
 /**
 * Wraps a LogRotate file logger. It only forwareds log LEVELS
 * that are NOT in the filter
+*
+* Optionally verbose LEVELS can be kept in an in-memory crash ring instead of
+* being written. The ring is written to the log when an entry at or above the
+* crash ring trigger level (default FATAL) arrives or when dumpCrashRing() is called.
 */
 class LogRotateWithFilter {
     using LogRotateUniquePtr = std::unique_ptr<LogRotate>;
     using IgnoreLogLevelsFilter = std::vector<LEVELS>;
 
   public:
+    /**
+    * Overload protection. The sink measures its backlog, the time from the LOG call until the
+    * entry reaches the sink, and the write latency. When either exceeds its limit the action is
+    * applied until the backlog, and write latency, is back under half of the limit.
+    * An in-band entry tells when overload starts, when it ends and how many entries were dropped.
+    */
+    struct OverloadPolicy {
+      enum Action {
+        kNone,           // measure only
+        kDropBelowLevel, // drop entries below keep_level
+        kSample,         // keep 1 in sample_one_in entries below keep_level
+        kSpill           // keep entries below keep_level in memory, up to spill_max_bytes, and write them when
+                         // the overload ends. An entry at or above keep_level is written with the ones before it
+      };
+      Action action = kNone;
+      std::chrono::milliseconds max_backlog{1000};
+      std::chrono::microseconds max_write_latency{0}; // 0: write latency is not a limit
+      LEVELS keep_level = WARNING; // entries at or above are never dropped
+      uint32_t sample_one_in = 10;
+      size_t spill_max_bytes = 8 * 1024 * 1024;
+    };
+
+    struct OverloadStatus {
+      bool overloaded = false;
+      std::chrono::microseconds backlog{0}; // of the latest entry
+      std::chrono::microseconds write_latency{0}; // moving average
+      uint64_t dropped = 0; // total, including spilled entries that were evicted
+      size_t spilled = 0; // entries currently kept in memory
+    };
 
     static std::unique_ptr<LogRotateWithFilter> CreateLogRotateWithFilter(std::string filename, std::string directory, std::vector<LEVELS> filter);
 
@@ -42,14 +79,79 @@ class LogRotateWithFilter {
     void setFlushPolicy(size_t flush_policy); // 0: never (system auto flush), 1 ... N: every n times
     void flush();
     void overrideLogDetails(g3::LogMessage::LogDetailsFunc func);
+    LogRotateStats stats();
+    void setStatsDump(const std::string& file_path, std::chrono::seconds interval);
+    void setArchiveSyncPoints(uint64_t every_bytes, std::chrono::seconds every);
+    void setArchiveBloomFilter(bool enabled);
+    void setArchiveSync(bool enabled);
+
+    // Identical messages from the same call site within the window are collapsed into
+    // a single "last message repeated N times" entry. 0: disabled (default)
+    void setRepeatSuppression(std::chrono::milliseconds window);
+
+    // Per level limits, checked before the entry is formatted. Dropped entries are reported in-band
+    void setLevelSampling(LEVELS level, uint32_t one_in); // keep 1 in one_in entries
+    void setLevelRateLimit(LEVELS level, double per_second, double burst = 0); // 0: no limit
+    void setDroppedReportInterval(std::chrono::milliseconds interval);
+
+    // Entries with these LEVELS are kept in memory, up to max_bytes, instead of written to file.
+    // An empty ring_levels or max_bytes of 0 disables the crash ring
+    void setCrashRing(std::vector<LEVELS> ring_levels, size_t max_bytes);
+    void setCrashRingTrigger(LEVELS trigger); // entries at this level or above dump the ring
+    size_t dumpCrashRing(); // @return the number of dumped entries
+
+    void setOverloadPolicy(OverloadPolicy policy);
+    OverloadStatus overloadStatus();
+
+    // Measures the time from the LOG call until an entry is written, and until it is flushed.
+    // Percentiles since the previous summary are written in-band every summary_interval, 0: never
+    void setLatencyTracking(bool enabled, std::chrono::seconds summary_interval = std::chrono::seconds(60));
+    LogLatency latency();
 
 
 
 
   private:
+    // The currently running sequence of identical log entries
+    struct RepeatedEntry {
+      std::string file;
+      int line = 0;
+      size_t hash = 0;
+      size_t count = 0;
+      std::chrono::steady_clock::time_point first_seen;
+      std::unique_ptr<g3::LogMessage> last; // latest suppressed copy, reused for the summary
+    };
+
+    bool isRepeated(g3::LogMessage& message);
+    void saveRepeatSummary();
+    void saveDroppedReport(bool force = false);
+    void saveInternalEntry(const LEVELS& level, const std::string& text);
+    bool isCrashRingLevel(const LEVELS& level) const;
+    void updateOverload(const g3::LogMessage& message);
+    bool isHandledByOverload(g3::LogMessage& message);
+    void endOverload();
+    void drainSpill();
+    void writeEntry(const g3::LogMessage& message);
+    void updateFlushed();
+    void saveLatencySummary(bool force = false);
+
     LogRotateUniquePtr _logger;
     IgnoreLogLevelsFilter _filter;
     g3::LogMessage::LogDetailsFunc _log_details_func;
+    std::chrono::milliseconds _repeat_window;
+    RepeatedEntry _repeated;
+    LogLevelLimiter _limiter;
+    std::vector<LEVELS> _crash_ring_levels;
+    LEVELS _crash_ring_trigger;
+    LogMessageRing _crash_ring;
+    bool _overload_enabled;
+    OverloadPolicy _overload_policy;
+    OverloadStatus _overload_status;
+    uint64_t _overload_dropped; // since overload started
+    uint32_t _overload_sample_counter;
+    LogMessageRing _spill;
+    LogLatencyTracker _latency;
+    uint64_t _flush_count; // of the LogRotate, at the latest check
 
 
 };
\ No newline at end of file
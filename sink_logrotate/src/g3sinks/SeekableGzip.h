@@ -0,0 +1,93 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+class TokenBloomFilter;
+
+/**
+* Seekable archives: while compressing, a full flush (Z_FULL_FLUSH) is inserted at the start of an entry every
+* N bytes or every T seconds of log time. At a full flush the deflate stream is byte aligned and does not refer
+* back to earlier data, so decompression can start there. The archive stays a single valid gzip file for
+* gunzip and zcat, the sync points cost a little compression.
+*
+* The sync points are listed in a sidecar index next to the archive, "<archive>.idx", as text:
+*    # g3sinks seekable gzip index 1: compressed_offset uncompressed_offset line_number timestamp_us
+*    1048890 4194372 41021 1792324800123456
+* The timestamp is of the entry at the sync point, in microseconds since the epoch.
+*/
+struct SeekableGzipPolicy {
+   uint64_t every_bytes = 0; // of the log, 0: no sync points by size
+   std::chrono::seconds every{0}; // of log time, 0: no sync points by time
+
+   bool enabled() const { return every_bytes > 0 || every.count() > 0; }
+};
+
+struct SeekableGzipPoint {
+   uint64_t compressed_offset = 0; // in the archive
+   uint64_t uncompressed_offset = 0; // in the log
+   uint64_t line_number = 0; // in the log, 1 based
+   std::chrono::system_clock::time_point timestamp;
+};
+
+namespace SeekableGzip {
+   /// @return the sidecar index of @param archive
+   std::string indexFileName(const std::string& archive);
+
+   /// Compresses @param file_name to the gzip @param gzip_file_name with sync points at the entries that
+   /// @param policy asks for and writes the index when there are any. @param input_bytes is set to the log size
+   /// @return false if the archive could not be written. A missing index is reported but not a failure
+   /// @param filter when given gets the text of the log, in the same pass
+   bool compress(const std::string& file_name, const std::string& gzip_file_name, const SeekableGzipPolicy& policy, uint64_t& input_bytes,
+                 TokenBloomFilter* filter = nullptr);
+
+   bool writeIndex(const std::string& index_file, const std::vector<SeekableGzipPoint>& points);
+
+   /// @return the sync points in archive order, empty if the index is missing or not readable
+   std::vector<SeekableGzipPoint> readIndex(const std::string& index_file);
+
+   /// @return the last sync point before the first one that is later than @param from, nullptr if the
+   /// archive must be read from the start. Logs are in time order, give or take the queueing in g3log
+   const SeekableGzipPoint* findPoint(const std::vector<SeekableGzipPoint>& points, std::chrono::system_clock::time_point from);
+} // SeekableGzip
+
+/// Decompresses an archive from one of its sync points to the end of the deflate stream
+class SeekableGzipReader {
+ public:
+   SeekableGzipReader(const SeekableGzipReader&) = delete;
+   SeekableGzipReader& operator=(const SeekableGzipReader&) = delete;
+
+   SeekableGzipReader(const std::string& archive, uint64_t compressed_offset);
+   virtual ~SeekableGzipReader();
+
+   bool isOpen() const { return nullptr != _file; }
+
+   /// Appends the next line, up to and including its line break, to @param line. @return false at the end
+   bool getLine(std::string& line);
+
+ private:
+   bool fill();
+
+   FILE* _file;
+   std::unique_ptr<z_stream_s> _stream;
+   std::vector<unsigned char> _in;
+   std::vector<char> _out;
+   size_t _out_start; // of the decompressed bytes not yet returned
+   size_t _out_end;
+   bool _end; // of the deflate stream or of the file
+};
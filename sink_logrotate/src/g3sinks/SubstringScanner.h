@@ -0,0 +1,41 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+* Finds a fixed string in text, 16 positions at a time with SSE2 where the compiler has it. Each block of
+* text is compared with the first and the last character of the needle, only the positions where both
+* match are compared in full. Without SSE2 the same check is done one position at a time.
+*/
+class SubstringScanner {
+ public:
+   /// @param ignore_case matches ASCII letters of either case
+   explicit SubstringScanner(const std::string& needle, bool ignore_case = false);
+
+   /// @return the position of the first match in @param text, std::string::npos if there is none.
+   /// An empty needle matches at 0
+   size_t find(const char* text, size_t size) const;
+
+   bool contains(const std::string& text) const { return std::string::npos != find(text.data(), text.size()); }
+
+   const std::string& needle() const { return _needle; }
+
+ private:
+   bool equalAt(const char* text) const;
+
+   std::string _needle; // in lower case with ignore_case
+   bool _ignore_case;
+   char _first[2]; // the first character of the needle, in lower and upper case
+   char _last[2];
+};
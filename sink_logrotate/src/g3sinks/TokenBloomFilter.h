@@ -0,0 +1,85 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* A Bloom filter of the tokens of a log: the runs of letters, digits and '_' of at least kMinTokenLength
+* characters, case insensitive. "req-7f3a9c user=alice" has the tokens "req", "7f3a9c" and "alice".
+* mayContain() has no false negatives and about 1% false positives.
+*
+* The filter starts large and is folded in half, OR-ing the halves, while it stays sparse, so it ends
+* up sized for the number of distinct tokens without counting them first.
+*/
+class TokenBloomFilter {
+ public:
+   static const size_t kMinTokenLength = 3;
+   static const unsigned kHashes = 7;
+
+   /// @param bits is rounded up to a power of two
+   explicit TokenBloomFilter(uint64_t bits = 0);
+
+   /// @return the hash of a token, case insensitive
+   static uint64_t hashToken(const char* token, size_t size);
+
+   /// Adds the tokens of @param text. A token may continue in the next call, call finish() after the last
+   void addText(const char* text, size_t size);
+   void finish();
+   void addHash(uint64_t hash);
+
+   bool mayContainHash(uint64_t hash) const;
+
+   /// @return false only if one of the tokens of @param text is certainly not in the filter. With
+   /// @param whole_words false the first and the last token of @param text may be part of a longer token,
+   /// e.g. for a substring search, and are not checked when they touch the ends of @param text. A
+   /// single word, e.g. "req7f3a9c", is then not checked at all, search for whole words to skip archives
+   bool mayContain(const std::string& text, bool whole_words = true) const;
+
+   /// Folds the filter while it stays below half full, down to @param min_bits
+   void compact(uint64_t min_bits = 64 * 1024);
+
+   uint64_t bits() const { return static_cast<uint64_t>(_words.size()) * 64; }
+   double fillRatio() const;
+
+   /// The file has the magic "G3BLOOM1", the number of hashes and of bits, then the bits as 64 bit
+   /// words in host byte order
+   bool save(const std::string& file_path) const;
+   bool load(const std::string& file_path);
+
+ private:
+   std::vector<uint64_t> _words;
+   uint64_t _token_hash; // of the token that addText() is in
+   size_t _token_size;
+};
+
+namespace ArchiveBloomFilter {
+   /// @return the sidecar filter of @param archive
+   std::string filterFileName(const std::string& archive);
+
+   /// @return an empty filter for a log of @param log_bytes, to add its text to while it is compressed
+   TokenBloomFilter forLog(uint64_t log_bytes);
+
+   /// Finishes and compacts @param filter and writes it as the sidecar of @param archive
+   /// @return false if the filter could not be written
+   bool save(TokenBloomFilter& filter, const std::string& archive);
+
+   /// Builds the filter of the log @param file_name, for an archive that was made without one, and
+   /// writes it as the sidecar of @param archive. @return false if the filter could not be written
+   bool build(const std::string& file_name, const std::string& archive);
+
+   /// @return false if @param archive certainly does not contain @param text, true when it may or when
+   /// the archive has no filter. See TokenBloomFilter::mayContain
+   bool mayContain(const std::string& archive, const std::string& text, bool whole_words = true);
+} // ArchiveBloomFilter
@@ -0,0 +1,105 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/SharedMemoryCollector.h"
+#include "g3sinks/LogRotate.h"
+
+namespace g3 {
+
+   SharedMemoryCollector::SharedMemoryCollector(const std::string& log_prefix, const std::string& log_directory)
+      : _log(std::make_unique<LogRotate>(log_prefix, log_directory))
+      , _running(true)
+      , _collected(0)
+      , _report_interval(std::chrono::seconds(10)) {}
+
+   SharedMemoryCollector::~SharedMemoryCollector() {
+      stop();
+   }
+
+   void SharedMemoryCollector::addRing(std::unique_ptr<SharedMemoryRing> ring) {
+      if (!ring || !_running) {
+         return;
+      }
+      auto source = std::make_unique<Source>();
+      source->ring = std::move(ring);
+      source->reported = source->ring->counters();
+      source->last_report = std::chrono::steady_clock::now();
+      auto raw = source.get();
+      _sources.push_back(std::move(source));
+      raw->thread = std::thread([this, raw] { collect(*raw); });
+   }
+
+   void SharedMemoryCollector::stop() {
+      if (!_running.exchange(false)) {
+         return;
+      }
+      for (auto& source : _sources) {
+         source->ring->close(); // before the last drain, producers stop pushing
+      }
+      for (auto& source : _sources) {
+         if (source->thread.joinable()) {
+            source->thread.join();
+         }
+      }
+      std::lock_guard<std::mutex> lock(_log_mutex);
+      _log->flush();
+   }
+
+   void SharedMemoryCollector::collect(Source& source) {
+      std::string batch;
+      while (_running.load()) {
+         // the timeout only bounds how long stop() waits, producers wake the collector
+         source.ring->wait(std::chrono::milliseconds(100));
+         while (drain(source, batch) > 0) {
+         }
+         report(source, false);
+      }
+      while (drain(source, batch) > 0) {
+      }
+      report(source, true);
+   }
+
+   /// The drained records are written to the log with one save(), each on its own line
+   size_t SharedMemoryCollector::drain(Source& source, std::string& batch) {
+      batch.clear();
+      size_t drained = source.ring->drain([&batch](const char* data, size_t size) {
+         batch.append(data, size);
+         if (0 == size || '\n' != data[size - 1]) {
+            batch.push_back('\n');
+         }
+      });
+      if (drained > 0) {
+         std::lock_guard<std::mutex> lock(_log_mutex);
+         _log->save(batch);
+         _collected += drained;
+      }
+      return drained;
+   }
+
+   void SharedMemoryCollector::report(Source& source, bool force) {
+      auto now = std::chrono::steady_clock::now();
+      if (!force && now - source.last_report < _report_interval) {
+         return;
+      }
+      auto counters = source.ring->counters();
+      uint64_t dropped = counters.dropped - source.reported.dropped;
+      uint64_t truncated = counters.truncated - source.reported.truncated;
+      uint64_t abandoned = counters.abandoned - source.reported.abandoned;
+      source.reported = counters;
+      source.last_report = now;
+      if (0 == dropped + truncated + abandoned) {
+         return;
+      }
+      std::string name = source.ring->name().empty() ? std::string("memfd") : source.ring->name();
+      std::lock_guard<std::mutex> lock(_log_mutex);
+      _log->save("g3sinks: shared memory ring " + name + " dropped " + std::to_string(dropped) + ", truncated " +
+                 std::to_string(truncated) + " and abandoned " + std::to_string(abandoned) + " records\n");
+   }
+} // g3
@@ -0,0 +1,352 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3sinks/SharedMemoryRing.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <signal.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace g3 {
+
+   // The segment is shared between processes, only address free lock-free atomics can be used
+   static_assert(std::atomic<uint64_t>::is_always_lock_free, "64 bit atomics must be lock-free");
+   static_assert(std::atomic<uint32_t>::is_always_lock_free, "32 bit atomics must be lock-free");
+
+   namespace {
+      const uint64_t kMagic = 0x67337368726d6731; // "g3shrmg1"
+      const uint32_t kVersion = 3;
+      const uint64_t kWriting = uint64_t{1} << 63; // in the sequence of a slot that a producer writes
+
+      struct SlotHeader {
+         std::atomic<uint64_t> sequence; // position: free, position | kWriting: being written, position + 1: published
+         uint32_t size;
+         std::atomic<uint32_t> writer; // the pid of the producer that writes it
+      };
+
+      size_t roundUpToPowerOfTwo(size_t value) {
+         size_t power = 1;
+         while (power < value) {
+            power <<= 1;
+         }
+         return power;
+      }
+
+      long futex(std::atomic<uint32_t>* word, int operation, uint32_t value, const timespec* timeout) {
+         // not FUTEX_PRIVATE_FLAG, the word is shared between processes
+         return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), operation, value, timeout, nullptr, 0);
+      }
+
+      bool isAlive(uint32_t pid) {
+         return 0 == ::kill(static_cast<pid_t>(pid), 0) || EPERM == errno;
+      }
+   } // anonymous
+
+   // The start of the segment, followed by the slots. Producer and collector positions are on
+   // separate cache lines.
+   struct SharedRingHeader {
+      std::atomic<uint64_t> magic; // written last, when the segment is ready
+      uint32_t version;
+      uint32_t slot_size; // including the SlotHeader
+      uint64_t slot_count;
+      std::atomic<uint64_t> dropped;
+      std::atomic<uint64_t> truncated;
+      std::atomic<uint64_t> abandoned;
+      alignas(64) std::atomic<uint64_t> enqueue_position;
+      alignas(64) std::atomic<uint64_t> dequeue_position;
+      alignas(64) std::atomic<uint32_t> wake_sequence; // the futex word
+      std::atomic<uint32_t> collector_waiting;
+      std::atomic<uint32_t> closed; // no collector drains the ring any more
+   };
+
+   namespace {
+      size_t slotsOffset() {
+         return (sizeof(SharedRingHeader) + 63) & ~size_t{63};
+      }
+   } // anonymous
+
+   std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const std::string& name, size_t slot_count, size_t slot_size) {
+      std::string segment = "/" + name;
+      // a collector that crashed left its segment behind, its producers are told to open the new one
+      if (auto previous = Open(name)) {
+         previous->close();
+      }
+      ::shm_unlink(segment.c_str());
+      int fd = ::shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+      if (fd < 0) {
+         std::cerr << "g3sinks: unable to create shared memory ring [" << name << "]: " << std::strerror(errno) << std::endl;
+         return nullptr;
+      }
+      auto ring = Initialize(fd, name, slot_count, slot_size);
+      if (!ring) {
+         ::shm_unlink(segment.c_str());
+      }
+      return ring;
+   }
+
+   std::unique_ptr<SharedMemoryRing> SharedMemoryRing::CreateMemfd(size_t slot_count, size_t slot_size) {
+      int fd = ::memfd_create("g3sinks-ring", MFD_CLOEXEC);
+      if (fd < 0) {
+         std::cerr << "g3sinks: unable to create shared memory ring: " << std::strerror(errno) << std::endl;
+         return nullptr;
+      }
+      return Initialize(fd, "", slot_count, slot_size);
+   }
+
+   std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Initialize(int fd, const std::string& name, size_t slot_count, size_t slot_size) {
+      slot_count = roundUpToPowerOfTwo(slot_count < 2 ? 2 : slot_count);
+      slot_size = (std::max(slot_size, sizeof(SlotHeader) + 1) + 7) & ~size_t{7};
+      size_t segment_size = slotsOffset() + slot_count * slot_size;
+      if (slot_size > UINT32_MAX || 0 != ::ftruncate(fd, static_cast<off_t>(segment_size))) {
+         std::cerr << "g3sinks: unable to size shared memory ring [" << name << "]: " << std::strerror(errno) << std::endl;
+         ::close(fd);
+         return nullptr;
+      }
+      void* segment = ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (MAP_FAILED == segment) {
+         std::cerr << "g3sinks: unable to map shared memory ring [" << name << "]: " << std::strerror(errno) << std::endl;
+         ::close(fd);
+         return nullptr;
+      }
+
+      // ftruncate zero fills, the atomics are placed in the zeroed memory
+      auto header = new (segment) SharedRingHeader;
+      header->version = kVersion;
+      header->slot_size = static_cast<uint32_t>(slot_size);
+      header->slot_count = slot_count;
+      header->dropped.store(0, std::memory_order_relaxed);
+      header->truncated.store(0, std::memory_order_relaxed);
+      header->abandoned.store(0, std::memory_order_relaxed);
+      header->enqueue_position.store(0, std::memory_order_relaxed);
+      header->dequeue_position.store(0, std::memory_order_relaxed);
+      header->wake_sequence.store(0, std::memory_order_relaxed);
+      header->collector_waiting.store(0, std::memory_order_relaxed);
+      header->closed.store(0, std::memory_order_relaxed);
+      char* slots = static_cast<char*>(segment) + slotsOffset();
+      for (uint64_t i = 0; i < slot_count; ++i) {
+         auto slot = new (slots + i * slot_size) SlotHeader;
+         slot->sequence.store(i, std::memory_order_relaxed);
+         slot->size = 0;
+         slot->writer.store(0, std::memory_order_relaxed);
+      }
+      header->magic.store(kMagic, std::memory_order_release);
+      return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(fd, segment, segment_size, name));
+   }
+
+   std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string& name) {
+      std::string segment = "/" + name;
+      int fd = ::shm_open(segment.c_str(), O_RDWR | O_CLOEXEC, 0);
+      if (fd < 0) {
+         return nullptr;
+      }
+      auto ring = Attach(fd);
+      ::close(fd);
+      if (ring) {
+         ring->_name = name;
+      }
+      return ring;
+   }
+
+   std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Attach(int fd) {
+      struct stat status;
+      if (fd < 0 || 0 != ::fstat(fd, &status) || static_cast<size_t>(status.st_size) < slotsOffset()) {
+         return nullptr;
+      }
+      size_t segment_size = static_cast<size_t>(status.st_size);
+      void* segment = ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (MAP_FAILED == segment) {
+         return nullptr;
+      }
+      auto header = static_cast<SharedRingHeader*>(segment);
+      bool valid = kMagic == header->magic.load(std::memory_order_acquire) && kVersion == header->version &&
+                   slotsOffset() + header->slot_count * header->slot_size <= segment_size;
+      int own_fd = valid ? ::fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+      if (own_fd < 0) {
+         ::munmap(segment, segment_size);
+         return nullptr;
+      }
+      return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(own_fd, segment, segment_size, ""));
+   }
+
+   void SharedMemoryRing::Unlink(const std::string& name) {
+      ::shm_unlink(("/" + name).c_str());
+   }
+
+   SharedMemoryRing::SharedMemoryRing(int fd, void* segment, size_t segment_size, const std::string& name)
+      : _fd(fd)
+      , _header(static_cast<SharedRingHeader*>(segment))
+      , _segment_size(segment_size)
+      , _name(name)
+      , _abandon_timeout(std::chrono::seconds(5))
+      , _stalled_position(UINT64_MAX) {}
+
+   SharedMemoryRing::~SharedMemoryRing() {
+      ::munmap(_header, _segment_size);
+      ::close(_fd);
+   }
+
+   char* SharedMemoryRing::slotAt(uint64_t position) const {
+      auto index = position & (_header->slot_count - 1);
+      return reinterpret_cast<char*>(_header) + slotsOffset() + index * _header->slot_size;
+   }
+
+   bool SharedMemoryRing::push(const char* data, size_t size) {
+      size_t max_size = maxRecordSize();
+      bool truncated = size > max_size;
+      char last = (size > 0) ? data[size - 1] : '\0';
+      if (truncated) {
+         size = max_size;
+         _header->truncated.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      // claim a slot
+      uint64_t position = _header->enqueue_position.load(std::memory_order_relaxed);
+      SlotHeader* slot = nullptr;
+      for (;;) {
+         slot = reinterpret_cast<SlotHeader*>(slotAt(position));
+         uint64_t sequence = slot->sequence.load(std::memory_order_acquire) & ~kWriting;
+         auto difference = static_cast<int64_t>(sequence - position);
+         if (0 == difference) {
+            if (_header->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+               break;
+            }
+         } else if (difference < 0) {
+            _header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false; // full
+         } else {
+            position = _header->enqueue_position.load(std::memory_order_relaxed);
+         }
+      }
+
+      // take it over for writing before the record is copied. When the collector gave up on the slot
+      // meanwhile it belongs to a later producer, and nothing is written
+      slot->writer.store(static_cast<uint32_t>(::getpid()), std::memory_order_relaxed);
+      uint64_t claimed = position;
+      if (!slot->sequence.compare_exchange_strong(claimed, position | kWriting, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+         _header->dropped.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+      char* payload = reinterpret_cast<char*>(slot) + sizeof(SlotHeader);
+      std::memcpy(payload, data, size);
+      if (truncated) {
+         payload[size - 1] = last; // a cut record still ends its line
+      }
+      slot->size = static_cast<uint32_t>(size);
+      slot->sequence.store(position + 1, std::memory_order_release);
+
+      // pairs with the fence in wait(): either the collector sees the record or we see that it sleeps
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (0 != _header->collector_waiting.load(std::memory_order_relaxed)) {
+         _header->wake_sequence.fetch_add(1, std::memory_order_relaxed);
+         futex(&_header->wake_sequence, FUTEX_WAKE, INT_MAX, nullptr);
+      }
+      return true;
+   }
+
+   size_t SharedMemoryRing::drain(const std::function<void(const char* data, size_t size)>& consume, size_t max_records) {
+      uint64_t position = _header->dequeue_position.load(std::memory_order_relaxed);
+      size_t drained = 0;
+      while (drained < max_records) {
+         auto slot = reinterpret_cast<SlotHeader*>(slotAt(position));
+         uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+         if (sequence == position + 1) {
+            consume(reinterpret_cast<const char*>(slot) + sizeof(SlotHeader), slot->size);
+            slot->sequence.store(position + _header->slot_count, std::memory_order_release);
+            ++position;
+            ++drained;
+            continue;
+         }
+
+         bool writing = (sequence == (position | kWriting));
+         bool claimed = writing || ((sequence == position) && _header->enqueue_position.load(std::memory_order_relaxed) > position);
+         if (!claimed) {
+            break; // empty
+         }
+         auto now = std::chrono::steady_clock::now();
+         if (_stalled_position != position) {
+            _stalled_position = position;
+            _stalled_since = now;
+            break;
+         }
+         if (now - _stalled_since < _abandon_timeout) {
+            break; // the producer is probably still writing
+         }
+         if (writing && isAlive(slot->writer.load(std::memory_order_relaxed))) {
+            break; // a later producer would get the slot while the record is still copied into it
+         }
+         // the producer stopped before it wrote the record, or died while it wrote it: the slot is given
+         // to later producers. A stopped producer finds out when it takes the slot over for writing
+         uint64_t expected = sequence;
+         if (slot->sequence.compare_exchange_strong(expected, position + _header->slot_count, std::memory_order_acq_rel)) {
+            _header->abandoned.fetch_add(1, std::memory_order_relaxed);
+            ++position;
+         }
+      }
+      _header->dequeue_position.store(position, std::memory_order_release);
+      return drained;
+   }
+
+   bool SharedMemoryRing::wait(std::chrono::milliseconds timeout) {
+      if (!empty()) {
+         return true;
+      }
+      uint32_t wake_sequence = _header->wake_sequence.load(std::memory_order_acquire);
+      _header->collector_waiting.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (empty()) {
+         timespec relative;
+         relative.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+         relative.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+         futex(&_header->wake_sequence, FUTEX_WAIT, wake_sequence, &relative);
+      }
+      _header->collector_waiting.store(0, std::memory_order_relaxed);
+      return !empty();
+   }
+
+   void SharedMemoryRing::close() {
+      _header->closed.store(1, std::memory_order_release);
+   }
+
+   bool SharedMemoryRing::isClosed() const {
+      return 0 != _header->closed.load(std::memory_order_acquire);
+   }
+
+   bool SharedMemoryRing::empty() const {
+      uint64_t position = _header->dequeue_position.load(std::memory_order_relaxed);
+      auto slot = reinterpret_cast<const SlotHeader*>(slotAt(position));
+      return slot->sequence.load(std::memory_order_acquire) != position + 1;
+   }
+
+   SharedMemoryRing::Counters SharedMemoryRing::counters() const {
+      Counters counters;
+      counters.dropped = _header->dropped.load(std::memory_order_relaxed);
+      counters.truncated = _header->truncated.load(std::memory_order_relaxed);
+      counters.abandoned = _header->abandoned.load(std::memory_order_relaxed);
+      return counters;
+   }
+
+   size_t SharedMemoryRing::slotCount() const {
+      return static_cast<size_t>(_header->slot_count);
+   }
+
+   size_t SharedMemoryRing::maxRecordSize() const {
+      return _header->slot_size - sizeof(SlotHeader);
+   }
+} // g3
@@ -0,0 +1,63 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "g3log/logmessage.hpp"
+#include "g3sinks/SharedMemorySink.h"
+#include <unistd.h>
+
+namespace g3 {
+
+   SharedMemorySink::SharedMemorySink(const std::string& ring_name)
+      : _ring_name(ring_name)
+      , _log_details_func(&SharedMemorySink::ProcessLogDetailsToString)
+      , _not_connected_dropped(0) {
+      connect();
+   }
+
+   SharedMemorySink::SharedMemorySink(std::unique_ptr<SharedMemoryRing> ring)
+      : _ring(std::move(ring))
+      , _log_details_func(&SharedMemorySink::ProcessLogDetailsToString)
+      , _not_connected_dropped(0) {}
+
+   void SharedMemorySink::ReceiveLogMessage(LogMessageMover message) {
+      if (_ring && _ring->isClosed()) {
+         // the collector stopped or was restarted, the new ring is opened right away if it exists
+         _ring.reset();
+         _last_connect = std::chrono::steady_clock::time_point();
+      }
+      if (!_ring && !connect()) {
+         ++_not_connected_dropped;
+         return;
+      }
+      _ring->push(message.get().toString(_log_details_func));
+   }
+
+   SharedMemoryRing::Counters SharedMemorySink::ringCounters() const {
+      if (_ring) {
+         return _ring->counters();
+      }
+      return {};
+   }
+
+   std::string SharedMemorySink::ProcessLogDetailsToString(const LogMessage& message) {
+      return "[" + std::to_string(::getpid()) + "] " + LogMessage::DefaultLogDetailsToString(message);
+   }
+
+   /// The collector may start after the logging process, opening is retried at most once per second
+   bool SharedMemorySink::connect() {
+      auto now = std::chrono::steady_clock::now();
+      if (_ring_name.empty() || (_last_connect.time_since_epoch().count() != 0 && now - _last_connect < std::chrono::seconds(1))) {
+         return false;
+      }
+      _last_connect = now;
+      _ring = SharedMemoryRing::Open(_ring_name);
+      return nullptr != _ring;
+   }
+} // g3
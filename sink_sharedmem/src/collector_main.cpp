@@ -0,0 +1,99 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+// g3sinks_collector: creates shared memory rings and writes what processes log to them, with the
+// SharedMemorySink, to one rotating log.
+//
+//    g3sinks_collector [--slots N] [--slot-size BYTES] [--max-log-size BYTES] [--max-archives N]
+//                      <log prefix> <log directory> <ring name>...
+//
+// Stops on SIGINT and SIGTERM after draining the rings.
+
+#include "g3sinks/LogRotate.h"
+#include "g3sinks/SharedMemoryCollector.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+   void usage() {
+      std::cerr << "usage: g3sinks_collector [--slots N] [--slot-size BYTES] [--max-log-size BYTES] [--max-archives N]\n"
+                << "                         <log prefix> <log directory> <ring name>..." << std::endl;
+   }
+} // anonymous
+
+int main(int argc, char** argv) {
+   size_t slots = 4096;
+   size_t slot_size = 1024;
+   int max_log_size = 0;
+   int max_archives = 0;
+   std::vector<std::string> arguments;
+   for (int i = 1; i < argc; ++i) {
+      std::string argument = argv[i];
+      bool has_value = (i + 1 < argc);
+      if ("--slots" == argument && has_value) {
+         slots = std::strtoul(argv[++i], nullptr, 10);
+      } else if ("--slot-size" == argument && has_value) {
+         slot_size = std::strtoul(argv[++i], nullptr, 10);
+      } else if ("--max-log-size" == argument && has_value) {
+         max_log_size = std::atoi(argv[++i]);
+      } else if ("--max-archives" == argument && has_value) {
+         max_archives = std::atoi(argv[++i]);
+      } else if ("-h" == argument || "--help" == argument) {
+         usage();
+         return 0;
+      } else {
+         arguments.push_back(argument);
+      }
+   }
+   if (arguments.size() < 3) {
+      usage();
+      return 1;
+   }
+
+   // block the stop signals in all threads, they are taken with sigwait
+   sigset_t stop_signals;
+   sigemptyset(&stop_signals);
+   sigaddset(&stop_signals, SIGINT);
+   sigaddset(&stop_signals, SIGTERM);
+   pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+   g3::SharedMemoryCollector collector(arguments[0], arguments[1]);
+   {
+      std::lock_guard<std::mutex> lock(collector.mutex());
+      if (max_log_size > 0) {
+         collector.logRotate().setMaxLogSize(max_log_size);
+      }
+      if (max_archives > 0) {
+         collector.logRotate().setMaxArchiveLogCount(max_archives);
+      }
+   }
+
+   std::vector<std::string> rings(arguments.begin() + 2, arguments.end());
+   for (const auto& name : rings) {
+      auto ring = g3::SharedMemoryRing::Create(name, slots, slot_size);
+      if (!ring) {
+         return 1;
+      }
+      collector.addRing(std::move(ring));
+   }
+
+   int signal = 0;
+   sigwait(&stop_signals, &signal);
+   collector.stop();
+   for (const auto& name : rings) {
+      g3::SharedMemoryRing::Unlink(name);
+   }
+   std::cerr << "g3sinks_collector: collected " << collector.collected() << " records" << std::endl;
+   return 0;
+}
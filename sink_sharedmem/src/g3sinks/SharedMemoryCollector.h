@@ -0,0 +1,70 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "g3sinks/SharedMemoryRing.h"
+
+class LogRotate;
+
+namespace g3 {
+   /**
+   * Drains SharedMemoryRings into one LogRotate. Each ring has a collector thread that sleeps
+   * on the ring's futex while it is empty and writes the records it drains as one batch.
+   *
+   * Records that the producers dropped, truncated or abandoned are reported in the log file
+   * at most once per report interval, and when the collector stops.
+   */
+   class SharedMemoryCollector {
+    public:
+      SharedMemoryCollector(const std::string& log_prefix, const std::string& log_directory);
+      virtual ~SharedMemoryCollector();
+      SharedMemoryCollector(const SharedMemoryCollector&) = delete;
+      SharedMemoryCollector& operator=(const SharedMemoryCollector&) = delete;
+
+      /// Starts collecting from the ring
+      void addRing(std::unique_ptr<SharedMemoryRing> ring);
+      /// Closes the rings, drains what is left in them and stops the collector threads
+      void stop();
+
+      void setReportInterval(std::chrono::milliseconds interval) { _report_interval = interval; }
+      /// The LogRotate settings, e.g. max log size and archive count. Lock with mutex() while the collector runs
+      LogRotate& logRotate() { return *_log; }
+      std::mutex& mutex() { return _log_mutex; }
+      uint64_t collected() const { return _collected.load(); }
+
+    private:
+      struct Source {
+         std::unique_ptr<SharedMemoryRing> ring;
+         SharedMemoryRing::Counters reported;
+         std::chrono::steady_clock::time_point last_report;
+         std::thread thread;
+      };
+
+      void collect(Source& source);
+      size_t drain(Source& source, std::string& batch);
+      void report(Source& source, bool force);
+
+      std::unique_ptr<LogRotate> _log;
+      std::mutex _log_mutex;
+      std::vector<std::unique_ptr<Source>> _sources;
+      std::atomic<bool> _running;
+      std::atomic<uint64_t> _collected;
+      std::chrono::milliseconds _report_interval;
+   };
+} // g3
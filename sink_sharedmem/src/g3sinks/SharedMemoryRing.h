@@ -0,0 +1,105 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace g3 {
+   struct SharedRingHeader;
+
+   /**
+   * A lock-free multi-producer, single consumer ring of log records in shared memory.
+   *
+   * The ring is a shared memory segment, either a named POSIX segment (/dev/shm/<name>) that
+   * unrelated processes can open, or a memfd that is inherited by child processes. Any number
+   * of processes and threads push records, one collector pops them.
+   *
+   * It is a bounded queue of fixed size slots (D. Vyukov's bounded MPMC queue). A producer claims
+   * a slot with one compare-and-swap and publishes it with one store. When the ring is full the
+   * record is dropped and counted, a producer never waits for the collector.
+   * A record longer than a slot is truncated and counted, it keeps its last byte, e.g. its '\n'.
+   *
+   * The collector sleeps on a futex in the segment when the ring is empty. Producers only make
+   * the wake up syscall when the collector is sleeping.
+   *
+   * A producer that dies between claiming and publishing a slot would stall the collector. The
+   * collector therefore gives up on such a slot after the abandon timeout and counts it. A producer
+   * takes the slot over for writing before it copies the record, with its pid. The collector only gives
+   * up on a slot that is being written when that process is gone, a stalled producer that resumes
+   * finds out that the slot was given up before it writes to it.
+   *
+   * A collector closes its rings when it stops, and Create() closes the segment it replaces, e.g. of a
+   * collector that crashed. Producers check isClosed() and open the new segment.
+   */
+   class SharedMemoryRing {
+    public:
+      struct Counters {
+         uint64_t dropped = 0; // the ring was full
+         uint64_t truncated = 0; // longer than a slot
+         uint64_t abandoned = 0; // claimed by a producer that did not write it in time, or died while it wrote it
+      };
+
+      /// Creates a named segment, /dev/shm/<name>, an existing segment with the name is closed and replaced.
+      /// @param slot_count is rounded up to a power of two. @return nullptr on failure
+      static std::unique_ptr<SharedMemoryRing> Create(const std::string& name, size_t slot_count = 4096, size_t slot_size = 1024);
+      /// Creates an anonymous memfd segment, share it with fd() through fork() or a unix socket
+      static std::unique_ptr<SharedMemoryRing> CreateMemfd(size_t slot_count = 4096, size_t slot_size = 1024);
+      /// Opens a ring that a collector created. @return nullptr if it does not exist (yet)
+      static std::unique_ptr<SharedMemoryRing> Open(const std::string& name);
+      /// Maps a ring from a segment file descriptor, the descriptor is duplicated
+      static std::unique_ptr<SharedMemoryRing> Attach(int fd);
+      /// Removes the name of a segment, mapped rings stay valid
+      static void Unlink(const std::string& name);
+
+      ~SharedMemoryRing();
+      SharedMemoryRing(const SharedMemoryRing&) = delete;
+      SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+      // Producer side, safe from any thread and process
+      bool push(const char* data, size_t size);
+      bool push(const std::string& record) { return push(record.data(), record.size()); }
+
+      // Collector side, from one thread at the time
+      /// Calls @param consume for at most @param max_records records. @return the number of records
+      size_t drain(const std::function<void(const char* data, size_t size)>& consume, size_t max_records = 256);
+      /// Sleeps until a record is pushed, or at most @param timeout. @return true if a record is ready
+      bool wait(std::chrono::milliseconds timeout);
+      void setAbandonTimeout(std::chrono::milliseconds timeout) { _abandon_timeout = timeout; }
+      /// Tells the producers that the ring is no longer drained
+      void close();
+      bool isClosed() const;
+
+      bool empty() const;
+      Counters counters() const;
+      size_t slotCount() const;
+      size_t maxRecordSize() const;
+      int fd() const { return _fd; }
+      const std::string& name() const { return _name; }
+
+    private:
+      SharedMemoryRing(int fd, void* segment, size_t segment_size, const std::string& name);
+      static std::unique_ptr<SharedMemoryRing> Initialize(int fd, const std::string& name, size_t slot_count, size_t slot_size);
+      char* slotAt(uint64_t position) const;
+
+      int _fd;
+      SharedRingHeader* _header;
+      size_t _segment_size;
+      std::string _name;
+      std::chrono::milliseconds _abandon_timeout;
+      uint64_t _stalled_position; // collector side: the slot that is claimed but not published
+      std::chrono::steady_clock::time_point _stalled_since;
+   };
+} // g3
@@ -0,0 +1,62 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "g3sinks/SharedMemoryRing.h"
+
+namespace g3 {
+   struct LogMessage;
+
+   /**
+   * Writes log records into a SharedMemoryRing that a collector process drains, see SharedMemoryCollector.
+   * Many processes can log through one ring into one log file without locking the file or
+   * interleaving partial lines.
+   *
+   * The sink never waits for the collector: records are dropped, and counted in the ring, when the
+   * ring is full. If the ring does not exist yet the sink tries to open it again at most once per second.
+   * When the collector closes the ring, at a stop or a restart, the sink opens the ring of the new collector.
+   * Records are formatted in the logging process, by default with its PID in front.
+   */
+   class SharedMemorySink {
+    public:
+      using LogDetailsFunc = std::string (*) (const LogMessage&);
+
+      explicit SharedMemorySink(const std::string& ring_name);
+      explicit SharedMemorySink(std::unique_ptr<SharedMemoryRing> ring);
+      virtual ~SharedMemorySink() = default;
+
+      void ReceiveLogMessage(LogMessageMover message);
+      void setFormatter(LogDetailsFunc func) { _log_details_func = func; }
+
+      bool isConnected() const { return nullptr != _ring; }
+      uint64_t notConnectedDropped() const { return _not_connected_dropped; } // records before the ring existed
+      SharedMemoryRing::Counters ringCounters() const;
+
+      /// "[pid] " followed by the g3log default details
+      static std::string ProcessLogDetailsToString(const LogMessage& message);
+
+    private:
+      bool connect();
+
+      std::string _ring_name;
+      std::unique_ptr<SharedMemoryRing> _ring;
+      LogDetailsFunc _log_details_func;
+      std::chrono::steady_clock::time_point _last_connect;
+      uint64_t _not_connected_dropped;
+
+      SharedMemorySink& operator=(SharedMemorySink const&) = delete;
+      SharedMemorySink(SharedMemorySink const& other) = delete;
+   };
+} // g3
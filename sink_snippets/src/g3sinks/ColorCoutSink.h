@@ -1,15 +1,59 @@
 #pragma once
-#include <string>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
 #include <g3log/logmessage.hpp>
 
 // NOTE: This works only on Linux/OSX
 // TODO KjellKod: For Windows terminals you can tweak this easily: https://stackoverflow.com/a/4053879/1066879
+//
+// Each record is formatted once, with the color escapes of its level, and written with one call.
+// Colors are only used when stdout is a terminal. When stdout is redirected to a file, a pipe or
+// a container log driver the records are coalesced and written when max_bytes are buffered, when
+// a WARNING or more severe record arrives, or at the latest max_delay after the first buffered record.
 struct ColorCoutSink {
    // Linux xterm color
    // http://stackoverflow.com/questions/2616906/how-do-i-output-coloured-text-to-a-linux-terminal
    enum FG_Color {YELLOW = 33, RED = 31, GREEN = 32, WHITE = 37};
 
+   struct FlushPolicy {
+      size_t max_bytes = 64 * 1024;
+      std::chrono::milliseconds max_delay{100}; // 0: only max_bytes and severe records flush
+   };
+
+   ColorCoutSink()
+      : ColorCoutSink(std::cout, isatty(fileno(stdout)) != 0, isatty(fileno(stdout)) == 0) {}
+
+   /// @param use_color adds the color escapes
+   /// @param coalesce buffers records according to the flush policy, otherwise every record is flushed
+   ColorCoutSink(std::ostream& out, bool use_color, bool coalesce)
+      : _out(out)
+      , _use_color(use_color)
+      , _coalesce(coalesce) {
+      for (int color = 30; color < 38; ++color) {
+         _escapes[color - 30] = "\033[" + std::to_string(color) + "m";
+      }
+      _buffer.reserve(_policy.max_bytes);
+   }
+
+   ~ColorCoutSink() {
+      {
+         std::lock_guard<std::mutex> lock(_mutex);
+         _stopping = true;
+         _wakeup.notify_one();
+      }
+      if (_flusher.joinable()) {
+         _flusher.join();
+      }
+      flush();
+   }
+
    FG_Color GetColor(const LEVELS level) const {
       if (level.value == WARNING.value) { return YELLOW; }
       if (level.value == G3LOG_DEBUG.value) { return GREEN; }
@@ -18,23 +62,83 @@ struct ColorCoutSink {
       return WHITE;
    }
 
-   void reset() {
-      std::ostringstream oss;
-      oss << "\033[" << WHITE << "m" << " " << "\033[m" << std::endl;
-      std::cout << oss.str();
+   void setFlushPolicy(const FlushPolicy& policy) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _policy = policy;
+      _wakeup.notify_one();
    }
 
    void ReceiveLogMessage(g3::LogMessageMover logEntry) {
-      auto level = logEntry.get()._level;
-      auto color = GetColor(level);
+      const auto& message = logEntry.get();
+      std::string text = message.toString();
+      size_t size = text.size();
+      if (size > 0 && '\n' == text[size - 1]) {
+         --size; // the color is reset before the line break
+      }
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      bool was_empty = _buffer.empty();
+      if (_use_color) {
+         _buffer.append(_escapes[GetColor(message._level) - 30]);
+      }
+      _buffer.append(text, 0, size);
+      if (_use_color) {
+         _buffer.append("\033[m");
+      }
+      _buffer.push_back('\n');
 
-      reset();
-      std::ostringstream oss;
-      oss << "\033[" << color << "m"
-                << logEntry.get().toString() << "\033[m" << std::endl;
-      std::cout << oss.str();
-      reset();
+      bool severe = message._level.value >= WARNING.value;
+      if (!_coalesce || severe || _buffer.size() >= _policy.max_bytes) {
+         write();
+         return;
+      }
+      if (was_empty && _policy.max_delay.count() > 0) {
+         if (!_flusher.joinable()) {
+            _flusher = std::thread([this] { flushLoop(); });
+         }
+         _wakeup.notify_one();
+      }
    }
+
+   void flush() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      write();
+   }
+
+ private:
+   // with _mutex locked
+   void write() {
+      if (!_buffer.empty()) {
+         _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+         _buffer.clear();
+      }
+      _out.flush();
+   }
+
+   /// Writes the buffer at the latest max_delay after a record was buffered
+   void flushLoop() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (!_stopping) {
+         _wakeup.wait(lock, [this] { return _stopping || !_buffer.empty(); });
+         if (_stopping) {
+            break;
+         }
+         auto deadline = std::chrono::steady_clock::now() + _policy.max_delay;
+         _wakeup.wait_until(lock, deadline, [this] { return _stopping || _buffer.empty(); });
+         write();
+      }
+   }
+
+   std::ostream& _out;
+   const bool _use_color;
+   const bool _coalesce;
+   std::array<std::string, 8> _escapes; // per FG_Color, "\033[<color>m"
+   FlushPolicy _policy;
+   std::string _buffer;
+   std::mutex _mutex;
+   std::condition_variable _wakeup;
+   bool _stopping = false;
+   std::thread _flusher; // started by the first coalesced record
 };
 
 
@@ -56,4 +160,3 @@ int main() {
       LOG(INFO) << "An INFO message in white";
       ...
 */
-
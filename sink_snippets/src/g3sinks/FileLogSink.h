@@ -3,41 +3,404 @@
 // #define _GNU_SOURCE
 
 #include <g3log/logmessage.hpp>
+#include <g3sinks/LogLatencyTracker.h>
+#include <g3sinks/SinkProbes.h>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
-#include <cstring>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 /**
-* A simple file logger, with the specificity that it logs to an open 
-file descriptor passed by the user. This may solve specific corner cases 
-where only file descriptors are available. Ex: log to shared memory 
-(fd returned by memfd_create()). Or when file opening may be tricky, 
+* A simple file logger, with the specificity that it logs to an open
+file descriptor passed by the user. This may solve specific corner cases
+where only file descriptors are available. Ex: log to shared memory
+(fd returned by memfd_create()). Or when file opening may be tricky,
 for example in a [setuid process](http://www.cis.syr.edu/~wedu/Teaching/cis643/LectureNotes_New/Race_Condition.pdf).
+
+By default every record is written right away, the record and its line break with one writev().
+With setFlushPolicy() records are instead collected in a buffer that is written with one call
+when it is full, when it holds max_records, when the oldest record waited max_delay or when
+a record of flush_level or more severe arrives. On memfd and pipe fds this saves most syscalls.
+max_delay is checked when a record arrives, call flush() through the sink handle to drain an idle sink.
+Rotate(), sync() and the destructor drain the buffer first.
+
+Rotate() does not wait for the disk: the fsync and close of the retired file descriptor are done
+by a helper thread. The returned future is true when the retired file is synced, wait for it
+when durability has to be confirmed. syncAsync() does the same for the current file descriptor.
+
+Linux: when the file descriptor is a pipe, e.g. to a log shipper, and records are buffered, the buffer
+is page aligned memory that is moved into the pipe with vmsplice(SPLICE_F_GIFT) instead of copied
+with write(). The shipper can splice() it onward without a copy either. A fresh buffer is mapped
+after each flush since gifted pages must not be written again. Other file descriptors, and pipes
+where vmsplice() fails, use writev(). Turn it off with setZeroCopy(false).
+
+setLatencyTracking() measures the time from the LOG call until a record is written to the buffer, or the file
+descriptor, and until it is written to the file descriptor. latency() gives the histograms and a
+"g3sinks: latency ..." line with the percentiles is written to the file descriptor every summary interval.
 */
 class FileLogSink {
 public:
-  FileLogSink(int fileDesc, bool close_by_sink): fd(fileDesc), Close_fd(close_by_sink) {};
-  ~FileLogSink() {
-       sync();
-       if(Close_fd && (fd >= 0)) close(fd);};
-  
-  void Rotate(int newFileDesc, bool close_by_sink) {
-      int oldfd = fd;
+   struct FlushPolicy {
+      size_t max_bytes = 0; // buffer size, 0 writes every record right away
+      size_t max_records = 0; // 0: no limit on the number of buffered records
+      std::chrono::milliseconds max_delay{0}; // 0: no time limit
+      LEVELS flush_level = WARNING; // records this severe are written right away, with the buffer
+   };
+
+   FileLogSink(int fileDesc, bool close_by_sink)
+      : fd(fileDesc)
+      , Close_fd(close_by_sink)
+      , buffered_records(0) {}
+
+   ~FileLogSink() {
+      flush();
+      writeLatencySummary(true);
+      retire(fd, Close_fd);
+      stopSyncThread();
+      releasePages();
+   }
+
+   void setFlushPolicy(const FlushPolicy& policy) {
+      flush();
+      flush_policy = policy;
+      buffer.reserve(policy.max_bytes);
+      updateZeroCopy();
+   }
+
+   void setZeroCopy(bool enabled) {
+      flush();
+      zero_copy = enabled;
+      updateZeroCopy();
+   }
+
+   /// true when buffered records are moved into a pipe with vmsplice()
+   bool usesZeroCopy() const { return nullptr != pages; }
+
+   /// @param summary_interval how often the latency summary is written, 0: never
+   void setLatencyTracking(bool enabled, std::chrono::seconds summary_interval = std::chrono::seconds(60)) {
+      latency_tracker.enable(enabled, summary_interval);
+   }
+
+   LogLatency latency() const { return latency_tracker.latency(); }
+
+   /// Buffered records are written to the old file descriptor, it is then synced and closed by the helper thread
+   /// @return true when the old file is synced
+   std::future<bool> Rotate(int newFileDesc, bool close_by_sink) {
+      flush();
+      auto synced = retire(fd, Close_fd);
       fd = newFileDesc;
-      sync();
-      if(Close_fd && (oldfd >= 0)) close(oldfd);
       Close_fd = close_by_sink;
-     }
-  
-  void ReceiveLogMessage(g3::LogMessageMover logEntry) {
-     std::string data = logEntry.get().toString();
-     auto ignored = write(fd, data.c_str(), strlen(data.c_str()) );
-     ignored = write(fd, "\n", 2 );
-   }
-  
-  void sync() {fsync(fd);};
-  
+      updateZeroCopy();
+      return synced;
+   }
+
+   void ReceiveLogMessage(g3::LogMessageMover logEntry) {
+      const g3::LogMessage& message = logEntry.get();
+      G3SINKS_PROBE1(filelog_start, message._level.value);
+      std::string data = message.toString();
+      const bool needs_newline = data.empty() || '\n' != data.back();
+
+      if (0 == flush_policy.max_bytes) {
+         iovec record[2] = {{&data[0], data.size()}, {const_cast<char*>("\n"), needs_newline ? size_t{1} : size_t{0}}};
+         writeAll(record, 2);
+         latency_tracker.written(message._timestamp);
+         latency_tracker.flushed();
+         writeLatencySummary();
+         G3SINKS_PROBE2(filelog_done, data.size(), 0);
+         return;
+      }
+
+      if (0 == buffered_records) {
+         oldest_buffered = std::chrono::steady_clock::now();
+      }
+      if (bufferedBytes() + data.size() + 1 > flush_policy.max_bytes && bufferedBytes() > 0) {
+         if (usesZeroCopy()) {
+            flush(); // the pages go to the pipe whole
+         } else {
+            // buffer and record with one call, the record is not copied
+            iovec records[3] = {{&buffer[0], buffer.size()}, {&data[0], data.size()}, {const_cast<char*>("\n"), needs_newline ? size_t{1} : size_t{0}}};
+            writeAll(records, 3);
+            buffer.clear();
+            buffered_records = 0;
+            latency_tracker.written(message._timestamp);
+            latency_tracker.flushed();
+            writeLatencySummary();
+            G3SINKS_PROBE2(filelog_done, data.size(), 0);
+            return;
+         }
+      }
+
+      if (usesZeroCopy()) {
+         if (pages_used + data.size() + 1 > pages_capacity) {
+            if (bufferedBytes() > 0) {
+               flush(); // the older records first
+            }
+            iovec record[2] = {{&data[0], data.size()}, {const_cast<char*>("\n"), needs_newline ? size_t{1} : size_t{0}}};
+            writeAll(record, 2); // larger than the pages, nothing older is buffered
+            latency_tracker.written(message._timestamp);
+            latency_tracker.flushed();
+            writeLatencySummary();
+            G3SINKS_PROBE2(filelog_done, data.size(), 0);
+            return;
+         }
+         std::memcpy(pages + pages_used, data.data(), data.size());
+         pages_used += data.size();
+         if (needs_newline) {
+            pages[pages_used++] = '\n';
+         }
+      } else {
+         buffer.append(data);
+         if (needs_newline) {
+            buffer.push_back('\n');
+         }
+      }
+      ++buffered_records;
+      latency_tracker.written(message._timestamp);
+      if (isFlushDue(message)) {
+         flush();
+      }
+      writeLatencySummary();
+      G3SINKS_PROBE2(filelog_done, data.size(), buffered_records > 0 ? 1 : 0);
+   }
+
+   /// Writes the buffered records
+   void flush() {
+      if (usesZeroCopy() && pages_used > 0) {
+         splicePages();
+      }
+      if (!buffer.empty()) {
+         iovec records[1] = {{&buffer[0], buffer.size()}};
+         writeAll(records, 1);
+      }
+      buffer.clear();
+      buffered_records = 0;
+      latency_tracker.flushed();
+   }
+
+   void sync() {
+      flush();
+      fsync(fd);
+   }
+
+   /// Like sync() but the fsync is done by the helper thread. @return true when the file is synced
+   std::future<bool> syncAsync() {
+      flush();
+      return queueSync(fd >= 0 ? fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1);
+   }
+
 private:
-    int fd;
-    bool Close_fd;
+   /// The summary is written after the buffered records, it is not buffered itself
+   void writeLatencySummary(bool force = false) {
+      std::string summary = latency_tracker.summary(force);
+      if (summary.empty()) {
+         return;
+      }
+      flush();
+      summary.push_back('\n');
+      iovec line[1] = {{&summary[0], summary.size()}};
+      writeAll(line, 1);
+   }
+
+   bool isFlushDue(const g3::LogMessage& message) const {
+      if (bufferedBytes() >= flush_policy.max_bytes || message._level.value >= flush_policy.flush_level.value) {
+         return true;
+      }
+      if (flush_policy.max_records > 0 && buffered_records >= flush_policy.max_records) {
+         return true;
+      }
+      return flush_policy.max_delay.count() > 0 && (std::chrono::steady_clock::now() - oldest_buffered) >= flush_policy.max_delay;
+   }
+
+   size_t bufferedBytes() const {
+      return usesZeroCopy() ? pages_used : buffer.size();
+   }
+
+   /// Zero copy is used for buffered records to a pipe
+   void updateZeroCopy() {
+#if defined(__linux__)
+      struct stat status;
+      bool is_pipe = (fd >= 0) && (0 == fstat(fd, &status)) && S_ISFIFO(status.st_mode);
+      size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      size_t capacity = (flush_policy.max_bytes + page - 1) / page * page;
+      bool wanted = zero_copy && is_pipe && capacity > 0;
+      if (wanted == usesZeroCopy() && (!wanted || capacity == pages_capacity)) {
+         return;
+      }
+      releasePages();
+      if (wanted) {
+         pages_capacity = capacity;
+         mapPages();
+      }
+#endif
+   }
+
+   void mapPages() {
+#if defined(__linux__)
+      void* mapped = mmap(nullptr, pages_capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      pages = (MAP_FAILED == mapped) ? nullptr : static_cast<char*>(mapped);
+      pages_used = 0;
+#endif
+   }
+
+   void releasePages() {
+#if defined(__linux__)
+      if (pages) {
+         munmap(pages, pages_capacity);
+      }
+#endif
+      pages = nullptr;
+      pages_used = 0;
+   }
+
+   /// Gives the filled pages to the pipe. A pipe that does not take them, e.g. EINVAL when
+   /// the descriptor was changed behind the sink, gets the rest with writev() and zero copy is turned off
+   void splicePages() {
+#if defined(__linux__)
+      iovec part = {pages, pages_used};
+      while (part.iov_len > 0) {
+         auto moved = vmsplice(fd, &part, 1, SPLICE_F_GIFT);
+         if (moved < 0) {
+            if (EINTR == errno) {
+               continue;
+            }
+            if (EAGAIN == errno) {
+               pollfd writable = {fd, POLLOUT, 0};
+               poll(&writable, 1, -1);
+               continue;
+            }
+            writeAll(&part, 1);
+            releasePages();
+            zero_copy = false;
+            return;
+         }
+         part.iov_base = static_cast<char*>(part.iov_base) + moved;
+         part.iov_len -= static_cast<size_t>(moved);
+      }
+      // the pipe owns the gifted pages now, they must not be written again
+      munmap(pages, pages_capacity);
+      mapPages();
+#endif
+   }
+
+   /// The helper thread gets its own duplicate of the descriptor, so the caller can close it
+   /// right away, or the original owner can close it whenever it wants.
+   std::future<bool> retire(int retired, bool close_retired) {
+      int duplicate = (retired >= 0) ? fcntl(retired, F_DUPFD_CLOEXEC, 0) : -1;
+      if (close_retired && retired >= 0) {
+         close(retired); // cheap, the duplicate keeps the file open until it is synced
+      }
+      return queueSync(duplicate);
+   }
+
+   std::future<bool> queueSync(int duplicate) {
+      std::promise<bool> synced;
+      auto future = synced.get_future();
+      if (duplicate < 0) {
+         synced.set_value(false);
+         return future;
+      }
+      std::lock_guard<std::mutex> lock(sync_mutex);
+      sync_jobs.push_back(SyncJob{duplicate, std::move(synced)});
+      if (!sync_thread.joinable()) {
+         sync_thread = std::thread([this] { syncLoop(); });
+      }
+      sync_wakeup.notify_one();
+      return future;
+   }
+
+   void syncLoop() {
+      std::unique_lock<std::mutex> lock(sync_mutex);
+      for (;;) {
+         sync_wakeup.wait(lock, [this] { return stop_sync_thread || !sync_jobs.empty(); });
+         if (sync_jobs.empty()) {
+            return; // stopped and all jobs are done
+         }
+         SyncJob job = std::move(sync_jobs.front());
+         sync_jobs.pop_front();
+         lock.unlock();
+         bool synced = (0 == fsync(job.fd));
+         close(job.fd);
+         job.synced.set_value(synced);
+         lock.lock();
+      }
+   }
+
+   void stopSyncThread() {
+      {
+         std::lock_guard<std::mutex> lock(sync_mutex);
+         stop_sync_thread = true;
+         sync_wakeup.notify_one();
+      }
+      if (sync_thread.joinable()) {
+         sync_thread.join();
+      }
+   }
+
+   /// writev() until all is written, partial writes happen on pipes and sockets
+   void writeAll(iovec* parts, int count) {
+      while (count > 0 && fd >= 0) {
+         if (0 == parts->iov_len) {
+            ++parts;
+            --count;
+            continue;
+         }
+         auto written = writev(fd, parts, count);
+         if (written < 0) {
+            if (EINTR == errno) {
+               continue;
+            }
+            if (EAGAIN == errno || EWOULDBLOCK == errno) {
+               pollfd writable = {fd, POLLOUT, 0};
+               poll(&writable, 1, -1);
+               continue;
+            }
+            return; // nowhere to report it, the records are lost as before
+         }
+         size_t left = static_cast<size_t>(written);
+         while (count > 0 && left >= parts->iov_len) {
+            left -= parts->iov_len;
+            ++parts;
+            --count;
+         }
+         if (count > 0) {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+            parts->iov_len -= left;
+         }
+      }
+   }
+
+   int fd;
+   bool Close_fd;
+   FlushPolicy flush_policy;
+   std::string buffer; // records that are not yet written
+   bool zero_copy = true;
+   char* pages = nullptr; // page aligned buffer, instead of buffer, for vmsplice() to a pipe
+   size_t pages_capacity = 0;
+   size_t pages_used = 0;
+   size_t buffered_records;
+   std::chrono::steady_clock::time_point oldest_buffered;
+   LogLatencyTracker latency_tracker;
+
+   struct SyncJob {
+      int fd; // a duplicate, closed when synced
+      std::promise<bool> synced;
+   };
+   std::mutex sync_mutex;
+   std::condition_variable sync_wakeup;
+   std::deque<SyncJob> sync_jobs;
+   bool stop_sync_thread = false;
+   std::thread sync_thread; // started by the first Rotate() or syncAsync()
 };
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <g3log/logmessage.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Linux counterpart to g3logTracelogging: writes each record to the ftrace trace_marker so that
+// log events show up on the same timeline as perf/ftrace scheduler and I/O events.
+//
+// The trace_marker file is opened once and kept open, each record is one write() of a compact line
+//    g3log WARNING main.cpp:42 the message
+// Line breaks in the message are replaced by spaces, the trace buffer takes one line per write.
+// Records longer than max_record_size are truncated, the kernel caps trace_marker writes anyway.
+// Writing to trace_marker normally requires root or access to tracefs.
+//
+// The path can be given, e.g. a regular file in tests. Without a path the tracefs mount point is
+// tried first, then the older debugfs location.
+
+/* *** BEGIN EXAMPLE CLIENT USAGE ***
+using namespace g3;
+std::unique_ptr<LogWorker> logworker{ LogWorker::createLogWorker() };
+auto sinkHandle = logworker->addSink(std::make_unique<TraceMarkerSink>(),
+  &TraceMarkerSink::ReceiveLogMessage);
+initializeLogging(logworker.get());
+LOG(INFO) << "visible in: perf trace, trace-cmd, /sys/kernel/tracing/trace";
+ *** END EXAMPLE CLIENT USAGE *** */
+
+class TraceMarkerSink {
+public:
+   explicit TraceMarkerSink(const std::string& path = "", const std::string& tag = "g3log", size_t max_record_size = 1024)
+      : fd_(-1)
+      , tag_(tag)
+      , max_record_size_(max_record_size) {
+      if (path.empty()) {
+         open("/sys/kernel/tracing/trace_marker") || open("/sys/kernel/debug/tracing/trace_marker");
+      } else {
+         open(path);
+      }
+      record_.reserve(max_record_size_);
+   }
+
+   ~TraceMarkerSink() {
+      if (fd_ >= 0) {
+         close(fd_);
+      }
+   }
+
+   TraceMarkerSink(const TraceMarkerSink&) = delete;
+   TraceMarkerSink& operator=(const TraceMarkerSink&) = delete;
+
+   void ReceiveLogMessage(g3::LogMessageMover logEntry) {
+      if (fd_ < 0) {
+         return;
+      }
+      const g3::LogMessage& message = logEntry.get();
+      record_.clear();
+      record_.append(tag_);
+      record_.push_back(' ');
+      record_.append(message._level.text);
+      record_.push_back(' ');
+      record_.append(message._file);
+      record_.push_back(':');
+      record_.append(std::to_string(message._line));
+      record_.push_back(' ');
+
+      size_t room = (max_record_size_ > record_.size() + 1) ? max_record_size_ - record_.size() - 1 : 0;
+      const std::string& text = message._message;
+      size_t size = text.size();
+      while (size > 0 && '\n' == text[size - 1]) {
+         --size;
+      }
+      size_t begin = record_.size();
+      record_.append(text, 0, std::min(size, room));
+      for (size_t i = begin; i < record_.size(); ++i) {
+         if ('\n' == record_[i] || '\r' == record_[i]) {
+            record_[i] = ' ';
+         }
+      }
+      record_.push_back('\n');
+
+      ssize_t written = 0;
+      do {
+         written = write(fd_, record_.data(), record_.size());
+      } while (written < 0 && EINTR == errno);
+   }
+
+   bool isOpen() const { return fd_ >= 0; }
+   const std::string& path() const { return path_; }
+
+private:
+   bool open(const std::string& path) {
+      fd_ = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+      if (fd_ >= 0) {
+         path_ = path;
+      }
+      return fd_ >= 0;
+   }
+
+   int fd_;
+   std::string path_;
+   std::string tag_;
+   size_t max_record_size_;
+   std::string record_; // reused between records
+};
@@ -19,15 +19,34 @@
  * - The "facility" of the messages is set to LOG_USER by default, but use setFacility() to change.
  * - To get something written to the console, use echoToStderr()
  * - On the first log (only) of your program, a special header can be written.
+ * - Per level sampling and rate limits can be set with setLevelSampling() and setLevelRateLimit().
+ *   They are checked before the message is formatted. Dropped messages are periodically
+ *   reported to syslog at LOG_NOTICE.
+ * - useDirectTransport() replaces ::syslog() with a SyslogTransport that builds RFC 5424 or RFC 3164
+ *   frames itself and writes them straight to the syslog socket, batched when the sink is behind.
+ *   See syslogtransport.hpp
+ * - setNonBlocking() makes the direct transport send without blocking. A stalled syslog daemon can then
+ *   not freeze the g3log worker. Dropped and retried messages are counted, see transportCounters(),
+ *   and periodically reported to syslog at LOG_NOTICE.
+ * - setStructuredData() sends the file, line, function and thread of each message as RFC 5424
+ *   STRUCTURED-DATA. With SyslogTransport::Framing::OctetCounted the direct transport writes
+ *   RFC 6587 octet counted frames to a stream socket, e.g. of a local collector.
+ * - setLatencyTracking() measures the time from the LOG call until a message is handed to syslog, and
+ *   until it is sent. latency() gives the histograms and a percentile summary is periodically sent at LOG_INFO.
  *
  * A word of caution: syslog will timestamp each record itself, but with the time that the syslog
  * daemon recieved the message, not the time it was created.  You can include the creation time
- * in your record via the formatter.
+ * in your record via the formatter. With the direct transport the creation time is used.
  *
  */
 #pragma once
 #include <map>
 #include <string>
+#include <chrono>
+#include <memory>
+#include "g3sinks/LogLatencyTracker.h"
+#include "g3sinks/LogLevelLimiter.h"
+#include "g3sinks/syslogtransport.hpp"
 
 namespace g3 {
 
@@ -49,12 +68,36 @@ namespace g3 {
       void muteStderr(); // opposite of echoToStderr
 
       void setIdentity(const char* id);
-      void setFacility(int facility) { _facility = facility; }
+      void setFacility(int facility);
       void setOption(int option) { _option = option; }
       void setLevelMap(std::map<int, int> const& m);
 
       void setLevel(LogLevel level, int syslevel);
 
+      void setLevelSampling(LogLevel level, uint32_t one_in); // keep 1 in one_in messages
+      void setLevelRateLimit(LogLevel level, double per_second, double burst = 0); // 0: no limit
+      void setDroppedReportInterval(std::chrono::milliseconds interval);
+
+      // Sends with a SyslogTransport instead of ::syslog(). An empty socket_path is the default /dev/log
+      void useDirectTransport(SyslogTransport::Format format, std::string socket_path,
+                              SyslogTransport::Framing framing = SyslogTransport::Framing::Datagram);
+      // Sends the g3log details as structured data. Enabling it uses the direct transport, RFC 5424 if not
+      // already in use, disabling it does not start the transport
+      void setStructuredData(bool enabled);
+      // Direct transport only: up to max_batch messages per send while the sink is behind. A batch is sent
+      // with the next message after max_delay, call flush() to send it when no message follows
+      void setBatching(size_t max_batch, std::chrono::microseconds caught_up_backlog,
+                       std::chrono::milliseconds max_delay = std::chrono::milliseconds(100));
+      void flush(); // Direct transport only: sends messages waiting for a batch
+      // Uses the direct transport, RFC 3164 if not already in use, with MSG_DONTWAIT and a bounded retry queue
+      void setNonBlocking(size_t max_retry_messages);
+      SyslogTransport::Counters transportCounters() const;
+
+      // Time from the LOG call until a message is written, and until it is sent. Direct transport: a batched
+      // or queued message is written but not yet sent. Summary every summary_interval, 0: never
+      void setLatencyTracking(bool enabled, std::chrono::seconds summary_interval = std::chrono::seconds(60));
+      LogLatency latency() const { return _latency.latency(); }
+
     private:
       LogDetailsFunc _log_details_func;
       std::map<int, int> _levelMap;
@@ -65,12 +108,24 @@ namespace g3 {
 
       std::string _header; // Written when logging starts
       bool _firstEntry; // notices that logging starts ...
+      LogLevelLimiter _limiter; // per level sampling and rate limits
+      std::unique_ptr<SyslogTransport> _transport; // nullptr: ::syslog() is used
+      bool _structured_data;
+      SyslogTransport::Counters _reported_counters; // at the latest transport report
+      std::chrono::steady_clock::time_point _last_transport_report;
+      std::chrono::milliseconds _report_interval;
+      LogLatencyTracker _latency;
 
       void openLog();
 
       SyslogSink& operator=(SyslogSink const&) = delete;
       SyslogSink(SyslogSink const& other) = delete;
       int priority(LogLevel level);
+      void reportDropped(bool force = false);
+      void reportTransport(bool force = false);
+      void reportLatency(bool force = false);
+      void updateSent();
+      void write(int level, const std::string& text);
    };
 
 }
@@ -0,0 +1,128 @@
+/* 2026, g3sinks
+ *
+ * A direct syslog transport, an alternative to glibc ::syslog() for the SyslogSink.
+ *
+ * ::syslog() formats each message itself, takes a global lock and on some libc implementations
+ * reconnects to the daemon. The SyslogTransport instead:
+ * - builds RFC 5424 (default) or RFC 3164 frames into a buffer that is reused between messages
+ * - caches the hostname, the PID and the timestamp text of the current second
+ * - uses the creation time of the LogMessage as the syslog timestamp, not the time it was sent
+ * - sends over a connected unix datagram socket, by default /dev/log
+ * - batches several frames in one sendmmsg() call when the sink is behind, i.e. when the latest
+ *   message has waited longer than the "caught up" backlog. When the sink is caught up, when the
+ *   message is LOG_WARNING or more severe, or when the oldest pending frame has waited max_delay,
+ *   all pending frames are sent at once. The delay is checked when a message is sent: when a burst
+ *   ends while the sink is behind, flush() sends the last batch
+ *
+ * Like ::syslog() nothing is reported to the application if the daemon is missing, the frame
+ * is then dropped and counted, see counters().
+ *
+ * Non-blocking mode: frames are sent with MSG_DONTWAIT so a stalled daemon never blocks the
+ * caller. Frames that would block are kept in a small bounded retry queue and are sent before
+ * any new frame. When the retry queue is full the oldest frames are dropped.
+ *
+ * Structured data: with setStructuredData() the RFC 5424 STRUCTURED-DATA field carries the g3log
+ * details of the message, e.g.
+ *    <14>1 2026-10-18T08:33:46.123456Z host app 42 - [g3log@32473 file="main.cpp" line="12" function="main" thread="140213"] text
+ * so that a collector can pick them up without parsing the text.
+ *
+ * Stream framing: with Framing::OctetCounted frames are written back to back over a stream socket
+ * as "MSG-LEN SP SYSLOG-MSG" (RFC 6587). A pending batch is then written with one send() call.
+ * The socket is a unix socket when the address is a path, e.g. "/run/collector.sock", otherwise
+ * a TCP (or with Framing::Datagram, UDP) socket when the address is "host:port", e.g. "127.0.0.1:601".
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace g3 {
+
+   struct LogMessage;
+
+   class SyslogTransport {
+    public:
+      enum class Format { RFC3164, RFC5424 };
+      enum class Framing { Datagram, OctetCounted };
+
+      struct Counters {
+         uint64_t sent = 0;
+         uint64_t retried = 0; // frames that would have blocked and were deferred to the retry queue, each counted once
+         uint64_t dropped = 0; // frames that could not be sent, or that did not fit in the retry queue
+      };
+
+      explicit SyslogTransport(const std::string& socket_path = "/dev/log", Format format = Format::RFC5424,
+                               Framing framing = Framing::Datagram);
+      virtual ~SyslogTransport();
+
+      void setIdentity(const std::string& identity);
+      void setFacility(int facility) { _facility = facility; }
+      void setBatching(size_t max_batch, std::chrono::microseconds caught_up_backlog,
+                       std::chrono::milliseconds max_delay = std::chrono::milliseconds(100));
+      void setNonBlocking(bool non_blocking, size_t max_retry_frames = 64);
+      // RFC 5424 only. 32473 is the private enterprise number reserved for documentation, RFC 5612
+      void setStructuredData(bool enabled, const std::string& sd_id = "g3log@32473");
+
+      // frames and sends, or queues, a message. @param severity is the syslog LOG_* level
+      void send(int severity, const LogMessage& message, const std::string& text);
+      // for text created by the sink itself, timestamped now and sent right away
+      void send(int severity, const std::string& text);
+      void flush();
+
+      Counters counters() const { return _counters; }
+      size_t pendingFrames() const { return _frame_ends.size(); }
+      bool isConnected() const { return _socket >= 0; }
+      const std::string& socketPath() const { return _socket_path; }
+
+    private:
+      bool connect();
+      void disconnect();
+      void frame(int severity, std::chrono::system_clock::time_point timestamp, const LogMessage* message, const std::string& text);
+      void appendTimestamp(std::chrono::system_clock::time_point timestamp);
+      void appendStructuredData(const LogMessage* message);
+      void appendParameter(const char* name, const std::string& value);
+      void updateHeaderTail();
+      void sendPending();
+      size_t sendDatagrams(int flags);
+      size_t sendStream(int flags);
+      void eraseFrames(size_t count, size_t first = 0);
+
+      std::string _socket_path;
+      Format _format;
+      Framing _framing;
+      int _socket;
+      int _facility;
+      std::string _identity;
+      std::string _hostname;
+      long _pid;
+
+      std::time_t _cached_second; // the second that _cached_time is formatted for
+      std::string _cached_time;
+      std::string _header_tail; // text between the timestamp and the structured data
+      bool _structured_data;
+      std::string _sd_id;
+
+      size_t _max_batch;
+      std::chrono::microseconds _caught_up_backlog;
+      std::chrono::milliseconds _max_delay;
+      std::chrono::steady_clock::time_point _pending_since; // of the oldest pending frame
+      bool _non_blocking;
+      size_t _max_retry_frames;
+      size_t _retry_counted; // the oldest pending frames, that are already counted as retried
+      Counters _counters;
+      std::string _buffer; // all pending frames back to back
+      std::vector<size_t> _frame_ends; // end offset of each pending frame in _buffer
+      size_t _stream_sent; // bytes of the first pending frame that are already written to the stream
+      std::vector<iovec> _frames;
+#if defined(__linux__)
+      std::vector<mmsghdr> _messages;
+#endif
+
+      SyslogTransport& operator=(SyslogTransport const&) = delete;
+      SyslogTransport(SyslogTransport const& other) = delete;
+   };
+}
@@ -1,6 +1,8 @@
 #include "g3log/logmessage.hpp"
 #include "g3sinks/syslogsink.hpp"
+#include "g3sinks/SinkProbes.h"
 #include <syslog.h>
+#include <iostream>
 
 namespace g3 {
 
@@ -12,6 +14,156 @@ namespace g3 {
       _levelMap[level.value] = syslevel;
    }
 
+   // On average 1 in one_in messages of the level are kept, 0 or 1 keeps all
+   void SyslogSink::setLevelSampling(LogLevel level, uint32_t one_in) {
+      _limiter.setSampling(level, one_in);
+   }
+
+   // Token bucket, at most per_second messages of the level with bursts of up to burst messages
+   void SyslogSink::setLevelRateLimit(LogLevel level, double per_second, double burst) {
+      _limiter.setRateLimit(level, per_second, burst);
+   }
+
+   // how often, at most, dropped messages are reported. For both the level limits and the direct transport
+   void SyslogSink::setDroppedReportInterval(std::chrono::milliseconds interval) {
+      _limiter.setReportInterval(interval);
+      _report_interval = interval;
+   }
+
+   void SyslogSink::reportDropped(bool force) {
+      auto report = _limiter.droppedReport(force);
+      if (!report.empty()) {
+         write(LOG_NOTICE, report);
+      }
+   }
+
+   /**
+    * Replaces ::syslog() with a direct transport that frames the messages itself.
+    * @param format RFC 5424 (with the hostname and a microsecond UTC timestamp) or RFC 3164
+    * @param socket_path the syslog daemon socket path or "host:port", empty for the default /dev/log
+    * @param framing one datagram per message, or RFC 6587 octet counted frames over a stream socket
+    */
+   void SyslogSink::useDirectTransport(SyslogTransport::Format format, std::string socket_path, SyslogTransport::Framing framing) {
+      if (socket_path.empty()) {
+         socket_path = "/dev/log";
+      }
+      _transport = std::make_unique<SyslogTransport>(socket_path, format, framing);
+      _transport->setIdentity(*_identity);
+      _transport->setFacility(_facility);
+      _transport->setStructuredData(_structured_data);
+   }
+
+   /**
+    * Sends the file, line, function and thread of each message as RFC 5424 STRUCTURED-DATA,
+    * so that collectors do not have to parse them from the text. Consider a formatter without
+    * these details. Enabling it starts the direct transport with RFC 5424 if it is not already in use,
+    * disabling it leaves a sink on ::syslog() as it is.
+    */
+   void SyslogSink::setStructuredData(bool enabled) {
+      _structured_data = enabled;
+      if (!_transport) {
+         if (!enabled) {
+            return;
+         }
+         useDirectTransport(SyslogTransport::Format::RFC5424, "");
+      }
+      _transport->setStructuredData(enabled);
+   }
+
+   void SyslogSink::setBatching(size_t max_batch, std::chrono::microseconds caught_up_backlog, std::chrono::milliseconds max_delay) {
+      if (_transport) {
+         _transport->setBatching(max_batch, caught_up_backlog, max_delay);
+      }
+   }
+
+   void SyslogSink::flush() {
+      if (_transport) {
+         _transport->flush();
+         updateSent();
+      }
+   }
+
+   void SyslogSink::setLatencyTracking(bool enabled, std::chrono::seconds summary_interval) {
+      _latency.enable(enabled, summary_interval);
+   }
+
+   // ::syslog() sends at once, the direct transport when no frames are pending
+   void SyslogSink::updateSent() {
+      if (!_transport || 0 == _transport->pendingFrames()) {
+         _latency.flushed();
+      }
+   }
+
+   void SyslogSink::reportLatency(bool force) {
+      auto summary = _latency.summary(force);
+      if (!summary.empty()) {
+         write(LOG_INFO, summary);
+      }
+   }
+
+   /**
+    * Never block on a slow or stalled syslog daemon. Messages that cannot be sent right away are kept
+    * in a retry queue of @param max_retry_messages, when it is full the oldest messages are dropped.
+    * This is only possible with the direct transport. If not yet in use it is started with RFC 3164,
+    * the format glibc ::syslog() uses, so the daemon sees the same messages as before.
+    */
+   void SyslogSink::setNonBlocking(size_t max_retry_messages) {
+      if (!_transport) {
+         useDirectTransport(SyslogTransport::Format::RFC3164, "");
+      }
+      _transport->setNonBlocking(true, max_retry_messages);
+   }
+
+   /// @return sent, retried and dropped message counters of the direct transport
+   SyslogTransport::Counters SyslogSink::transportCounters() const {
+      if (_transport) {
+         return _transport->counters();
+      }
+      return {};
+   }
+
+   /// reports to syslog, at most every report interval, if messages were dropped or retried
+   void SyslogSink::reportTransport(bool force) {
+      if (!_transport) {
+         return;
+      }
+      auto counters = _transport->counters();
+      auto dropped = counters.dropped - _reported_counters.dropped;
+      auto retried = counters.retried - _reported_counters.retried;
+      if (0 == dropped && 0 == retried) {
+         return;
+      }
+      auto now = std::chrono::steady_clock::now();
+      if (!force && (now - _last_transport_report) < _report_interval) {
+         return;
+      }
+
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_transport_report);
+      write(LOG_NOTICE, "g3sinks: syslog transport dropped " + std::to_string(dropped) + ", retried "
+            + std::to_string(retried) + " messages in the last " + std::to_string(elapsed.count()) + " ms");
+      _reported_counters = counters;
+      _last_transport_report = now;
+   }
+
+   void SyslogSink::setFacility(int facility) {
+      _facility = facility;
+      if (_transport) {
+         _transport->setFacility(facility);
+      }
+   }
+
+   // text that is created by the sink itself
+   void SyslogSink::write(int level, const std::string& text) {
+      if (_transport) {
+         _transport->send(level, text);
+         if (_option & LOG_PERROR) {
+            std::cerr << text << std::endl;
+         }
+         return;
+      }
+      ::syslog(level, "%s", text.c_str());
+   }
+
    void SyslogSink::echoToStderr() {
       _option |= LOG_PERROR;
       ::openlog(_identity.get() -> c_str(), _option, _facility);
@@ -31,19 +183,45 @@ namespace g3 {
       auto new_identity = std::make_unique<std::string>(id);
       ::openlog(new_identity.get() -> c_str(), _option, _facility);
       std::swap(_identity, new_identity);
+      if (_transport) {
+         _transport->setIdentity(*_identity);
+      }
    }
 
    // The actual log receiving function
    void SyslogSink::syslog(LogMessageMover message) {
+      G3SINKS_PROBE1(syslog_start, message.get()._level.value);
+      size_t sent_bytes = 0;
       if (_firstEntry) {
-         openlog(_identity.get() -> c_str(), _option, _facility);
+         if (!_transport) {
+            openlog(_identity.get() -> c_str(), _option, _facility);
+         }
          if (!_header.empty()) {
-            ::syslog(LOG_NOTICE, "%s", _header.c_str());
+            write(LOG_NOTICE, _header);
          }
          _firstEntry = false;
       }
-      int level = priority(message.get()._level);
-      ::syslog(level, "%s", message.get().toString(_log_details_func).c_str());
+      if (_limiter.allow(message.get()._level)) {
+         int level = priority(message.get()._level);
+         auto text = message.get().toString(_log_details_func);
+         if (_transport) {
+            _transport->send(level, message.get(), text);
+            if (_option & LOG_PERROR) {
+               std::cerr << text;
+            }
+         } else {
+            ::syslog(level, "%s", text.c_str());
+         }
+         sent_bytes = text.size();
+         if (_latency.enabled()) {
+            _latency.written(message.get()._timestamp);
+            updateSent();
+         }
+      }
+      reportDropped();
+      reportTransport();
+      reportLatency();
+      G3SINKS_PROBE1(syslog_done, sent_bytes);
    }
 
    int SyslogSink::priority(LogLevel level) {
@@ -59,7 +237,10 @@ namespace g3 {
       , _facility(LOG_USER)
       , _option(LOG_PID)
       , _header("")
-      , _firstEntry(true) {
+      , _firstEntry(true)
+      , _structured_data(false)
+      , _last_transport_report(std::chrono::steady_clock::now())
+      , _report_interval(std::chrono::seconds(10)) {
       _levelMap[G3LOG_DEBUG.value] = LOG_DEBUG;
       _levelMap[INFO.value] = LOG_INFO;
       _levelMap[(INFO.value + WARNING.value) / 2] = LOG_NOTICE;
@@ -70,6 +251,12 @@ namespace g3 {
    }
 
    SyslogSink::~SyslogSink() {
+      if (!_firstEntry) {
+         reportDropped(true);
+         reportTransport(true);
+         reportLatency(true);
+      }
+      _transport.reset();
       ::closelog();
    }
 
@@ -0,0 +1,446 @@
+#include "g3log/logmessage.hpp"
+#include "g3sinks/syslogtransport.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+namespace g3 {
+
+   namespace {
+      // The LogMessage timestamp is not necessarily from the system clock
+      template <typename TimePoint>
+      std::chrono::system_clock::time_point toSystemTime(const TimePoint& timestamp) {
+         using Clock = typename TimePoint::clock;
+         if constexpr (std::is_same_v<Clock, std::chrono::system_clock>) {
+            return std::chrono::time_point_cast<std::chrono::system_clock::duration>(timestamp);
+         } else {
+            auto since = timestamp - Clock::now();
+            return std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(since);
+         }
+      }
+
+      template <typename TimePoint>
+      std::chrono::microseconds backlogOf(const TimePoint& timestamp) {
+         return std::chrono::duration_cast<std::chrono::microseconds>(TimePoint::clock::now() - timestamp);
+      }
+
+      std::string localHostname() {
+         char name[256] = {0};
+         if (0 != ::gethostname(name, sizeof(name) - 1) || 0 == name[0]) {
+            return "-";
+         }
+         return name;
+      }
+   } // anonymous
+
+   SyslogTransport::SyslogTransport(const std::string& socket_path, Format format, Framing framing)
+      : _socket_path(socket_path)
+      , _format(format)
+      , _framing(framing)
+      , _socket(-1)
+      , _facility(LOG_USER)
+      , _identity("g3log")
+      , _hostname(localHostname())
+      , _pid(static_cast<long>(::getpid()))
+      , _cached_second(-1)
+      , _structured_data(false)
+      , _sd_id("g3log@32473")
+      , _max_batch(1)
+      , _caught_up_backlog(std::chrono::milliseconds(1))
+      , _max_delay(std::chrono::milliseconds(100))
+      , _non_blocking(false)
+      , _max_retry_frames(64)
+      , _retry_counted(0)
+      , _stream_sent(0) {
+      _buffer.reserve(8 * 1024);
+      updateHeaderTail();
+      connect();
+   }
+
+   SyslogTransport::~SyslogTransport() {
+      flush();
+      _counters.dropped += _frame_ends.size(); // still waiting for the daemon
+      disconnect();
+   }
+
+   void SyslogTransport::setIdentity(const std::string& identity) {
+      flush();
+      _identity = identity.empty() ? "-" : identity;
+      updateHeaderTail();
+   }
+
+   /// @param max_batch max number of frames in one sendmmsg call, 1 disables batching
+   /// @param caught_up_backlog a message that waited less than this, from its creation, means that
+   /// the sink is caught up and that pending frames should be sent
+   /// @param max_delay pending frames are sent with the next message after the oldest has waited this long
+   void SyslogTransport::setBatching(size_t max_batch, std::chrono::microseconds caught_up_backlog, std::chrono::milliseconds max_delay) {
+      flush();
+      _max_batch = (max_batch > 0) ? max_batch : 1;
+      _caught_up_backlog = caught_up_backlog;
+      _max_delay = max_delay;
+   }
+
+   /// @param non_blocking sends with MSG_DONTWAIT, frames that would block are kept for a later retry
+   /// @param max_retry_frames the max number of frames kept for retry, older frames are dropped
+   void SyslogTransport::setNonBlocking(bool non_blocking, size_t max_retry_frames) {
+      _non_blocking = non_blocking;
+      _max_retry_frames = max_retry_frames;
+   }
+
+   /// @param enabled the g3log details of each message are sent as an RFC 5424 SD-ELEMENT
+   /// @param sd_id the SD-ID of the element, name@<private enterprise number>
+   void SyslogTransport::setStructuredData(bool enabled, const std::string& sd_id) {
+      flush();
+      _structured_data = enabled;
+      _sd_id = sd_id;
+   }
+
+   void SyslogTransport::send(int severity, const LogMessage& message, const std::string& text) {
+      frame(severity, toSystemTime(message._timestamp), &message, text);
+      bool isBehind = backlogOf(message._timestamp) > _caught_up_backlog;
+      bool isOverdue = std::chrono::steady_clock::now() - _pending_since >= _max_delay;
+      if (_frame_ends.size() >= _max_batch || severity <= LOG_WARNING || !isBehind || isOverdue) {
+         sendPending();
+      }
+   }
+
+   void SyslogTransport::send(int severity, const std::string& text) {
+      frame(severity, std::chrono::system_clock::now(), nullptr, text);
+      sendPending();
+   }
+
+   void SyslogTransport::flush() {
+      sendPending();
+   }
+
+   /// Connects to a unix socket when the address is a path, otherwise to "host:port"
+   bool SyslogTransport::connect() {
+      disconnect();
+      const int type = (Framing::OctetCounted == _framing) ? SOCK_STREAM : SOCK_DGRAM;
+      auto colon = _socket_path.rfind(':');
+      if (std::string::npos == _socket_path.find('/') && std::string::npos != colon) {
+         std::string host = _socket_path.substr(0, colon);
+         std::string port = _socket_path.substr(colon + 1);
+         if (host.size() > 1 && '[' == host.front() && ']' == host.back()) {
+            host = host.substr(1, host.size() - 2); // [::1]:601
+         }
+         addrinfo hints;
+         std::memset(&hints, 0, sizeof(hints));
+         hints.ai_family = AF_UNSPEC;
+         hints.ai_socktype = type;
+         addrinfo* addresses = nullptr;
+         if (0 != ::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses)) {
+            return false;
+         }
+         for (addrinfo* address = addresses; address && _socket < 0; address = address->ai_next) {
+            _socket = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if (_socket >= 0 && 0 != ::connect(_socket, address->ai_addr, address->ai_addrlen)) {
+               disconnect();
+            }
+         }
+         ::freeaddrinfo(addresses);
+         if (_socket >= 0 && SOCK_STREAM == type) {
+            int on = 1; // frames are batched here already
+            ::setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+         }
+         return _socket >= 0;
+      }
+
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      if (_socket_path.size() >= sizeof(address.sun_path)) {
+         return false;
+      }
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, _socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+      _socket = ::socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+      if (_socket < 0) {
+         return false;
+      }
+      if (0 != ::connect(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+         disconnect();
+         return false;
+      }
+      return true;
+   }
+
+   void SyslogTransport::disconnect() {
+      if (_socket >= 0) {
+         ::close(_socket);
+         _socket = -1;
+      }
+   }
+
+   /// Text that only changes with the identity or the PID.
+   /// RFC 5424: " HOSTNAME APP-NAME PROCID MSGID ", followed by the STRUCTURED-DATA
+   /// RFC 3164: " TAG[PID]: ", the hostname is left out as ::syslog() does on the local socket
+   void SyslogTransport::updateHeaderTail() {
+      if (Format::RFC5424 == _format) {
+         _header_tail = " " + _hostname + " " + _identity + " " + std::to_string(_pid) + " - ";
+      } else {
+         _header_tail = " " + _identity + "[" + std::to_string(_pid) + "]: ";
+      }
+   }
+
+   /// Appends the timestamp, the formatted seconds are cached
+   /// RFC 5424: 2026-10-18T08:33:46.123456Z, RFC 3164: Oct 18 10:33:46 (local time)
+   void SyslogTransport::appendTimestamp(std::chrono::system_clock::time_point timestamp) {
+      using namespace std::chrono;
+      auto since_epoch = duration_cast<microseconds>(timestamp.time_since_epoch());
+      std::time_t second = static_cast<std::time_t>(duration_cast<seconds>(since_epoch).count());
+      long micros = static_cast<long>(since_epoch.count() % 1000000);
+      if (micros < 0) {
+         --second;
+         micros += 1000000;
+      }
+
+      if (second != _cached_second) {
+         char text[64];
+         struct tm time_parts;
+         if (Format::RFC5424 == _format) {
+            ::gmtime_r(&second, &time_parts);
+            std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &time_parts);
+         } else {
+            ::localtime_r(&second, &time_parts);
+            std::strftime(text, sizeof(text), "%b %e %H:%M:%S", &time_parts);
+         }
+         _cached_time = text;
+         _cached_second = second;
+
+         // the process could have forked, once per second is cheap enough to check
+         long pid = static_cast<long>(::getpid());
+         if (pid != _pid) {
+            _pid = pid;
+            updateHeaderTail();
+         }
+      }
+
+      _buffer.append(_cached_time);
+      if (Format::RFC5424 == _format) {
+         char fraction[16];
+         std::snprintf(fraction, sizeof(fraction), ".%06ldZ", micros);
+         _buffer.append(fraction);
+      }
+   }
+
+   /// [SD-ID file="..." line="..." function="..." thread="..."] or "-" (NILVALUE)
+   void SyslogTransport::appendStructuredData(const LogMessage* message) {
+      if (!_structured_data || nullptr == message) {
+         _buffer.push_back('-');
+         return;
+      }
+      _buffer.push_back('[');
+      _buffer.append(_sd_id);
+      appendParameter("file", message->_file);
+      appendParameter("line", std::to_string(message->_line));
+      appendParameter("function", message->_function);
+      appendParameter("thread", message->threadID());
+      _buffer.push_back(']');
+   }
+
+   /// PARAM-VALUE escapes '"', '\' and ']' with a backslash
+   void SyslogTransport::appendParameter(const char* name, const std::string& value) {
+      _buffer.push_back(' ');
+      _buffer.append(name);
+      _buffer.append("=\"");
+      for (char c : value) {
+         if ('"' == c || '\\' == c || ']' == c) {
+            _buffer.push_back('\\');
+         }
+         _buffer.push_back(c);
+      }
+      _buffer.push_back('"');
+   }
+
+   void SyslogTransport::frame(int severity, std::chrono::system_clock::time_point timestamp, const LogMessage* message, const std::string& text) {
+      size_t start = _buffer.size();
+      char priority[16];
+      int priority_size = std::snprintf(priority, sizeof(priority), "<%d>", (_facility & LOG_FACMASK) | (severity & LOG_PRIMASK));
+      _buffer.append(priority, static_cast<size_t>(priority_size));
+      if (Format::RFC5424 == _format) {
+         _buffer.append("1 ");
+      }
+      appendTimestamp(timestamp);
+      _buffer.append(_header_tail);
+      if (Format::RFC5424 == _format) {
+         appendStructuredData(message);
+         _buffer.push_back(' ');
+      }
+
+      size_t size = text.size();
+      while (size > 0 && ('\n' == text[size - 1] || '\r' == text[size - 1])) {
+         --size; // the message should not end with a line break
+      }
+      _buffer.append(text, 0, size);
+
+      if (Framing::OctetCounted == _framing) {
+         // RFC 6587: MSG-LEN SP SYSLOG-MSG
+         _buffer.insert(start, std::to_string(_buffer.size() - start) + " ");
+      }
+      if (_frame_ends.empty()) {
+         _pending_since = std::chrono::steady_clock::now();
+      }
+      _frame_ends.push_back(_buffer.size());
+   }
+
+   void SyslogTransport::sendPending() {
+      if (_frame_ends.empty()) {
+         return;
+      }
+      if (_socket < 0) {
+         connect();
+      }
+      const int flags = MSG_NOSIGNAL | (_non_blocking ? MSG_DONTWAIT : 0);
+      size_t handled = (Framing::OctetCounted == _framing) ? sendStream(flags) : sendDatagrams(flags);
+
+      if (_socket < 0) {
+         _counters.dropped += _frame_ends.size() - handled;
+         handled = _frame_ends.size();
+         _stream_sent = 0;
+      }
+      eraseFrames(handled);
+      _pending_since = std::chrono::steady_clock::now(); // the frames kept for retry were just tried
+
+      // the frames kept for retry are the oldest, a frame is counted the first time it is deferred
+      size_t deferred = _frame_ends.size();
+      _retry_counted = (handled < _retry_counted) ? _retry_counted - handled : 0;
+      _counters.retried += deferred - _retry_counted;
+      _retry_counted = deferred;
+      if (deferred > _max_retry_frames) {
+         // a frame that is partly written to the stream must be completed, the next oldest are dropped
+         size_t first = (_stream_sent > 0) ? 1 : 0;
+         size_t excess = deferred - std::max(_max_retry_frames, first);
+         _counters.dropped += excess;
+         eraseFrames(excess, first);
+         _retry_counted -= excess;
+      }
+   }
+
+   /// @return the number of frames that were sent or dropped, one datagram per frame
+   size_t SyslogTransport::sendDatagrams(int flags) {
+      auto& frames = _frames;
+      frames.resize(_frame_ends.size());
+      size_t begin = 0;
+      for (size_t i = 0; i < _frame_ends.size(); ++i) {
+         frames[i].iov_base = &_buffer[begin];
+         frames[i].iov_len = _frame_ends[i] - begin;
+         begin = _frame_ends[i];
+      }
+
+      size_t sent = 0;
+      bool reconnected = false;
+      while (sent < frames.size() && _socket >= 0) {
+#if defined(__linux__)
+         auto& messages = _messages;
+         messages.resize(frames.size() - sent);
+         std::memset(messages.data(), 0, messages.size() * sizeof(mmsghdr));
+         for (size_t i = 0; i < messages.size(); ++i) {
+            messages[i].msg_hdr.msg_iov = &frames[sent + i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+         }
+         int result = ::sendmmsg(_socket, messages.data(), static_cast<unsigned int>(messages.size()), flags);
+#else
+         int result = (::send(_socket, frames[sent].iov_base, frames[sent].iov_len, flags) >= 0) ? 1 : -1;
+#endif
+         if (result > 0) {
+            sent += static_cast<size_t>(result);
+            _counters.sent += static_cast<uint64_t>(result);
+            continue;
+         }
+         if (EINTR == errno) {
+            continue;
+         }
+         if (_non_blocking && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+            break; // the daemon is behind, the rest is kept for retry
+         }
+         if (!reconnected && (ECONNREFUSED == errno || ENOTCONN == errno)) {
+            // the daemon was restarted
+            reconnected = true;
+            if (connect()) {
+               continue;
+            }
+         }
+         ++sent; // drop the frame that could not be sent, as ::syslog() would do
+         ++_counters.dropped;
+      }
+      return sent;
+   }
+
+   /// All pending frames are already back to back in _buffer, in the octet counted framing,
+   /// and are written with as few send() calls as the stream accepts.
+   /// @return the number of frames that were sent or dropped
+   size_t SyslogTransport::sendStream(int flags) {
+      size_t offset = _stream_sent;
+      bool reconnected = false;
+      bool failed = false;
+      while (offset < _buffer.size() && _socket >= 0) {
+         auto result = ::send(_socket, _buffer.data() + offset, _buffer.size() - offset, flags);
+         if (result >= 0) {
+            offset += static_cast<size_t>(result);
+            continue;
+         }
+         if (EINTR == errno) {
+            continue;
+         }
+         if (_non_blocking && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+            break; // the collector is behind, the rest is kept for retry
+         }
+         if (!reconnected && (EPIPE == errno || ECONNRESET == errno || ENOTCONN == errno || ECONNREFUSED == errno)) {
+            // the collector was restarted, a frame that was cut is sent again from its start
+            reconnected = true;
+            if (connect()) {
+               auto cut = std::upper_bound(_frame_ends.begin(), _frame_ends.end(), offset);
+               offset = (cut == _frame_ends.begin()) ? 0 : *(cut - 1);
+               continue;
+            }
+         }
+         failed = true;
+         break;
+      }
+
+      size_t complete = static_cast<size_t>(std::upper_bound(_frame_ends.begin(), _frame_ends.end(), offset) - _frame_ends.begin());
+      _counters.sent += complete;
+      if (failed) {
+         disconnect(); // the collector must not get the rest of a cut frame on this connection
+         _counters.dropped += _frame_ends.size() - complete;
+         _stream_sent = 0;
+         return _frame_ends.size();
+      }
+      _stream_sent = offset - ((complete > 0) ? _frame_ends[complete - 1] : 0);
+      return complete;
+   }
+
+   /// removes @param count frames, starting with frame number @param first
+   void SyslogTransport::eraseFrames(size_t count, size_t first) {
+      if (0 == first && count >= _frame_ends.size()) {
+         _buffer.clear();
+         _frame_ends.clear();
+         return;
+      }
+      if (first >= _frame_ends.size()) {
+         return;
+      }
+      count = std::min(count, _frame_ends.size() - first);
+      if (0 == count) {
+         return;
+      }
+      size_t begin = (first > 0) ? _frame_ends[first - 1] : 0;
+      size_t erased_bytes = _frame_ends[first + count - 1] - begin;
+      _buffer.erase(begin, erased_bytes);
+      auto erased = _frame_ends.begin() + static_cast<std::ptrdiff_t>(first);
+      _frame_ends.erase(erased, erased + static_cast<std::ptrdiff_t>(count));
+      for (size_t i = first; i < _frame_ends.size(); ++i) {
+         _frame_ends[i] -= erased_bytes;
+      }
+   }
+}
@@ -0,0 +1,87 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <mutex>
+#include <g3sinks/ColorCoutSink.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, std::string content) {
+      g3::LogMessage message(__FILE__, __LINE__, __FUNCTION__, level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+
+   /// std::stringstream is not thread safe, the flush thread writes while the test reads
+   struct LockedStream : std::stringbuf {
+      std::mutex mutex;
+      int sync() override { return 0; }
+      std::streamsize xsputn(const char* data, std::streamsize size) override {
+         std::lock_guard<std::mutex> lock(mutex);
+         return std::stringbuf::xsputn(data, size);
+      }
+      std::string content() {
+         std::lock_guard<std::mutex> lock(mutex);
+         return str();
+      }
+   };
+} // anonymous
+
+TEST(ColorCoutSinkTest, ColorPerLevelOnATerminal) {
+   std::ostringstream out;
+   {
+      ColorCoutSink sink(out, true, false);
+      sink.ReceiveLogMessage(CreateLogEntry(G3LOG_DEBUG, "debug"));
+      EXPECT_NE(std::string::npos, out.str().find("\033[32m")) << out.str();
+      sink.ReceiveLogMessage(CreateLogEntry(WARNING, "warning"));
+   }
+   auto text = out.str();
+   EXPECT_NE(std::string::npos, text.find("\033[33m")) << text;
+   EXPECT_NE(std::string::npos, text.find("warning\033[m\n")) << text;
+   EXPECT_EQ(size_t{2}, static_cast<size_t>(std::count(text.begin(), text.end(), '\n'))) << text;
+}
+
+TEST(ColorCoutSinkTest, RedirectedOutputIsPlainAndCoalesced) {
+   std::ostringstream out;
+   ColorCoutSink sink(out, false, true);
+   ColorCoutSink::FlushPolicy policy;
+   policy.max_delay = std::chrono::milliseconds(0);
+   sink.setFlushPolicy(policy);
+
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "first"));
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "second"));
+   EXPECT_TRUE(out.str().empty());
+   sink.ReceiveLogMessage(CreateLogEntry(WARNING, "severe records flush"));
+   auto text = out.str();
+   EXPECT_EQ(std::string::npos, text.find("\033[")) << text;
+   EXPECT_NE(std::string::npos, text.find("first\n")) << text;
+   EXPECT_NE(std::string::npos, text.find("severe records flush\n")) << text;
+}
+
+TEST(ColorCoutSinkTest, CoalescedOutputIsFlushedAfterTheDelay) {
+   LockedStream buffer;
+   std::ostream out(&buffer);
+   ColorCoutSink sink(out, false, true);
+   ColorCoutSink::FlushPolicy policy;
+   policy.max_delay = std::chrono::milliseconds(20);
+   sink.setFlushPolicy(policy);
+
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "idle afterwards"));
+   auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+   while (buffer.content().empty() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+   }
+   EXPECT_NE(std::string::npos, buffer.content().find("idle afterwards")) << buffer.content();
+}
@@ -0,0 +1,290 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "FaultInjection.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <dlfcn.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+   using Clock = std::chrono::steady_clock;
+
+   struct Faults {
+      std::string path;
+      uint64_t generation = 0; // of the configuration, the matched file descriptors are cached per generation
+      Clock::time_point configured;
+      std::chrono::microseconds write_delay{0};
+      uint64_t write_delay_every = 1;
+      std::chrono::microseconds fsync_delay{0};
+      size_t short_write = 0;
+      uint64_t enospc_after = 0;
+      uint64_t enospc_every = 0;
+      std::chrono::milliseconds active{0};
+      std::chrono::milliseconds period{0};
+
+      bool isActive() const {
+         if (0 == period.count()) {
+            return true;
+         }
+         auto since = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - configured);
+         return (since % period) < active;
+      }
+   };
+
+   struct Counters {
+      std::atomic<uint64_t> writes{0};
+      std::atomic<uint64_t> bytes{0};
+      std::atomic<uint64_t> delayed_writes{0};
+      std::atomic<uint64_t> short_writes{0};
+      std::atomic<uint64_t> failed_writes{0};
+      std::atomic<uint64_t> fsyncs{0};
+      std::atomic<uint64_t> delayed_fsyncs{0};
+   };
+
+   std::shared_ptr<const Faults> g_faults; // read and replaced with std::atomic_load and std::atomic_store
+   std::atomic<uint64_t> g_generation{0};
+   Counters g_counters;
+
+   // per file descriptor: the configuration generation << 2 | kMatch or kNoMatch
+   const int kMaxCachedFd = 4096;
+   const uint64_t kMatch = 1;
+   const uint64_t kNoMatch = 2;
+   std::atomic<uint64_t> g_fd_state[kMaxCachedFd];
+
+   template <typename Function>
+   Function real(const char* name) {
+      return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+   }
+
+   using WriteFunction = ssize_t (*)(int, const void*, size_t);
+   using WritevFunction = ssize_t (*)(int, const iovec*, int);
+   using SyncFunction = int (*)(int);
+   using CloseFunction = int (*)(int);
+
+   bool matches(int fd, const Faults& faults) {
+      if (fd < 0 || faults.path.empty()) {
+         return false;
+      }
+      if (fd < kMaxCachedFd) {
+         uint64_t state = g_fd_state[fd].load(std::memory_order_relaxed);
+         if ((state >> 2) == faults.generation) {
+            return kMatch == (state & 3);
+         }
+      }
+      char link[64];
+      char path[4096];
+      std::snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+      ssize_t length = readlink(link, path, sizeof(path) - 1);
+      bool match = false;
+      if (length > 0) {
+         path[length] = '\0';
+         match = (nullptr != std::strstr(path, faults.path.c_str()));
+      }
+      if (fd < kMaxCachedFd) {
+         g_fd_state[fd].store((faults.generation << 2) | (match ? kMatch : kNoMatch), std::memory_order_relaxed);
+      }
+      return match;
+   }
+
+   /// Delays the write as configured. @return the errno to fail it with, 0 to write at most @param max_bytes
+   int beforeWrite(const Faults& faults, size_t& max_bytes) {
+      uint64_t write = g_counters.writes.fetch_add(1) + 1;
+      if (!faults.isActive()) {
+         return 0;
+      }
+      if (faults.write_delay.count() > 0 && 0 == write % faults.write_delay_every) {
+         g_counters.delayed_writes.fetch_add(1);
+         std::this_thread::sleep_for(faults.write_delay);
+      }
+      if ((faults.enospc_after > 0 && g_counters.bytes.load() >= faults.enospc_after)
+          || (faults.enospc_every > 0 && 0 == write % faults.enospc_every)) {
+         g_counters.failed_writes.fetch_add(1);
+         return ENOSPC;
+      }
+      if (faults.enospc_after > 0) {
+         max_bytes = std::min<uint64_t>(max_bytes, faults.enospc_after - g_counters.bytes.load());
+      }
+      if (faults.short_write > 0 && max_bytes > faults.short_write) {
+         g_counters.short_writes.fetch_add(1);
+         max_bytes = faults.short_write;
+      }
+      return 0;
+   }
+
+   void beforeSync(int fd) {
+      auto faults = std::atomic_load(&g_faults);
+      if (faults && matches(fd, *faults)) {
+         g_counters.fsyncs.fetch_add(1);
+         if (faults->fsync_delay.count() > 0 && faults->isActive()) {
+            g_counters.delayed_fsyncs.fetch_add(1);
+            std::this_thread::sleep_for(faults->fsync_delay);
+         }
+      }
+   }
+
+   /// Configuration from the environment, for LD_PRELOAD
+   __attribute__((constructor)) void configureFromEnvironment() {
+      const char* spec = std::getenv("G3SINKS_FAULTS");
+      if (nullptr != spec && 0 != g3sinks_faults_configure(spec)) {
+         std::cerr << "g3sinks_faultinject: cannot use G3SINKS_FAULTS=" << spec << std::endl;
+      }
+   }
+} // anonymous
+
+extern "C" {
+   int g3sinks_faults_configure(const char* spec) {
+      auto faults = std::make_shared<Faults>();
+      std::stringstream pairs(nullptr == spec ? "" : spec);
+      std::string pair;
+      while (std::getline(pairs, pair, ',')) {
+         auto equal = pair.find('=');
+         if (equal == std::string::npos) {
+            return -1;
+         }
+         std::string key = pair.substr(0, equal);
+         std::string value = pair.substr(equal + 1);
+         uint64_t number = std::strtoull(value.c_str(), nullptr, 10);
+         if ("path" == key) {
+            faults->path = value;
+         } else if ("write_delay_us" == key) {
+            faults->write_delay = std::chrono::microseconds(number);
+         } else if ("write_delay_every" == key) {
+            faults->write_delay_every = std::max<uint64_t>(number, 1);
+         } else if ("fsync_delay_us" == key) {
+            faults->fsync_delay = std::chrono::microseconds(number);
+         } else if ("short_write" == key) {
+            faults->short_write = static_cast<size_t>(number);
+         } else if ("enospc_after" == key) {
+            faults->enospc_after = number;
+         } else if ("enospc_every" == key) {
+            faults->enospc_every = number;
+         } else if ("active_ms" == key) {
+            faults->active = std::chrono::milliseconds(number);
+         } else if ("period_ms" == key) {
+            faults->period = std::chrono::milliseconds(number);
+         } else {
+            return -1;
+         }
+      }
+      faults->generation = ++g_generation;
+      faults->configured = Clock::now();
+      g_counters.writes = 0;
+      g_counters.bytes = 0;
+      g_counters.delayed_writes = 0;
+      g_counters.short_writes = 0;
+      g_counters.failed_writes = 0;
+      g_counters.fsyncs = 0;
+      g_counters.delayed_fsyncs = 0;
+      std::atomic_store(&g_faults, std::shared_ptr<const Faults>(faults));
+      return 0;
+   }
+
+   void g3sinks_faults_clear(void) {
+      std::atomic_store(&g_faults, std::shared_ptr<const Faults>());
+   }
+
+   void g3sinks_faults_counters(struct G3sinksFaultCounters* counters) {
+      counters->writes = g_counters.writes.load();
+      counters->bytes = g_counters.bytes.load();
+      counters->delayed_writes = g_counters.delayed_writes.load();
+      counters->short_writes = g_counters.short_writes.load();
+      counters->failed_writes = g_counters.failed_writes.load();
+      counters->fsyncs = g_counters.fsyncs.load();
+      counters->delayed_fsyncs = g_counters.delayed_fsyncs.load();
+   }
+
+   ssize_t write(int fd, const void* buffer, size_t count) {
+      static auto real_write = real<WriteFunction>("write");
+      auto faults = std::atomic_load(&g_faults);
+      if (!faults || !matches(fd, *faults)) {
+         return real_write(fd, buffer, count);
+      }
+      size_t max_bytes = count;
+      int error = beforeWrite(*faults, max_bytes);
+      if (0 != error) {
+         errno = error;
+         return -1;
+      }
+      ssize_t written = real_write(fd, buffer, max_bytes);
+      if (written > 0) {
+         g_counters.bytes.fetch_add(static_cast<uint64_t>(written));
+      }
+      return written;
+   }
+
+   ssize_t writev(int fd, const iovec* parts, int count) {
+      static auto real_writev = real<WritevFunction>("writev");
+      auto faults = std::atomic_load(&g_faults);
+      if (!faults || !matches(fd, *faults)) {
+         return real_writev(fd, parts, count);
+      }
+      size_t total = 0;
+      for (int i = 0; i < count; ++i) {
+         total += parts[i].iov_len;
+      }
+      size_t max_bytes = total;
+      int error = beforeWrite(*faults, max_bytes);
+      if (0 != error) {
+         errno = error;
+         return -1;
+      }
+
+      // a short write: the parts are cut after max_bytes
+      const int kMaxParts = 64;
+      iovec shortened[kMaxParts];
+      if (max_bytes < total && count <= kMaxParts) {
+         int used = 0;
+         for (size_t left = max_bytes; used < count && left > 0; ++used) {
+            shortened[used] = parts[used];
+            shortened[used].iov_len = std::min(left, parts[used].iov_len);
+            left -= shortened[used].iov_len;
+         }
+         parts = shortened;
+         count = used;
+      }
+      ssize_t written = real_writev(fd, parts, count);
+      if (written > 0) {
+         g_counters.bytes.fetch_add(static_cast<uint64_t>(written));
+      }
+      return written;
+   }
+
+   int fsync(int fd) {
+      static auto real_fsync = real<SyncFunction>("fsync");
+      beforeSync(fd);
+      return real_fsync(fd);
+   }
+
+   int fdatasync(int fd) {
+      static auto real_fdatasync = real<SyncFunction>("fdatasync");
+      beforeSync(fd);
+      return real_fdatasync(fd);
+   }
+
+   int close(int fd) {
+      static auto real_close = real<CloseFunction>("close");
+      if (fd >= 0 && fd < kMaxCachedFd) {
+         g_fd_state[fd].store(0, std::memory_order_relaxed); // the number is reused for another file
+      }
+      return real_close(fd);
+   }
+} // extern "C"
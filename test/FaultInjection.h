@@ -0,0 +1,61 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+/**
+* Slow and failing disks for testing the sinks, Linux only.
+*
+* libg3sinks_faultinject interposes write(), writev(), fsync(), fdatasync() and close(). Calls on
+* files whose path contains the configured path are delayed or failed according to the spec, all
+* other calls go straight to libc. It works on any binary, e.g. with g3sinks_loadgen:
+*    G3SINKS_FAULTS="path=/tmp/slow/,write_delay_us=2000,active_ms=500,period_ms=5000" \
+*    LD_PRELOAD=libg3sinks_faultinject.so ./g3sinks_loadgen --dir /tmp/slow/
+* or linked into a test or a benchmark and configured with g3sinks_faults_configure().
+*
+* The spec is comma separated key=value pairs:
+*    path=SUBSTRING        only files whose path contains SUBSTRING are faulted, required
+*    write_delay_us=N      each write() or writev() sleeps N us first
+*    write_delay_every=N   ... but only every Nth one, default 1
+*    fsync_delay_us=N      each fsync() or fdatasync() sleeps N us first
+*    short_write=N         a write() or writev() writes at most N bytes
+*    enospc_after=N        writes fail with ENOSPC once N bytes are written, the disk is full
+*    enospc_every=N        every Nth write fails with ENOSPC
+*    active_ms=A           faults only during the first A ms ...
+*    period_ms=P           ... of every P ms since the configuration, default: always
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct G3sinksFaultCounters {
+   uint64_t writes; // write() and writev() calls on faulted files
+   uint64_t bytes; // written to faulted files
+   uint64_t delayed_writes;
+   uint64_t short_writes;
+   uint64_t failed_writes;
+   uint64_t fsyncs; // fsync() and fdatasync() calls on faulted files
+   uint64_t delayed_fsyncs;
+};
+
+/// Replaces the faults and clears the counters. @return 0, -1 if the spec has an unknown key
+int g3sinks_faults_configure(const char* spec);
+
+/// No more faults, the counters are kept
+void g3sinks_faults_clear(void);
+
+void g3sinks_faults_counters(struct G3sinksFaultCounters* counters);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+/** ==========================================================================
+ * 2026 by KjellKod.cc
+ *
+ * This code is PUBLIC DOMAIN to use at your own risk and comes
+ * with no warranties. This code is yours to share, use and modify with no
+ * strings attached and no restrictions or obligations.
+ * ============================================================================*
+ * PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+ * ********************************************* */
+
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <g3log/g3log.hpp>
+#include <g3log/logworker.hpp>
+#include "FaultInjection.h"
+#include "g3sinks/LogRotate.h"
+#if defined(G3SINKS_FAULT_FILELOG)
+#include "g3sinks/FileLogSink.h"
+#endif
+
+namespace {
+   const std::string kFaultDirectory = "/tmp/g3sinks_fault_test/";
+
+   std::string ReadFile(const std::string& path) {
+      std::ifstream in(path);
+      std::stringstream content;
+      content << in.rdbuf();
+      return content.str();
+   }
+
+   std::string Entry(int index) {
+      return "entry " + std::to_string(index) + " of the fault injection test\n";
+   }
+
+   class FaultInjectionTest : public ::testing::Test {
+    protected:
+      void SetUp() override {
+         ASSERT_EQ(0, std::system(("rm -rf " + kFaultDirectory + " && mkdir -p " + kFaultDirectory).c_str()));
+      }
+      void TearDown() override {
+         g3sinks_faults_clear();
+         std::system(("rm -rf " + kFaultDirectory).c_str());
+      }
+
+      G3sinksFaultCounters counters() {
+         G3sinksFaultCounters counters;
+         g3sinks_faults_counters(&counters);
+         return counters;
+      }
+   };
+
+   std::chrono::milliseconds Elapsed(std::chrono::steady_clock::time_point start) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+   }
+} // anonymous
+
+TEST_F(FaultInjectionTest, OnlyTheConfiguredPathIsFaulted) {
+   EXPECT_EQ(-1, g3sinks_faults_configure("path=/tmp/,no_such_fault=1"));
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",enospc_every=1").c_str()));
+
+   int faulted = open((kFaultDirectory + "faulted").c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+   int other = open("/tmp/g3sinks_not_faulted", O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+   ASSERT_LE(0, faulted);
+   ASSERT_LE(0, other);
+   EXPECT_EQ(-1, write(faulted, "x", 1));
+   EXPECT_EQ(ENOSPC, errno);
+   EXPECT_EQ(1, write(other, "x", 1));
+   close(other);
+   std::remove("/tmp/g3sinks_not_faulted");
+
+   // outside of the active window nothing is faulted
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",enospc_every=1,active_ms=0,period_ms=60000").c_str()));
+   EXPECT_EQ(1, write(faulted, "x", 1));
+   close(faulted);
+   EXPECT_EQ(1u, counters().writes);
+   EXPECT_EQ(0u, counters().failed_writes);
+}
+
+TEST_F(FaultInjectionTest, LogRotateWriteLatencyOnASlowDisk) {
+   LogRotate logrotate("slow", kFaultDirectory);
+   logrotate.setFlushPolicy(1);
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",write_delay_us=2000").c_str()));
+   for (int i = 0; i < 20; ++i) {
+      logrotate.save(Entry(i));
+   }
+   auto stats = logrotate.stats();
+   EXPECT_LE(20u, counters().delayed_writes);
+   EXPECT_LE(std::chrono::milliseconds(2), stats.write_latency.percentile(50));
+   EXPECT_EQ(0u, stats.write_errors);
+}
+
+TEST_F(FaultInjectionTest, LogRotateContinuesAfterTheDiskWasFull) {
+   std::string log_file;
+   uint64_t write_errors = 0;
+   {
+      LogRotate logrotate("full", kFaultDirectory);
+      logrotate.setFlushPolicy(1);
+      log_file = logrotate.logFileName();
+      logrotate.save(Entry(0));
+      ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",enospc_every=1").c_str()));
+      for (int i = 1; i < 10; ++i) {
+         logrotate.save(Entry(i));
+      }
+      EXPECT_LE(9u, counters().failed_writes);
+      g3sinks_faults_clear();
+      logrotate.save("after the disk was freed\n");
+      write_errors = logrotate.stats().write_errors;
+   }
+   EXPECT_LE(9u, write_errors);
+   auto content = ReadFile(log_file);
+   EXPECT_NE(std::string::npos, content.find(Entry(0))) << content;
+   EXPECT_NE(std::string::npos, content.find("after the disk was freed")) << content;
+}
+
+TEST_F(FaultInjectionTest, ShortWritesAreCompleted) {
+   std::string log_file;
+   std::string expected;
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",short_write=7").c_str()));
+   {
+      LogRotate logrotate("short", kFaultDirectory);
+      logrotate.setFlushPolicy(1);
+      log_file = logrotate.logFileName();
+      for (int i = 0; i < 10; ++i) {
+         logrotate.save(Entry(i));
+         expected += Entry(i);
+      }
+   }
+   EXPECT_LT(10u, counters().short_writes);
+   EXPECT_NE(std::string::npos, ReadFile(log_file).find(expected));
+
+#if defined(G3SINKS_FAULT_FILELOG)
+   const std::string file = kFaultDirectory + "short_filelog";
+   {
+      FileLogSink sink(open(file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644), true);
+      for (int i = 0; i < 10; ++i) {
+         g3::LogMessage message("Fault.cpp", i, "test", INFO);
+         message.write().append(Entry(i));
+         sink.ReceiveLogMessage(g3::LogMessageMover(std::move(message)));
+      }
+   }
+   auto content = ReadFile(file);
+   for (int i = 0; i < 10; ++i) {
+      EXPECT_NE(std::string::npos, content.find(Entry(i))) << content;
+   }
+#endif
+}
+
+#if defined(G3SINKS_FAULT_FILELOG)
+TEST_F(FaultInjectionTest, FileLogSinkRotateDoesNotWaitForAStalledFsync) {
+   const std::string file = kFaultDirectory + "stalled_fsync";
+   FileLogSink sink(open(file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644), true);
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",fsync_delay_us=300000").c_str()));
+
+   auto start = std::chrono::steady_clock::now();
+   auto synced = sink.Rotate(open((file + ".next").c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644), true);
+   EXPECT_GT(std::chrono::milliseconds(100), Elapsed(start)) << "the sink thread is not blocked by the fsync";
+   EXPECT_EQ(std::future_status::timeout, synced.wait_for(std::chrono::milliseconds(50)));
+   EXPECT_TRUE(synced.get());
+   EXPECT_LE(std::chrono::milliseconds(300), Elapsed(start));
+   EXPECT_EQ(1u, counters().delayed_fsyncs);
+}
+#endif
+
+TEST_F(FaultInjectionTest, TheQueueGrowsWhileTheDiskIsSlow) {
+   auto logworker = g3::LogWorker::createLogWorker();
+   g3::initializeLogging(logworker.get());
+   auto logrotate = std::make_unique<LogRotate>("queue", kFaultDirectory);
+   logrotate->setFlushPolicy(1);
+   auto handle = logworker->addSink(std::move(logrotate), &LogRotate::save);
+   ASSERT_EQ(0, g3sinks_faults_configure(("path=" + kFaultDirectory + ",write_delay_us=3000").c_str()));
+
+   const int kEntries = 100;
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < kEntries; ++i) {
+      LOG(INFO) << "queued " << i;
+   }
+   auto produced = Elapsed(start);
+   auto stats = handle->call(&LogRotate::stats).get(); // waits behind the queued entries
+   auto drained = Elapsed(start);
+
+   EXPECT_EQ(static_cast<uint64_t>(kEntries), stats.records_written);
+   EXPECT_LE(std::chrono::milliseconds(3 * kEntries), drained);
+   EXPECT_GT(drained / 4, produced) << "LOG calls do not wait for the disk, the entries queue up";
+}
@@ -0,0 +1,268 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <g3sinks/FileLogSink.h>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <future>
+#include <string>
+
+namespace {
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, std::string content) {
+      g3::LogMessage message(__FILE__, __LINE__, __FUNCTION__, level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+
+   int TemporaryFd() {
+      return fileno(std::tmpfile());
+   }
+
+   std::string ReadAll(int fd) {
+      std::string content;
+      char chunk[4096];
+      ssize_t size = 0;
+      while ((size = pread(fd, chunk, sizeof(chunk), static_cast<off_t>(content.size()))) > 0) {
+         content.append(chunk, static_cast<size_t>(size));
+      }
+      return content;
+   }
+
+   size_t Lines(const std::string& content) {
+      return static_cast<size_t>(std::count(content.begin(), content.end(), '\n'));
+   }
+} // anonymous
+
+TEST(FileLogSinkTest, OneLinePerRecordWithoutNul) {
+   int fd = TemporaryFd();
+   {
+      FileLogSink sink(fd, false);
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "first"));
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "second"));
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "third"));
+   }
+   auto content = ReadAll(fd);
+   EXPECT_EQ(std::string::npos, content.find('\0'));
+   EXPECT_EQ(size_t{3}, Lines(content)) << content;
+   EXPECT_NE(std::string::npos, content.find("second\n"));
+   close(fd);
+}
+
+TEST(FileLogSinkTest, BufferedUntilFlush) {
+   int fd = TemporaryFd();
+   FileLogSink sink(fd, false);
+   FileLogSink::FlushPolicy policy;
+   policy.max_bytes = 64 * 1024;
+   sink.setFlushPolicy(policy);
+
+   for (int i = 0; i < 10; ++i) {
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "buffered " + std::to_string(i)));
+   }
+   EXPECT_TRUE(ReadAll(fd).empty());
+   sink.flush();
+   auto content = ReadAll(fd);
+   EXPECT_EQ(size_t{10}, Lines(content)) << content;
+   EXPECT_EQ(std::string::npos, content.find('\0'));
+   close(fd);
+}
+
+TEST(FileLogSinkTest, BufferIsWrittenWhenFull) {
+   int fd = TemporaryFd();
+   FileLogSink sink(fd, false);
+   FileLogSink::FlushPolicy policy;
+   policy.max_bytes = 1024;
+   sink.setFlushPolicy(policy);
+
+   const std::string record(300, 'x');
+   size_t received = 0;
+   while (ReadAll(fd).empty()) {
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, record));
+      ++received;
+      ASSERT_LT(received, size_t{10});
+   }
+   // the buffer and the record that did not fit are written together
+   EXPECT_EQ(received, Lines(ReadAll(fd)));
+   close(fd);
+}
+
+TEST(FileLogSinkTest, SevereRecordAndMaxRecordsFlush) {
+   int fd = TemporaryFd();
+   FileLogSink sink(fd, false);
+   FileLogSink::FlushPolicy policy;
+   policy.max_bytes = 64 * 1024;
+   policy.max_records = 3;
+   sink.setFlushPolicy(policy);
+
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "info"));
+   EXPECT_TRUE(ReadAll(fd).empty());
+   sink.ReceiveLogMessage(CreateLogEntry(WARNING, "warning"));
+   EXPECT_EQ(size_t{2}, Lines(ReadAll(fd)));
+
+   for (int i = 0; i < 3; ++i) {
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "info"));
+   }
+   EXPECT_EQ(size_t{5}, Lines(ReadAll(fd)));
+   close(fd);
+}
+
+TEST(FileLogSinkTest, RotateDrainsToTheOldFd) {
+   int first = TemporaryFd();
+   int second = TemporaryFd();
+   {
+      FileLogSink sink(first, false);
+      FileLogSink::FlushPolicy policy;
+      policy.max_bytes = 64 * 1024;
+      sink.setFlushPolicy(policy);
+
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "before rotation"));
+      sink.Rotate(second, false);
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "after rotation"));
+   }
+   auto before = ReadAll(first);
+   auto after = ReadAll(second);
+   EXPECT_NE(std::string::npos, before.find("before rotation")) << before;
+   EXPECT_EQ(std::string::npos, before.find("after rotation")) << before;
+   EXPECT_NE(std::string::npos, after.find("after rotation")) << after;
+   EXPECT_EQ(size_t{1}, Lines(after));
+   close(first);
+   close(second);
+}
+
+TEST(FileLogSinkTest, RotateSyncsAndClosesOnTheHelperThread) {
+   int first = TemporaryFd();
+   int second = TemporaryFd();
+   {
+      FileLogSink sink(first, true);
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "before rotation"));
+      std::future<bool> synced = sink.Rotate(second, false);
+      // closed right away, the helper thread syncs its own duplicate
+      EXPECT_EQ(-1, fcntl(first, F_GETFD));
+      ASSERT_EQ(std::future_status::ready, synced.wait_for(std::chrono::seconds(10)));
+      EXPECT_TRUE(synced.get());
+
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "after rotation"));
+      auto current = sink.syncAsync();
+      EXPECT_TRUE(current.get());
+      EXPECT_NE(-1, fcntl(second, F_GETFD));
+   }
+   // the sink does not close what it does not own
+   EXPECT_NE(-1, fcntl(second, F_GETFD));
+   EXPECT_NE(std::string::npos, ReadAll(second).find("after rotation"));
+   close(second);
+}
+
+TEST(FileLogSinkTest, RotateWithoutFileDescriptor) {
+   int fd = TemporaryFd();
+   FileLogSink sink(-1, false);
+   EXPECT_FALSE(sink.Rotate(fd, false).get());
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "first record"));
+   EXPECT_EQ(size_t{1}, Lines(ReadAll(fd)));
+   close(fd);
+}
+
+TEST(FileLogSinkTest, BufferedRecordsAreSplicedIntoAPipe) {
+   int pipe_fds[2];
+   ASSERT_EQ(0, pipe(pipe_fds));
+   FileLogSink sink(pipe_fds[1], true);
+   FileLogSink::FlushPolicy policy;
+   policy.max_bytes = 8 * 1024;
+   sink.setFlushPolicy(policy);
+#if defined(__linux__)
+   EXPECT_TRUE(sink.usesZeroCopy());
+#endif
+
+   std::string expected;
+   for (int batch = 0; batch < 3; ++batch) {
+      // the gifted pages of a batch must not be overwritten by the next batch
+      for (int i = 0; i < 10; ++i) {
+         sink.ReceiveLogMessage(CreateLogEntry(INFO, "batch " + std::to_string(batch) + " record " + std::to_string(i)));
+      }
+      sink.flush();
+   }
+   sink.setLatencyTracking(true, std::chrono::seconds(3600));
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, std::string(20 * 1024, 'x'))); // larger than the buffer
+   EXPECT_EQ(uint64_t{1}, sink.latency().to_flush.count()) << "written straight to the pipe";
+   sink.setLatencyTracking(false);
+   sink.flush();
+
+   std::string received;
+   char chunk[4096];
+   while (Lines(received) < 31) {
+      auto size = read(pipe_fds[0], chunk, sizeof(chunk));
+      ASSERT_GT(size, 0);
+      received.append(chunk, static_cast<size_t>(size));
+   }
+   for (int batch = 0; batch < 3; ++batch) {
+      for (int i = 0; i < 10; ++i) {
+         EXPECT_NE(std::string::npos, received.find("batch " + std::to_string(batch) + " record " + std::to_string(i) + "\n"));
+      }
+   }
+   EXPECT_NE(std::string::npos, received.find(std::string(20 * 1024, 'x') + "\n"));
+   EXPECT_EQ(std::string::npos, received.find('\0'));
+   close(pipe_fds[0]);
+}
+
+TEST(FileLogSinkTest, ZeroCopyOnlyForPipes) {
+   int fd = TemporaryFd();
+   FileLogSink sink(fd, false);
+   FileLogSink::FlushPolicy policy;
+   policy.max_bytes = 8 * 1024;
+   sink.setFlushPolicy(policy);
+   EXPECT_FALSE(sink.usesZeroCopy());
+
+   int pipe_fds[2];
+   ASSERT_EQ(0, pipe(pipe_fds));
+   sink.Rotate(pipe_fds[1], true);
+#if defined(__linux__)
+   EXPECT_TRUE(sink.usesZeroCopy());
+#endif
+   sink.setZeroCopy(false);
+   EXPECT_FALSE(sink.usesZeroCopy());
+   sink.ReceiveLogMessage(CreateLogEntry(WARNING, "written"));
+   char chunk[4096];
+   auto size = read(pipe_fds[0], chunk, sizeof(chunk));
+   ASSERT_GT(size, 0);
+   EXPECT_NE(std::string::npos, std::string(chunk, static_cast<size_t>(size)).find("written"));
+   close(pipe_fds[0]);
+   close(fd);
+}
+
+TEST(FileLogSinkTest, LatencyToWriteAndToFlush) {
+   int fd = TemporaryFd();
+   {
+      FileLogSink sink(fd, false);
+      FileLogSink::FlushPolicy policy;
+      policy.max_bytes = 4096;
+      sink.setFlushPolicy(policy);
+      sink.setLatencyTracking(true);
+
+      auto queued = CreateLogEntry(INFO, "queued");
+      queued.get()._timestamp -= std::chrono::milliseconds(100);
+      sink.ReceiveLogMessage(std::move(queued));
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "fresh"));
+      auto latency = sink.latency();
+      EXPECT_EQ(uint64_t{2}, latency.to_write.count());
+      EXPECT_EQ(uint64_t{0}, latency.to_flush.count());
+      EXPECT_GE(latency.to_write.max(), std::chrono::milliseconds(100));
+
+      sink.flush();
+      latency = sink.latency();
+      EXPECT_EQ(uint64_t{2}, latency.to_flush.count());
+      EXPECT_GE(latency.to_flush.percentile(100), std::chrono::milliseconds(100));
+      EXPECT_EQ(size_t{2}, Lines(ReadAll(fd)));
+   }
+   // the summary is written at exit, after the records
+   auto content = ReadAll(fd);
+   EXPECT_EQ(size_t{3}, Lines(content)) << content;
+   EXPECT_NE(std::string::npos, content.find("\ng3sinks: latency of 2 entries")) << content;
+   close(fd);
+}
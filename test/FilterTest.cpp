@@ -11,6 +11,8 @@
 #include <iostream>
 #include <cerrno>
 #include <memory>
+#include <thread>
+#include <chrono>
 
 #include "FilterTest.h"
 #include <g3sinks/LogRotateWithFilter.h>
@@ -34,6 +36,20 @@ namespace { // anonymous
 
 #define CREATE_LOG_ENTRY(level, content) CreateLogEntry(level, content, __FILE__, __LINE__, __FUNCTION__)
 
+    // an entry that was created @param age ago, i.e. it has been queued for that long
+    g3::LogMessageMover CreateQueuedLogEntry(const LEVELS level, std::string content, std::chrono::milliseconds age) {
+        auto entry = CreateLogEntry(level, content, __FILE__, __LINE__, __FUNCTION__);
+        entry.get()._timestamp -= age;
+        return entry;
+    }
+
+    size_t CountOccurrences(const std::string& content, const std::string& expected) {
+        size_t count = 0;
+        for (auto pos = content.find(expected); pos != std::string::npos; pos = content.find(expected, pos + expected.size())) {
+            ++count;
+        }
+        return count;
+    }
 
 } // anonymous
 
@@ -260,7 +276,326 @@ TEST_F(FilterTest, setFlushPolicy__force_flush) {
 }
 
 
+TEST_F(FilterTest, RepeatSuppression__disabled_by_default) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      for (int i = 0; i < 10; ++i) {
+         filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "Disk is full"));
+      }
+   } // raii
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   EXPECT_EQ(size_t{10}, CountOccurrences(content, "Disk is full")) << content;
+   EXPECT_FALSE(Exists(content, "last message repeated")) << content;
+}
+
+TEST_F(FilterTest, RepeatSuppression__repeats_are_counted) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      filterSinkPtr->setRepeatSuppression(std::chrono::seconds(60));
+      auto diskIsFull = [&] { filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "Disk is full")); };
+      for (int i = 0; i < 100; ++i) {
+         diskIsFull();
+      }
+      filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "Disk was cleaned"));
+      diskIsFull();
+      diskIsFull();
+   } // raii, the last run is summarized at exit
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   EXPECT_EQ(size_t{2}, CountOccurrences(content, "Disk is full")) << content;
+   EXPECT_TRUE(Exists(content, "last message repeated 99 times")) << content;
+   EXPECT_TRUE(Exists(content, "last message repeated 1 times")) << content;
+   EXPECT_LT(content.find("last message repeated 99 times"), content.find("Disk was cleaned")) << content;
+}
+
+TEST_F(FilterTest, RepeatSuppression__same_message_from_other_call_site_is_not_a_repeat) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      filterSinkPtr->setRepeatSuppression(std::chrono::seconds(60));
+      filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "Disk is full"));
+      filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "Disk is full"));
+   } // raii
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   EXPECT_EQ(size_t{2}, CountOccurrences(content, "Disk is full")) << content;
+   EXPECT_FALSE(Exists(content, "last message repeated")) << content;
+}
+
+TEST_F(FilterTest, RepeatSuppression__window_expires) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   filterSinkPtr->setRepeatSuppression(std::chrono::milliseconds(50));
+
+   for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 5; ++j) {
+         filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "Disk is full"));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+   }
+   filterSinkPtr->flush();
+
+   auto content = ReadContent(logfilename);
+   EXPECT_EQ(size_t{3}, CountOccurrences(content, "Disk is full")) << content;
+   EXPECT_EQ(size_t{3}, CountOccurrences(content, "last message repeated 4 times")) << content;
+}
+
+TEST_F(FilterTest, LevelSampling__keeps_about_one_in_n) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      filterSinkPtr->setFlushPolicy(0);
+      filterSinkPtr->setLevelSampling(G3LOG_DEBUG, 10);
+      for (int i = 0; i < 10000; ++i) {
+         filterSinkPtr->save(CREATE_LOG_ENTRY(G3LOG_DEBUG, "sampled debug"));
+         filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "every info"));
+      }
+   } // raii
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   auto kept = CountOccurrences(content, "sampled debug");
+   EXPECT_GT(kept, size_t{800});
+   EXPECT_LT(kept, size_t{1200});
+   EXPECT_EQ(size_t{10000}, CountOccurrences(content, "every info"));
+   EXPECT_TRUE(Exists(content, "g3sinks: dropped " + std::to_string(10000 - kept) + " DEBUG entries")) << kept;
+}
+
+TEST_F(FilterTest, LevelRateLimit__burst_then_dropped) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      filterSinkPtr->setLevelRateLimit(INFO, 1, 5); // 1 per second, bursts of 5
+      for (int i = 0; i < 100; ++i) {
+         filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "rate limited info"));
+         filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "every warning"));
+      }
+   } // raii
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   EXPECT_EQ(size_t{5}, CountOccurrences(content, "rate limited info")) << content;
+   EXPECT_EQ(size_t{100}, CountOccurrences(content, "every warning"));
+   EXPECT_TRUE(Exists(content, "g3sinks: dropped 95 INFO entries")) << content;
+}
+
+TEST_F(FilterTest, LevelRateLimit__periodic_dropped_report) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   filterSinkPtr->setLevelRateLimit(INFO, 1, 1);
+   filterSinkPtr->setDroppedReportInterval(std::chrono::milliseconds(0));
 
+   filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "rate limited info"));
+   filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "rate limited info"));
+   auto content = ReadContent(logfilename);
+   EXPECT_EQ(size_t{1}, CountOccurrences(content, "rate limited info")) << content;
+   EXPECT_TRUE(Exists(content, "g3sinks: dropped 1 INFO entries")) << content;
+}
 
+TEST_F(FilterTest, CrashRing__dumped_on_fatal) {
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      filterSinkPtr->setCrashRing({G3LOG_DEBUG}, 1024 * 1024);
+      filterSinkPtr->save(CREATE_LOG_ENTRY(G3LOG_DEBUG, "debug context 1"));
+      filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "info is written"));
+      filterSinkPtr->save(CREATE_LOG_ENTRY(G3LOG_DEBUG, "debug context 2"));
+
+      auto content = ReadContent(filterSinkPtr->logFileName());
+      EXPECT_TRUE(Exists(content, "info is written")) << content;
+      EXPECT_FALSE(Exists(content, "debug context")) << content;
+
+      filterSinkPtr->save(CREATE_LOG_ENTRY(FATAL, "fatal failure"));
+   } // raii
+
+   auto content = ReadContent(_directory + _filename + ".log");
+   EXPECT_TRUE(Exists(content, "crash ring dump of 2 entries")) << content;
+   auto first = content.find("debug context 1");
+   auto second = content.find("debug context 2");
+   auto fatal = content.find("fatal failure");
+   ASSERT_NE(std::string::npos, first) << content;
+   EXPECT_LT(content.find("info is written"), first) << content;
+   EXPECT_LT(first, second) << content;
+   EXPECT_LT(second, fatal) << content;
+}
 
+TEST_F(FilterTest, CrashRing__on_demand_dump_and_eviction) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   filterSinkPtr->setCrashRing({G3LOG_DEBUG}, 4096);
+   for (int i = 0; i < 1000; ++i) {
+      filterSinkPtr->save(CREATE_LOG_ENTRY(G3LOG_DEBUG, "debug #" + std::to_string(i) + "\n"));
+   }
+   filterSinkPtr->save(CREATE_LOG_ENTRY(WARNING, "warning does not trigger"));
+   EXPECT_FALSE(Exists(ReadContent(logfilename), "debug #"));
+
+   auto dumped = filterSinkPtr->dumpCrashRing();
+   EXPECT_GT(dumped, size_t{0});
+   EXPECT_LT(dumped, size_t{1000});
+   auto content = ReadContent(logfilename);
+   EXPECT_TRUE(Exists(content, "debug #999\n")) << content;
+   EXPECT_FALSE(Exists(content, "debug #0\n")) << content;
+   EXPECT_TRUE(Exists(content, "older entries were evicted")) << content;
+   EXPECT_EQ(size_t{0}, filterSinkPtr->dumpCrashRing());
+}
+
+TEST_F(FilterTest, Overload__disabled_by_default) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "old info", std::chrono::seconds(10)));
+
+   auto content = ReadContent(logfilename);
+   EXPECT_TRUE(Exists(content, "old info")) << content;
+   EXPECT_FALSE(Exists(content, "overload")) << content;
+   EXPECT_FALSE(filterSinkPtr->overloadStatus().overloaded);
+}
 
+TEST_F(FilterTest, Overload__drop_below_level) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   LogRotateWithFilter::OverloadPolicy policy;
+   policy.action = LogRotateWithFilter::OverloadPolicy::kDropBelowLevel;
+   policy.max_backlog = std::chrono::milliseconds(100);
+   filterSinkPtr->setOverloadPolicy(policy);
+
+   for (int i = 0; i < 10; ++i) {
+      filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued info", std::chrono::seconds(1)));
+      filterSinkPtr->save(CreateQueuedLogEntry(WARNING, "queued warning", std::chrono::seconds(1)));
+   }
+   auto status = filterSinkPtr->overloadStatus();
+   EXPECT_TRUE(status.overloaded);
+   EXPECT_EQ(uint64_t{10}, status.dropped);
+   EXPECT_GE(status.backlog, std::chrono::microseconds(std::chrono::seconds(1)));
+
+   filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "fresh info"));
+   EXPECT_FALSE(filterSinkPtr->overloadStatus().overloaded);
+
+   auto content = ReadContent(logfilename);
+   EXPECT_TRUE(Exists(content, "g3sinks: overload started")) << content;
+   EXPECT_TRUE(Exists(content, "g3sinks: overload ended, dropped 10 entries")) << content;
+   EXPECT_EQ(size_t{0}, CountOccurrences(content, "queued info")) << content;
+   EXPECT_EQ(size_t{10}, CountOccurrences(content, "queued warning")) << content;
+   EXPECT_TRUE(Exists(content, "fresh info")) << content;
+}
+
+TEST_F(FilterTest, Overload__sample) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   LogRotateWithFilter::OverloadPolicy policy;
+   policy.action = LogRotateWithFilter::OverloadPolicy::kSample;
+   policy.max_backlog = std::chrono::milliseconds(100);
+   policy.sample_one_in = 4;
+   filterSinkPtr->setOverloadPolicy(policy);
+
+   for (int i = 0; i < 100; ++i) {
+      filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued info", std::chrono::seconds(1)));
+   }
+   EXPECT_EQ(uint64_t{75}, filterSinkPtr->overloadStatus().dropped);
+   auto content = ReadContent(logfilename);
+   EXPECT_EQ(size_t{25}, CountOccurrences(content, "queued info")) << content;
+}
+
+TEST_F(FilterTest, Overload__spill_to_memory) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   LogRotateWithFilter::OverloadPolicy policy;
+   policy.action = LogRotateWithFilter::OverloadPolicy::kSpill;
+   policy.max_backlog = std::chrono::milliseconds(100);
+   filterSinkPtr->setOverloadPolicy(policy);
+
+   for (int i = 0; i < 10; ++i) {
+      filterSinkPtr->save(CreateQueuedLogEntry(INFO, "spilled #" + std::to_string(i) + "\n", std::chrono::seconds(1)));
+   }
+   auto status = filterSinkPtr->overloadStatus();
+   EXPECT_TRUE(status.overloaded);
+   EXPECT_EQ(size_t{10}, status.spilled);
+   EXPECT_FALSE(Exists(ReadContent(logfilename), "spilled #"));
+
+   filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "fresh info"));
+   auto content = ReadContent(logfilename);
+   EXPECT_TRUE(Exists(content, "wrote 10 spilled entries")) << content;
+   EXPECT_LT(content.find("spilled #0\n"), content.find("spilled #9\n")) << content;
+   EXPECT_LT(content.find("spilled #9\n"), content.find("fresh info")) << content;
+   EXPECT_EQ(size_t{0}, filterSinkPtr->overloadStatus().spilled);
+}
+
+TEST_F(FilterTest, Overload__spill_is_bounded) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   LogRotateWithFilter::OverloadPolicy policy;
+   policy.action = LogRotateWithFilter::OverloadPolicy::kSpill;
+   policy.max_backlog = std::chrono::milliseconds(100);
+   policy.spill_max_bytes = 4096;
+   filterSinkPtr->setOverloadPolicy(policy);
+
+   for (int i = 0; i < 1000; ++i) {
+      filterSinkPtr->save(CreateQueuedLogEntry(INFO, "spilled", std::chrono::seconds(1)));
+   }
+   auto status = filterSinkPtr->overloadStatus();
+   EXPECT_LT(status.spilled, size_t{1000});
+   EXPECT_EQ(uint64_t{1000} - status.spilled, status.dropped);
+}
+
+TEST_F(FilterTest, Overload__spill_never_drops_the_keep_level) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   LogRotateWithFilter::OverloadPolicy policy;
+   policy.action = LogRotateWithFilter::OverloadPolicy::kSpill;
+   policy.max_backlog = std::chrono::milliseconds(100);
+   policy.spill_max_bytes = 4096;
+   filterSinkPtr->setOverloadPolicy(policy);
+
+   for (int i = 0; i < 1000; ++i) {
+      filterSinkPtr->save(CreateQueuedLogEntry(WARNING, "kept #" + std::to_string(i) + "\n", std::chrono::seconds(1)));
+   }
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "spilled info\n", std::chrono::seconds(1)));
+   filterSinkPtr->save(CreateQueuedLogEntry(WARNING, "kept last\n", std::chrono::seconds(1)));
+   auto status = filterSinkPtr->overloadStatus();
+   EXPECT_TRUE(status.overloaded);
+   EXPECT_EQ(uint64_t{0}, status.dropped);
+   EXPECT_EQ(size_t{0}, status.spilled);
+
+   auto content = ReadContent(logfilename);
+   for (int i = 0; i < 1000; ++i) {
+      ASSERT_TRUE(Exists(content, "kept #" + std::to_string(i) + "\n")) << i;
+   }
+   EXPECT_LT(content.find("kept #999\n"), content.find("spilled info")) << content;
+   EXPECT_LT(content.find("spilled info"), content.find("kept last")) << content;
+}
+
+TEST_F(FilterTest, Latency__to_write_and_to_flush) {
+   auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+   auto logfilename = filterSinkPtr->logFileName();
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "not measured", std::chrono::seconds(5)));
+   EXPECT_EQ(uint64_t{0}, filterSinkPtr->latency().to_write.count());
+
+   filterSinkPtr->setLatencyTracking(true, std::chrono::seconds(0));
+   filterSinkPtr->setFlushPolicy(3);
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued", std::chrono::milliseconds(200)));
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued", std::chrono::milliseconds(200)));
+   auto latency = filterSinkPtr->latency();
+   EXPECT_EQ(uint64_t{2}, latency.to_write.count());
+   EXPECT_EQ(uint64_t{0}, latency.to_flush.count());  // every third entry flushes
+   EXPECT_GE(latency.to_write.percentile(50), std::chrono::milliseconds(200));
+   EXPECT_LT(latency.to_write.percentile(50), std::chrono::seconds(5));
+
+   filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued", std::chrono::milliseconds(200)));
+   latency = filterSinkPtr->latency();
+   EXPECT_EQ(uint64_t{3}, latency.to_flush.count());
+   EXPECT_GE(latency.to_flush.percentile(99), std::chrono::milliseconds(200));
+
+   filterSinkPtr->save(CREATE_LOG_ENTRY(INFO, "fresh"));
+   filterSinkPtr->flush();
+   EXPECT_EQ(uint64_t{4}, filterSinkPtr->latency().to_flush.count());
+   EXPECT_FALSE(Exists(ReadContent(logfilename), "g3sinks: latency")) << "summary interval 0 only at exit";
+}
+
+TEST_F(FilterTest, Latency__summary_is_written_in_band) {
+   std::string logfilename;
+   {
+      auto filterSinkPtr = LogRotateWithFilter::CreateLogRotateWithFilter(_filename, _directory, {});
+      logfilename = filterSinkPtr->logFileName();
+      filterSinkPtr->setLatencyTracking(true);
+      filterSinkPtr->save(CreateQueuedLogEntry(INFO, "queued", std::chrono::milliseconds(200)));
+      EXPECT_FALSE(Exists(ReadContent(logfilename), "g3sinks: latency"));
+   }
+   auto content = ReadContent(logfilename);
+   EXPECT_TRUE(Exists(content, "g3sinks: latency of 1 entries in the last")) << content;
+   EXPECT_TRUE(Exists(content, ", to write p50 ")) << content;
+   EXPECT_TRUE(Exists(content, ", to flush p50 ")) << content;
+}
@@ -0,0 +1,137 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <g3log/logmessage.hpp>
+#include <g3sinks/journaldsink.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <syslog.h>
+#include "SocketTestHelper.h"
+
+using namespace SocketTestHelper;
+
+namespace {
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, std::string content) {
+      g3::LogMessage message("journal/test.cpp", 42, "someFunction", level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+
+   /// Parses the journal native protocol, both NAME=value and the binary safe form
+   std::map<std::string, std::string> ParseFields(const std::string& entry) {
+      std::map<std::string, std::string> fields;
+      size_t position = 0;
+      while (position < entry.size()) {
+         auto end = entry.find('\n', position);
+         auto equal = entry.find('=', position);
+         if (end == std::string::npos) {
+            break;
+         }
+         if (equal != std::string::npos && equal < end) {
+            fields[entry.substr(position, equal - position)] = entry.substr(equal + 1, end - equal - 1);
+            position = end + 1;
+            continue;
+         }
+         std::string name = entry.substr(position, end - position);
+         uint64_t size = 0;
+         for (int byte = 0; byte < 8; ++byte) {
+            size |= uint64_t{static_cast<unsigned char>(entry[end + 1 + byte])} << (8 * byte);
+         }
+         fields[name] = entry.substr(end + 9, size);
+         position = end + 9 + size + 1;
+      }
+      return fields;
+   }
+} // anonymous
+
+TEST(JournaldSinkTest, Fields) {
+   DatagramServer journald(UniqueSocketPath("g3sinks_journald"));
+   g3::JournaldSink sink("myapp", journald.path());
+   ASSERT_TRUE(sink.isConnected());
+
+   sink.journal(CreateLogEntry(WARNING, "Hello journal"));
+   auto entries = journald.receive(1);
+   ASSERT_EQ(size_t{1}, entries.size());
+
+   auto fields = ParseFields(entries[0]);
+   EXPECT_EQ("Hello journal", fields["MESSAGE"]);
+   EXPECT_EQ(std::to_string(LOG_WARNING), fields["PRIORITY"]);
+   EXPECT_EQ("journal/test.cpp", fields["CODE_FILE"]);
+   EXPECT_EQ("42", fields["CODE_LINE"]);
+   EXPECT_EQ("someFunction", fields["CODE_FUNC"]);
+   EXPECT_FALSE(fields["TID"].empty());
+   EXPECT_EQ("myapp", fields["SYSLOG_IDENTIFIER"]);
+   EXPECT_EQ("1", fields["SYSLOG_FACILITY"]);
+   EXPECT_EQ("WARNING", fields["G3LOG_LEVEL"]);
+}
+
+TEST(JournaldSinkTest, LevelMapping) {
+   DatagramServer journald(UniqueSocketPath("g3sinks_journald"));
+   g3::JournaldSink sink("myapp", journald.path());
+   const LEVELS NOTICE{(INFO.value + WARNING.value) / 2, {"NOTICE"}};
+
+   sink.journal(CreateLogEntry(G3LOG_DEBUG, "debug"));
+   sink.journal(CreateLogEntry(INFO, "info"));
+   sink.journal(CreateLogEntry(NOTICE, "notice"));
+   sink.journal(CreateLogEntry(FATAL, "fatal"));
+   auto entries = journald.receive(4);
+   ASSERT_EQ(size_t{4}, entries.size());
+   EXPECT_EQ(std::to_string(LOG_DEBUG), ParseFields(entries[0])["PRIORITY"]);
+   EXPECT_EQ(std::to_string(LOG_INFO), ParseFields(entries[1])["PRIORITY"]);
+   EXPECT_EQ(std::to_string(LOG_NOTICE), ParseFields(entries[2])["PRIORITY"]);
+   EXPECT_EQ(std::to_string(LOG_CRIT), ParseFields(entries[3])["PRIORITY"]);
+}
+
+TEST(JournaldSinkTest, MultiLineMessage) {
+   DatagramServer journald(UniqueSocketPath("g3sinks_journald"));
+   g3::JournaldSink sink("myapp", journald.path());
+
+   sink.journal(CreateLogEntry(INFO, "first line\nsecond line=2\n"));
+   auto entries = journald.receive(1);
+   ASSERT_EQ(size_t{1}, entries.size());
+   EXPECT_NE(std::string::npos, entries[0].find("MESSAGE\n"));
+   auto fields = ParseFields(entries[0]);
+   EXPECT_EQ("first line\nsecond line=2", fields["MESSAGE"]);
+   EXPECT_EQ("42", fields["CODE_LINE"]);
+}
+
+TEST(JournaldSinkTest, LargeEntryIsSentAsMemfd) {
+   DatagramServer journald(UniqueSocketPath("g3sinks_journald"));
+   g3::JournaldSink sink("myapp", journald.path());
+
+   std::string large(2 * 1024 * 1024, 'x');
+   sink.journal(CreateLogEntry(INFO, large));
+   auto entries = journald.receive(1);
+   ASSERT_EQ(size_t{1}, entries.size());
+   auto fields = ParseFields(entries[0]);
+   EXPECT_EQ(large, fields["MESSAGE"]);
+   EXPECT_EQ("someFunction", fields["CODE_FUNC"]);
+   EXPECT_EQ(uint64_t{0}, sink.dropped());
+}
+
+TEST(JournaldSinkTest, Formatter) {
+   DatagramServer journald(UniqueSocketPath("g3sinks_journald"));
+   g3::JournaldSink sink("myapp", journald.path());
+   sink.setFormatter([](const g3::LogMessage& message) { return message.level() + ": "; });
+
+   sink.journal(CreateLogEntry(INFO, "formatted"));
+   auto entries = journald.receive(1);
+   ASSERT_EQ(size_t{1}, entries.size());
+   EXPECT_EQ("INFO: formatted", ParseFields(entries[0])["MESSAGE"]);
+}
+
+TEST(JournaldSinkTest, MissingJournalIsNotAnError) {
+   g3::JournaldSink sink("myapp", UniqueSocketPath("g3sinks_no_journald"));
+   EXPECT_FALSE(sink.isConnected());
+   sink.journal(CreateLogEntry(INFO, "nobody is listening"));
+   EXPECT_EQ(uint64_t{1}, sink.dropped());
+}
@@ -0,0 +1,208 @@
+/** ==========================================================================
+ * 2026 by KjellKod.cc
+ *
+ * This code is PUBLIC DOMAIN to use at your own risk and comes
+ * with no warranties. This code is yours to share, use and modify with no
+ * strings attached and no restrictions or obligations.
+ * ============================================================================*
+ * PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+ * ********************************************* */
+
+#include "RotateFileTest.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <g3log/logmessage.hpp>
+#include "g3sinks/LogFileReader.h"
+#include "g3sinks/LogRotate.h"
+#include "g3sinks/LogRotateUtility.h"
+#include "g3sinks/SeekableGzip.h"
+
+namespace {
+   std::string Formatted(const LEVELS& level, const std::string& text) {
+      g3::LogMessage message("ReaderTest.cpp", 42, "replay", level);
+      message.write().append(text);
+      return message.toString();
+   }
+
+   std::chrono::system_clock::time_point LocalTime(int hour, int minute, int second) {
+      struct tm tm = {};
+      tm.tm_year = 2026 - 1900;
+      tm.tm_mon = 9;
+      tm.tm_mday = 18;
+      tm.tm_hour = hour;
+      tm.tm_min = minute;
+      tm.tm_sec = second;
+      tm.tm_isdst = -1;
+      return std::chrono::system_clock::from_time_t(mktime(&tm));
+   }
+
+   /// An entry a second from 12:00:00, every 10th with a continuation line
+   std::string TimedEntry(int index) {
+      char timestamp[32];
+      std::snprintf(timestamp, sizeof(timestamp), "2026/10/18 12:%02d:%02d 000000", index / 60, index % 60);
+      std::string entry = std::string(timestamp) + "\tINFO [Seek.cpp->test:1]\tentry " + std::to_string(index) + " with some padding\n";
+      if (0 == index % 10) {
+         entry += "   at continuation()\n";
+      }
+      return entry;
+   }
+} // anonymous
+
+TEST(LogFileParser, DefaultAndFullDetails) {
+   LogFileEntry entry;
+   ASSERT_TRUE(LogFileParser::parseLine("2026/10/18 12:34:56 123456\tWARNING [Server.cpp->handle:77]\tdisk is slow\n", entry));
+   EXPECT_EQ("WARNING", entry.level);
+   EXPECT_EQ("", entry.thread);
+   EXPECT_EQ("Server.cpp", entry.file);
+   EXPECT_EQ("handle", entry.function);
+   EXPECT_EQ(77, entry.line);
+   EXPECT_EQ("disk is slow", entry.message);
+
+   struct tm tm = {};
+   tm.tm_year = 2026 - 1900;
+   tm.tm_mon = 9;
+   tm.tm_mday = 18;
+   tm.tm_hour = 12;
+   tm.tm_min = 34;
+   tm.tm_sec = 56;
+   tm.tm_isdst = -1;
+   auto expected = std::chrono::system_clock::from_time_t(mktime(&tm)) + std::chrono::microseconds(123456);
+   EXPECT_EQ(expected, entry.timestamp);
+
+   ASSERT_TRUE(LogFileParser::parseLine("2026/10/18 12:34:56 5\tINFO [140245 Server.cpp->void Server::run(int):9]\tstarted", entry));
+   EXPECT_EQ("INFO", entry.level);
+   EXPECT_EQ("140245", entry.thread);
+   EXPECT_EQ("Server.cpp", entry.file);
+   EXPECT_EQ("void Server::run(int)", entry.function);
+   EXPECT_EQ(9, entry.line);
+   EXPECT_EQ("started", entry.message);
+   EXPECT_EQ(std::chrono::system_clock::from_time_t(mktime(&tm)) + std::chrono::milliseconds(500), entry.timestamp);
+
+   EXPECT_FALSE(LogFileParser::parseLine("g3log: created log file at: Sun Oct 18 12:34:56 2026\n", entry));
+   EXPECT_FALSE(LogFileParser::parseLine("   at Server::run() Server.cpp:9\n", entry));
+   EXPECT_FALSE(LogFileParser::parseLine("2026/10/18 12:34", entry));
+   EXPECT_EQ("started", entry.message) << "a failed parse leaves the entry as it was";
+}
+
+TEST_F(RotateFileTest, LogFileReaderReadsTheArchivesAndTheLog) {
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.save(Formatted(INFO, "first"));
+      logrotate.save(Formatted(WARNING, "stack trace\n   at a()\n   at b()"));
+      ASSERT_TRUE(logrotate.rotateLog());
+      logrotate.save(Formatted(G3LOG_DEBUG, "after the rotation"));
+   }
+
+   auto files = LogRotateUtility::getLogFileSet(_directory, _filename);
+   ASSERT_EQ(2u, files.size());
+   EXPECT_NE(std::string::npos, files[0].find(".gz"));
+   EXPECT_EQ(_directory + _filename + ".log", files[1]);
+
+   std::vector<LogFileEntry> entries;
+   uint64_t skipped = 0;
+   for (auto& file : files) {
+      LogFileReader reader(file);
+      ASSERT_TRUE(reader.isOpen()) << file;
+      LogFileEntry entry;
+      while (reader.next(entry)) {
+         entries.push_back(entry);
+      }
+      skipped += reader.skippedLines();
+   }
+   ASSERT_EQ(3u, entries.size());
+   EXPECT_LT(0u, skipped) << "the file headers are not entries";
+
+   EXPECT_EQ("INFO", entries[0].level);
+   EXPECT_EQ("first", entries[0].message);
+   EXPECT_EQ("ReaderTest.cpp", entries[0].file);
+   EXPECT_EQ(42, entries[0].line);
+
+   EXPECT_EQ("WARNING", entries[1].level);
+   EXPECT_EQ("stack trace\n   at a()\n   at b()", entries[1].message);
+   EXPECT_EQ(entries[0].line_number + 1, entries[1].line_number);
+   EXPECT_EQ(entries[0].offset + entries[0].size, entries[1].offset);
+
+   EXPECT_EQ(G3LOG_DEBUG.text, entries[2].level);
+   EXPECT_EQ("after the rotation", entries[2].message);
+   EXPECT_LE(entries[0].timestamp, entries[2].timestamp);
+}
+
+TEST_F(RotateFileTest, SeekableArchiveIsReadFromATime) {
+   const int kEntries = 600;
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveSyncPoints(0, std::chrono::seconds(60));
+      for (int i = 0; i < kEntries; ++i) {
+         logrotate.save(TimedEntry(i));
+      }
+      ASSERT_TRUE(logrotate.rotateLog());
+   }
+   auto files = LogRotateUtility::getLogFileSet(_directory, _filename);
+   ASSERT_LE(1u, files.size());
+   const std::string archive = files[0];
+   _filesToRemove.push_back(SeekableGzip::indexFileName(archive));
+
+   std::vector<LogFileEntry> all; // still one gzip stream, read from the start
+   LogFileReader sequential(archive);
+   LogFileEntry entry;
+   while (sequential.next(entry)) {
+      all.push_back(entry);
+   }
+   ASSERT_EQ(static_cast<size_t>(kEntries), all.size());
+
+   auto points = SeekableGzip::readIndex(SeekableGzip::indexFileName(archive));
+   ASSERT_EQ(9u, points.size()) << "a sync point every minute of log time";
+   EXPECT_EQ(LocalTime(12, 1, 0), points[0].timestamp);
+   EXPECT_EQ(all[60].offset, points[0].uncompressed_offset);
+   EXPECT_EQ(all[60].line_number, points[0].line_number);
+   EXPECT_EQ(LocalTime(12, 5, 0), SeekableGzip::findPoint(points, LocalTime(12, 5, 30))->timestamp);
+   EXPECT_EQ(nullptr, SeekableGzip::findPoint(points, LocalTime(12, 0, 30)));
+
+   LogFileReader reader(archive);
+   std::vector<LogFileEntry> range;
+   auto passed = reader.readRange(LocalTime(12, 5, 30), LocalTime(12, 6, 10), [&](const LogFileEntry& found) {
+      range.push_back(found);
+      return true;
+   });
+   ASSERT_EQ(40u, passed);
+   ASSERT_EQ(40u, range.size());
+   EXPECT_EQ("entry 330 with some padding\n   at continuation()", range[0].message);
+   EXPECT_EQ(all[330].offset, range[0].offset);
+   EXPECT_EQ(all[330].line_number, range[0].line_number);
+   EXPECT_EQ("entry 369 with some padding", range.back().message);
+   EXPECT_EQ(all[369].offset, range.back().offset);
+}
+
+TEST_F(RotateFileTest, SeekableArchiveSyncPointsBySize) {
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveSyncPoints(4096, std::chrono::seconds(0));
+      for (int i = 0; i < 600; ++i) {
+         logrotate.save(TimedEntry(i));
+      }
+      ASSERT_TRUE(logrotate.rotateLog());
+   }
+   const std::string archive = LogRotateUtility::getLogFileSet(_directory, _filename)[0];
+   _filesToRemove.push_back(SeekableGzip::indexFileName(archive));
+   auto points = SeekableGzip::readIndex(SeekableGzip::indexFileName(archive));
+   ASSERT_LT(5u, points.size());
+   for (size_t i = 1; i < points.size(); ++i) {
+      EXPECT_LE(4096u, points[i].uncompressed_offset - points[i - 1].uncompressed_offset);
+      EXPECT_GT(4096u + 128, points[i].uncompressed_offset - points[i - 1].uncompressed_offset) << "at the next entry";
+      EXPECT_LT(points[i - 1].compressed_offset, points[i].compressed_offset);
+   }
+
+   // from the last sync point to the end of the archive
+   LogFileReader reader(archive);
+   ASSERT_TRUE(reader.seek(points.back().timestamp));
+   LogFileEntry entry;
+   uint64_t entries = 0;
+   while (reader.next(entry)) {
+      ++entries;
+   }
+   EXPECT_LT(0u, entries);
+   EXPECT_EQ("entry 599 with some padding", entry.message);
+}
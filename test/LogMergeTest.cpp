@@ -0,0 +1,187 @@
+/** ==========================================================================
+ * 2026 by KjellKod.cc
+ *
+ * This code is PUBLIC DOMAIN to use at your own risk and comes
+ * with no warranties. This code is yours to share, use and modify with no
+ * strings attached and no restrictions or obligations.
+ * ============================================================================*
+ * PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+ * ********************************************* */
+
+#include "RotateFileTest.h"
+#include "RotateTestHelper.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "g3sinks/LogMerge.h"
+#include "g3sinks/LogQuery.h"
+#include "g3sinks/LogRotate.h"
+
+using RotateTestHelper::EntryAt;
+
+TEST_F(RotateFileTest, LogMergerMergesTheSourcesInTimeOrder) {
+   const std::string other = _filename + "_other";
+   _filesToRemove.push_back(_directory + other + ".log");
+   const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::seconds(1000);
+   {
+      // the first source has the even seconds, in an archive and its log, the other the odd ones
+      LogRotate first(_filename, _directory);
+      LogRotate second(other, _directory);
+      for (int i = 0; i < 80; ++i) {
+         if (40 == i) {
+            ASSERT_TRUE(first.rotateLog());
+         }
+         LogRotate& logrotate = (0 == i % 2) ? first : second;
+         logrotate.save(EntryAt(base + std::chrono::seconds(i), "INFO", "request " + std::to_string(i)));
+      }
+   }
+
+   LogMergeOptions options;
+   LogMerger merger({{_directory, _filename}, {_directory, other}}, options);
+   LogFileEntry entry;
+   size_t source = 0;
+   int expected = 0;
+   while (merger.next(entry, source)) {
+      EXPECT_EQ("request " + std::to_string(expected), entry.message);
+      EXPECT_EQ(static_cast<size_t>(expected % 2), source);
+      ++expected;
+   }
+   EXPECT_EQ(80, expected);
+
+   options.from = base + std::chrono::seconds(55);
+   LogMerger from({{_directory, _filename}, {_directory, other}}, options);
+   ASSERT_TRUE(from.next(entry, source));
+   EXPECT_EQ("request 55", entry.message);
+}
+
+TEST_F(RotateFileTest, LogMergerSkipsAnArchiveThatIsGone) {
+   const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::seconds(1000);
+   {
+      LogRotate logrotate(_filename, _directory);
+      for (int i = 0; i < 30; ++i) {
+         if (10 == i || 20 == i) {
+            ASSERT_TRUE(logrotate.rotateLog());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // the archives are named by the second
+         }
+         logrotate.save(EntryAt(base + std::chrono::seconds(i), "INFO", "request " + std::to_string(i)));
+      }
+   }
+   auto files = LogQueryEngine::logFiles(_directory, _filename);
+   ASSERT_EQ(3u, files.size());
+
+   // the second archive expires after the merger listed the files
+   LogMerger merger({{_directory, _filename}}, LogMergeOptions());
+   ASSERT_EQ(0, std::remove(files[1].path.c_str()));
+   std::vector<std::string> messages;
+   LogFileEntry entry;
+   size_t source = 0;
+   while (merger.next(entry, source)) {
+      messages.push_back(entry.message);
+   }
+   ASSERT_EQ(20u, messages.size());
+   EXPECT_EQ("request 9", messages[9]);
+   EXPECT_EQ("request 20", messages[10]);
+   EXPECT_EQ("request 29", messages[19]);
+}
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+TEST_F(RotateFileTest, LogMergerFollowsTheLogsThroughARotation) {
+   const std::string other = _filename + "_other";
+   _filesToRemove.push_back(_directory + other + ".log");
+   LogMergeOptions options;
+   options.follow = true;
+   options.follow_delay = std::chrono::milliseconds(100);
+   options.poll_interval = std::chrono::milliseconds(20);
+   LogMerger merger({{_directory, _filename}, {_directory, other}}, options);
+
+   // the other source has no log yet: the entries of the first are held back for the follow delay
+   std::thread writer([&] {
+      LogRotate first(_filename, _directory);
+      first.setFlushPolicy(1);
+      for (int i = 0; i < 10; ++i) {
+         if (5 == i) {
+            first.rotateLog();
+         }
+         first.save(EntryAt(std::chrono::system_clock::now(), "INFO", "first " + std::to_string(i)));
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      LogRotate second(other, _directory);
+      second.setFlushPolicy(1);
+      second.save(EntryAt(std::chrono::system_clock::now(), "INFO", "second 0"));
+   });
+
+   std::vector<std::string> messages;
+   std::vector<std::chrono::system_clock::time_point> timestamps;
+   std::atomic<bool> done{false};
+   std::thread stopper([&] {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (!done && std::chrono::steady_clock::now() < deadline) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      merger.stop();
+   });
+   LogFileEntry entry;
+   size_t source = 0;
+   while (messages.size() < 11 && merger.next(entry, source)) {
+      messages.push_back(entry.message);
+      timestamps.push_back(entry.timestamp);
+   }
+   done = true;
+   stopper.join();
+   writer.join();
+
+   ASSERT_EQ(11u, messages.size());
+   for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ("first " + std::to_string(i), messages[i]);
+   }
+   EXPECT_EQ("second 0", messages[10]);
+   EXPECT_TRUE(std::is_sorted(timestamps.begin(), timestamps.end()));
+}
+
+TEST_F(RotateFileTest, LogMergerWaitsForTheRestOfAStackTrace) {
+   LogMergeOptions options;
+   options.follow = true;
+   options.follow_delay = std::chrono::milliseconds(300);
+   options.poll_interval = std::chrono::milliseconds(20);
+   LogMerger merger({{_directory, _filename}}, options);
+
+   // the stack trace is flushed in two writes, as LogRotate's buffered stream can do
+   std::thread writer([&] {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setFlushPolicy(1);
+      std::string crash = EntryAt(std::chrono::system_clock::now(), "FATAL", "crashed");
+      logrotate.save(crash + "   frame 1\n");
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      logrotate.save("   frame 2\n   frame 3\n");
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      logrotate.save(EntryAt(std::chrono::system_clock::now(), "INFO", "after the crash"));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+   });
+
+   std::vector<std::string> messages;
+   std::atomic<bool> done{false};
+   std::thread stopper([&] {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (!done && std::chrono::steady_clock::now() < deadline) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      merger.stop();
+   });
+   LogFileEntry entry;
+   size_t source = 0;
+   while (messages.size() < 2 && merger.next(entry, source)) {
+      messages.push_back(entry.message);
+   }
+   done = true;
+   stopper.join();
+   writer.join();
+
+   ASSERT_EQ(2u, messages.size());
+   EXPECT_EQ("crashed\n   frame 1\n   frame 2\n   frame 3", messages[0]);
+   EXPECT_EQ("after the crash", messages[1]) << "the last entry is read when nothing is added to it";
+}
+#endif
@@ -0,0 +1,186 @@
+/** ==========================================================================
+ * 2026 by KjellKod.cc
+ *
+ * This code is PUBLIC DOMAIN to use at your own risk and comes
+ * with no warranties. This code is yours to share, use and modify with no
+ * strings attached and no restrictions or obligations.
+ * ============================================================================*
+ * PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+ * ********************************************* */
+
+#include "RotateFileTest.h"
+#include "RotateTestHelper.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "g3sinks/LogQuery.h"
+#include "g3sinks/LogRotate.h"
+#include "g3sinks/SubstringScanner.h"
+#include "g3sinks/TokenBloomFilter.h"
+
+namespace {
+   std::string Lower(std::string text) {
+      std::transform(text.begin(), text.end(), text.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; });
+      return text;
+   }
+
+   std::string RandomText(std::mt19937& random, size_t size) {
+      static const char kAlphabet[] = "abAB-";
+      std::string text;
+      for (size_t i = 0; i < size; ++i) {
+         text.push_back(kAlphabet[random() % (sizeof(kAlphabet) - 1)]);
+      }
+      return text;
+   }
+} // anonymous
+
+using RotateTestHelper::EntryAt;
+
+TEST(SubstringScanner, FindsWhatStdFindFinds) {
+   std::mt19937 random(42);
+   for (int round = 0; round < 20000; ++round) {
+      std::string text = RandomText(random, random() % 80);
+      std::string needle = RandomText(random, 1 + random() % 6);
+      EXPECT_EQ(text.find(needle), SubstringScanner(needle).find(text.data(), text.size())) << text << " / " << needle;
+      EXPECT_EQ(Lower(text).find(Lower(needle)), SubstringScanner(needle, true).find(text.data(), text.size())) << text << " / " << needle;
+   }
+   SubstringScanner scanner("needle at the end");
+   std::string haystack(1000, 'x');
+   EXPECT_FALSE(scanner.contains(haystack));
+   haystack += "needle at the end";
+   EXPECT_EQ(1000u, scanner.find(haystack.data(), haystack.size()));
+   EXPECT_EQ(0u, SubstringScanner("").find("abc", 3));
+}
+
+TEST_F(RotateFileTest, LogQueryMergesTheFilesInTimeOrder) {
+   const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::seconds(1000);
+   auto level = [](int i) { return (0 == i % 3) ? "WARNING" : "INFO"; };
+   {
+      // the archive has the even entries, the log the odd ones: the files overlap in time
+      LogRotate logrotate(_filename, _directory);
+      for (int i = 0; i < 100; i += 2) {
+         logrotate.save(EntryAt(base + std::chrono::seconds(i), level(i), "request " + std::to_string(i)));
+      }
+      ASSERT_TRUE(logrotate.rotateLog());
+      for (int i = 1; i < 100; i += 2) {
+         logrotate.save(EntryAt(base + std::chrono::seconds(i), level(i), "request " + std::to_string(i)));
+      }
+   }
+   auto files = LogQueryEngine::logFiles(_directory, _filename);
+   ASSERT_EQ(2u, files.size());
+
+   LogQuery all;
+   all.threads = 2;
+   std::vector<std::string> messages;
+   auto stats = LogQueryEngine::searchDirectory(_directory, _filename, all, [&](const std::string&, const LogFileEntry& entry) {
+      messages.push_back(entry.message);
+      return true;
+   });
+   EXPECT_EQ(2u, stats.files);
+   EXPECT_EQ(100u, stats.entries);
+   EXPECT_EQ(100u, stats.matches);
+   ASSERT_EQ(100u, messages.size());
+   for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ("request " + std::to_string(i), messages[i]);
+   }
+
+   // the files overlap in time, which the times of the rotations do not tell
+   for (auto& file : files) {
+      file.oldest = std::chrono::system_clock::time_point::min();
+      file.newest = std::chrono::system_clock::time_point::max();
+   }
+   LogQuery query;
+   query.text = "REQUEST 1";
+   query.ignore_case = true;
+   query.levels = {"WARNING"};
+   query.from = base + std::chrono::seconds(10);
+   query.to = base + std::chrono::seconds(20);
+   messages.clear();
+   stats = LogQueryEngine::search(files, query, [&](const std::string&, const LogFileEntry& entry) {
+      messages.push_back(entry.message);
+      return true;
+   });
+   EXPECT_EQ(10u, stats.entries) << "only the entries in the time range are read";
+   EXPECT_EQ((std::vector<std::string>{"request 12", "request 15", "request 18"}), messages);
+
+   // the log was started at the rotation, after the end of the time range
+   stats = LogQueryEngine::searchDirectory(_directory, _filename, query, [](const std::string&, const LogFileEntry&) { return true; });
+   EXPECT_EQ(1u, stats.skipped_by_time);
+   EXPECT_EQ(5u, stats.entries);
+}
+
+TEST_F(RotateFileTest, LogQueryStreamsMoreMatchesThanAreQueued) {
+   const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::seconds(100000);
+   const int kEntries = 9000;
+   {
+      // three files, each with more matches than are read ahead of the merge
+      LogRotate logrotate(_filename, _directory);
+      for (int i = 0; i < kEntries; ++i) {
+         if (i > 0 && 0 == i % 3000) {
+            ASSERT_TRUE(logrotate.rotateLog());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // the archives are named by the second
+         }
+         logrotate.save(EntryAt(base + std::chrono::seconds(i), "INFO", "request " + std::to_string(i)));
+      }
+   }
+   auto files = LogQueryEngine::logFiles(_directory, _filename);
+   ASSERT_EQ(3u, files.size());
+
+   LogQuery query;
+   query.threads = 1; // the merge reads the files the worker does not get to
+   int expected = 0;
+   auto stats = LogQueryEngine::search(files, query, [&](const std::string&, const LogFileEntry& entry) {
+      EXPECT_EQ("request " + std::to_string(expected), entry.message);
+      ++expected;
+      return true;
+   });
+   EXPECT_EQ(kEntries, expected);
+   EXPECT_EQ(static_cast<uint64_t>(kEntries), stats.matches);
+
+   query.threads = 3;
+   int calls = 0;
+   stats = LogQueryEngine::search(files, query, [&](const std::string&, const LogFileEntry&) { return ++calls < 10; });
+   EXPECT_EQ(10, calls);
+   EXPECT_LT(stats.matches, static_cast<uint64_t>(kEntries)) << "the search stops with the callback";
+}
+
+TEST_F(RotateFileTest, LogQueryWithWholeWordsSkipsArchivesByTheirFilter) {
+   const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::seconds(1000);
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveBloomFilter(true);
+      for (int archive = 0; archive < 2; ++archive) {
+         for (int i = 0; i < 100; ++i) {
+            int id = 7000000 + archive * 100 + i;
+            logrotate.save(EntryAt(base + std::chrono::seconds(id - 7000000), "INFO", "handled req-" + std::to_string(id)));
+         }
+         ASSERT_TRUE(logrotate.rotateLog());
+         std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // the archives are named by the second
+      }
+      logrotate.save(EntryAt(base + std::chrono::seconds(200), "INFO", "handled req-7000150x"));
+   }
+   for (auto& file : LogQueryEngine::logFiles(_directory, _filename)) {
+      _filesToRemove.push_back(ArchiveBloomFilter::filterFileName(file.path));
+   }
+
+   LogQuery query;
+   query.text = "req-7000150";
+   std::vector<std::string> messages;
+   auto collect = [&](const std::string&, const LogFileEntry& entry) {
+      messages.push_back(entry.message);
+      return true;
+   };
+   auto stats = LogQueryEngine::searchDirectory(_directory, _filename, query, collect);
+   EXPECT_EQ(0u, stats.skipped_by_filter) << "a substring can be part of longer words in any archive";
+   EXPECT_EQ((std::vector<std::string>{"handled req-7000150", "handled req-7000150x"}), messages);
+
+   query.whole_words = true;
+   messages.clear();
+   stats = LogQueryEngine::searchDirectory(_directory, _filename, query, collect);
+   EXPECT_EQ(3u, stats.files);
+   EXPECT_EQ(1u, stats.skipped_by_filter);
+   EXPECT_EQ((std::vector<std::string>{"handled req-7000150"}), messages);
+}
@@ -303,4 +303,72 @@ TEST_F(RotateFileTest, rotateLog) {
    logrotate.save("test3");
    auto allFiles = LogRotateUtility::getLogFilesInDirectory(_directory, app_name);
    EXPECT_EQ(allFiles.size(), size_t{1});
-}
\ No newline at end of file
+}
+
+TEST_F(RotateFileTest, statsCountWritesAndRotations) {
+   LogRotate logrotate(_filename, _directory);
+   auto start = logrotate.stats();
+   logrotate.save("test1\n");
+   logrotate.save("test2\n");
+   auto stats = logrotate.stats();
+   EXPECT_EQ(start.records_written + 2, stats.records_written);
+   EXPECT_EQ(start.bytes_written + 12, stats.bytes_written);
+   EXPECT_EQ(start.write_latency.count() + 2, stats.write_latency.count());
+   EXPECT_LE(start.flushes + 2, stats.flushes);  // default flush policy is every entry
+   EXPECT_EQ(uint64_t{0}, stats.rotations);
+
+   for (int i = 0; i < 100; ++i) {
+      logrotate.save("the same line is compressed well\n");
+   }
+   ASSERT_TRUE(logrotate.rotateLog());
+   stats = logrotate.stats();
+   EXPECT_EQ(uint64_t{1}, stats.rotations);
+   EXPECT_GT(stats.compressed_input_bytes, stats.compressed_output_bytes);
+   EXPECT_GT(stats.compression_ratio, 1.0);
+   EXPECT_GT(stats.total_compress_duration.count(), 0);
+   EXPECT_EQ(uint64_t{0}, stats.fsyncs) << "no fsync on the sink thread unless asked for";
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+   logrotate.setArchiveSync(true);
+   logrotate.save("synced\n");
+   ASSERT_TRUE(logrotate.rotateLog());
+   EXPECT_EQ(uint64_t{1}, logrotate.stats().fsyncs);
+#endif
+}
+
+TEST_F(RotateFileTest, statsDumpAsPrometheusText) {
+   auto dump = _directory + _filename + ".prom";
+   _filesToRemove.push_back(dump);
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setStatsDump(dump, std::chrono::seconds(3600));
+      logrotate.save("test1\n");
+      auto content = ReadContent(dump);
+      EXPECT_TRUE(Exists(content, "g3sinks_logrotate_records_written_total{log=\"" + _filename + "\"} 1\n")) << content;
+      EXPECT_TRUE(Exists(content, "# TYPE g3sinks_logrotate_write_latency_seconds histogram")) << content;
+      EXPECT_TRUE(Exists(content, "g3sinks_logrotate_write_latency_seconds_count{log=\"" + _filename + "\"} 1\n")) << content;
+
+      logrotate.save("test2\n");  // within the interval, not dumped
+      EXPECT_EQ(content, ReadContent(dump));
+   }
+   // the last numbers are written at exit
+   auto content = ReadContent(dump);
+   EXPECT_TRUE(Exists(content, "g3sinks_logrotate_records_written_total{log=\"" + _filename + "\"} 2\n")) << content;
+}
+
+TEST(LatencyHistogramTest, percentilesAreWithinOneBucket) {
+   LatencyHistogram histogram;
+   EXPECT_EQ(0, histogram.percentile(99).count());
+   for (int i = 1; i <= 1000; ++i) {
+      histogram.record(std::chrono::microseconds(i));
+   }
+   EXPECT_EQ(uint64_t{1000}, histogram.count());
+   EXPECT_EQ(std::chrono::nanoseconds(std::chrono::microseconds(1000)), histogram.max());
+   auto p50 = std::chrono::duration_cast<std::chrono::microseconds>(histogram.percentile(50)).count();
+   auto p99 = std::chrono::duration_cast<std::chrono::microseconds>(histogram.percentile(99)).count();
+   EXPECT_GE(p50, 500);
+   EXPECT_LE(p50, 500 + 500 / 8);
+   EXPECT_GE(p99, 990);
+   EXPECT_LE(p99, 1000);
+   EXPECT_EQ(uint64_t{0}, histogram.countAtOrBelow(std::chrono::nanoseconds(999)));
+   EXPECT_EQ(uint64_t{1000}, histogram.countAtOrBelow(std::chrono::seconds(1)));
+}
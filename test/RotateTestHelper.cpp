@@ -16,6 +16,7 @@
 #include <sstream>
 #include <string>
 #include <cerrno>
+#include <ctime>
 
 #if (defined(WIN32) || defined(_WIN32) || defined(__WIN32__)) && !defined(__MINGW32__)
 #include  <io.h>
@@ -71,4 +72,17 @@ namespace RotateTestHelper {
       return found;
    }
 
+
+   std::string EntryAt(std::chrono::system_clock::time_point time, const std::string& level, const std::string& message) {
+      time_t seconds = std::chrono::system_clock::to_time_t(time);
+      struct tm local = {};
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+      localtime_s(&local, &seconds);
+#else
+      localtime_r(&seconds, &local);
+#endif
+      char timestamp[32];
+      std::strftime(timestamp, sizeof(timestamp), "%Y/%m/%d %H:%M:%S", &local);
+      return std::string(timestamp) + " 000000\t" + level + " [Test.cpp->handle:7]\t" + message + "\n";
+   }
 } // RotateTestHelper
@@ -11,6 +11,7 @@
 #pragma once 
 
 
+#include <chrono>
 #include <string>
 #include <map>
 
@@ -19,4 +20,6 @@ namespace RotateTestHelper {
   std::string ExtractContent(const std::map<long, std::string>& content);
   bool Exists(const std::string content, const std::string expected);
   bool DoesFileEntityExist(const std::string& pathToFile);
+  /// An entry at @param time, in the format of g3log's DefaultLogDetailsToString
+  std::string EntryAt(std::chrono::system_clock::time_point time, const std::string& level, const std::string& message);
 }
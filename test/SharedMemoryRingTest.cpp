@@ -0,0 +1,253 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <g3log/logmessage.hpp>
+#include <g3sinks/LogRotate.h>
+#include <g3sinks/SharedMemoryCollector.h>
+#include <g3sinks/SharedMemoryRing.h>
+#include <g3sinks/SharedMemorySink.h>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "RotateTestHelper.h"
+
+namespace {
+   std::vector<std::string> DrainAll(g3::SharedMemoryRing& ring) {
+      std::vector<std::string> records;
+      while (ring.drain([&records](const char* data, size_t size) { records.emplace_back(data, size); }) > 0) {
+      }
+      return records;
+   }
+
+   std::string UniqueRingName(const std::string& name) {
+      return name + "_" + std::to_string(getpid());
+   }
+} // anonymous
+
+TEST(SharedMemoryRingTest, PushAndDrainInOrder) {
+   auto ring = g3::SharedMemoryRing::CreateMemfd(8, 64);
+   ASSERT_TRUE(ring);
+   EXPECT_TRUE(ring->empty());
+   for (int i = 0; i < 20; ++i) {
+      EXPECT_TRUE(ring->push("record " + std::to_string(i)));
+      if (i % 3 == 0) {
+         auto records = DrainAll(*ring);
+         ASSERT_FALSE(records.empty());
+         EXPECT_EQ("record " + std::to_string(i), records.back());
+      }
+   }
+   EXPECT_EQ(size_t{1}, DrainAll(*ring).size()); // record 19
+   EXPECT_TRUE(ring->empty());
+   EXPECT_EQ(uint64_t{0}, ring->counters().dropped);
+}
+
+TEST(SharedMemoryRingTest, FullRingDropsAndLongRecordsAreTruncated) {
+   auto ring = g3::SharedMemoryRing::CreateMemfd(4, 64);
+   ASSERT_TRUE(ring);
+   EXPECT_EQ(size_t{4}, ring->slotCount());
+   for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(ring->push("fits"));
+   }
+   EXPECT_FALSE(ring->push("dropped"));
+   EXPECT_EQ(uint64_t{1}, ring->counters().dropped);
+   EXPECT_EQ(size_t{4}, DrainAll(*ring).size());
+
+   std::string record(1000, 'x');
+   record.back() = '\n';
+   EXPECT_TRUE(ring->push(record));
+   auto records = DrainAll(*ring);
+   ASSERT_EQ(size_t{1}, records.size());
+   EXPECT_EQ(ring->maxRecordSize(), records[0].size());
+   EXPECT_EQ('\n', records[0].back()) << "the cut record still ends its line";
+   EXPECT_EQ(uint64_t{1}, ring->counters().truncated);
+
+   // in the collected log, the record after a cut one is on the next line
+   const std::string prefix = "g3sinks_truncated_" + std::to_string(getpid());
+   std::string logfile;
+   {
+      g3::SharedMemoryCollector collector(prefix, "./");
+      logfile = collector.logRotate().logFileName();
+      auto collected = g3::SharedMemoryRing::CreateMemfd(4, 64);
+      ASSERT_TRUE(collected);
+      EXPECT_TRUE(collected->push(std::string(200, 'y') + "\n"));
+      EXPECT_TRUE(collected->push("short\n"));
+      EXPECT_TRUE(collected->push("no newline"));
+      EXPECT_TRUE(collected->push("last\n"));
+      collector.addRing(std::move(collected));
+      collector.stop();
+   }
+   std::istringstream content(RotateTestHelper::ReadContent(logfile));
+   std::vector<std::string> lines;
+   std::string line;
+   while (std::getline(content, line)) {
+      if (!line.empty() && (line[0] == 'y' || line == "short" || line == "no newline" || line == "last")) {
+         lines.push_back(line);
+      }
+   }
+   ASSERT_EQ(size_t{4}, lines.size());
+   EXPECT_EQ(std::string(64 - 16 - 1, 'y'), lines[0]);
+   EXPECT_EQ("short", lines[1]);
+   EXPECT_EQ("no newline", lines[2]);
+   EXPECT_EQ("last", lines[3]);
+   std::remove(logfile.c_str());
+}
+
+TEST(SharedMemoryRingTest, NamedSegmentIsOpenedByProducers) {
+   auto name = UniqueRingName("g3sinks_ring");
+   EXPECT_FALSE(g3::SharedMemoryRing::Open(name));
+   auto collector = g3::SharedMemoryRing::Create(name, 16, 128);
+   ASSERT_TRUE(collector);
+   auto producer = g3::SharedMemoryRing::Open(name);
+   ASSERT_TRUE(producer);
+   EXPECT_EQ(size_t{16}, producer->slotCount());
+
+   producer->push("from the producer");
+   auto records = DrainAll(*collector);
+   ASSERT_EQ(size_t{1}, records.size());
+   EXPECT_EQ("from the producer", records[0]);
+   g3::SharedMemoryRing::Unlink(name);
+}
+
+TEST(SharedMemoryRingTest, PushWakesTheWaitingCollector) {
+   auto ring = g3::SharedMemoryRing::CreateMemfd(16, 128);
+   ASSERT_TRUE(ring);
+   EXPECT_FALSE(ring->wait(std::chrono::milliseconds(10)));
+
+   auto start = std::chrono::steady_clock::now();
+   std::thread producer([&ring] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      ring->push("wake up");
+   });
+   EXPECT_TRUE(ring->wait(std::chrono::seconds(10)));
+   auto waited = std::chrono::steady_clock::now() - start;
+   producer.join();
+   EXPECT_LT(waited, std::chrono::seconds(5));
+   EXPECT_EQ(size_t{1}, DrainAll(*ring).size());
+}
+
+TEST(SharedMemoryRingTest, ForkedProducersShareOneRotatingLog) {
+   const std::string prefix = "g3sinks_collector_" + std::to_string(getpid());
+   const std::string directory = "./";
+   const int kProducers = 4;
+   const int kRecords = 2000;
+   std::string logfile;
+   {
+      g3::SharedMemoryCollector collector(prefix, directory);
+      logfile = collector.logRotate().logFileName();
+      auto ring = g3::SharedMemoryRing::CreateMemfd(16384, 128);
+      ASSERT_TRUE(ring);
+      int fd = ring->fd();
+
+      std::vector<pid_t> producers;
+      for (int p = 0; p < kProducers; ++p) {
+         pid_t pid = fork();
+         ASSERT_GE(pid, 0);
+         if (0 == pid) {
+            auto own = g3::SharedMemoryRing::Attach(fd);
+            for (int i = 0; own && i < kRecords; ++i) {
+               own->push("producer " + std::to_string(p) + " record " + std::to_string(i) + "\n");
+            }
+            _exit(own ? 0 : 1);
+         }
+         producers.push_back(pid);
+      }
+      collector.addRing(std::move(ring));
+      for (auto pid : producers) {
+         int status = 0;
+         waitpid(pid, &status, 0);
+         EXPECT_TRUE(WIFEXITED(status) && 0 == WEXITSTATUS(status));
+      }
+      collector.stop();
+      EXPECT_EQ(uint64_t(kProducers * kRecords), collector.collected());
+   }
+
+   // every line is whole and the records of each producer are in order
+   std::istringstream content(RotateTestHelper::ReadContent(logfile));
+   std::vector<int> next(kProducers, 0);
+   std::string line;
+   int lines = 0;
+   while (std::getline(content, line)) {
+      int producer = -1;
+      int record = -1;
+      if (2 != std::sscanf(line.c_str(), "producer %d record %d", &producer, &record)) {
+         continue; // the LogRotate header
+      }
+      ASSERT_TRUE(producer >= 0 && producer < kProducers) << line;
+      EXPECT_EQ(next[producer], record) << line;
+      next[producer] = record + 1;
+      ++lines;
+   }
+   EXPECT_EQ(kProducers * kRecords, lines);
+   std::remove(logfile.c_str());
+}
+
+TEST(SharedMemorySinkTest, RecordsCarryThePid) {
+   auto name = UniqueRingName("g3sinks_sink_ring");
+   g3::SharedMemorySink early(name);
+   EXPECT_FALSE(early.isConnected());
+   g3::LogMessage lost(__FILE__, __LINE__, __FUNCTION__, INFO);
+   early.ReceiveLogMessage(g3::LogMessageMover(std::move(lost)));
+   EXPECT_EQ(uint64_t{1}, early.notConnectedDropped());
+
+   auto collector = g3::SharedMemoryRing::Create(name, 16, 512);
+   ASSERT_TRUE(collector);
+   g3::SharedMemorySink sink(name);
+   ASSERT_TRUE(sink.isConnected());
+   g3::LogMessage message(__FILE__, __LINE__, __FUNCTION__, INFO);
+   message.write().append("hello collector");
+   sink.ReceiveLogMessage(g3::LogMessageMover(std::move(message)));
+
+   auto records = DrainAll(*collector);
+   ASSERT_EQ(size_t{1}, records.size());
+   EXPECT_EQ(0u, records[0].find("[" + std::to_string(getpid()) + "] ")) << records[0];
+   EXPECT_NE(std::string::npos, records[0].find("hello collector")) << records[0];
+   g3::SharedMemoryRing::Unlink(name);
+}
+
+TEST(SharedMemorySinkTest, CollectorIsRestartedUnderTheSink) {
+   auto name = UniqueRingName("g3sinks_restart_ring");
+   auto first = g3::SharedMemoryRing::Create(name, 16, 512);
+   ASSERT_TRUE(first);
+   g3::SharedMemorySink sink(name);
+   ASSERT_TRUE(sink.isConnected());
+   auto log = [&sink](const std::string& text) {
+      g3::LogMessage message(__FILE__, __LINE__, __FUNCTION__, INFO);
+      message.write().append(text);
+      sink.ReceiveLogMessage(g3::LogMessageMover(std::move(message)));
+   };
+   log("to the first collector");
+   EXPECT_EQ(size_t{1}, DrainAll(*first).size());
+
+   // the first collector crashed: its segment is replaced by the next one
+   auto second = g3::SharedMemoryRing::Create(name, 16, 512);
+   ASSERT_TRUE(second);
+   EXPECT_TRUE(first->isClosed());
+   log("to the second collector");
+   EXPECT_TRUE(DrainAll(*first).empty());
+   auto records = DrainAll(*second);
+   ASSERT_EQ(size_t{1}, records.size());
+   EXPECT_NE(std::string::npos, records[0].find("to the second collector")) << records[0];
+
+   // the second collector stops, and a third one starts
+   second->close();
+   auto third = g3::SharedMemoryRing::Create(name, 16, 512);
+   ASSERT_TRUE(third);
+   log("to the third collector");
+   EXPECT_TRUE(DrainAll(*second).empty());
+   EXPECT_EQ(size_t{1}, DrainAll(*third).size());
+   EXPECT_EQ(uint64_t{0}, sink.notConnectedDropped());
+   g3::SharedMemoryRing::Unlink(name);
+}
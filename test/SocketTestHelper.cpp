@@ -0,0 +1,138 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include "SocketTestHelper.h"
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace SocketTestHelper {
+
+   DatagramServer::DatagramServer(const std::string& path)
+      : _path(path)
+      , _socket(::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)) {
+      ::unlink(_path.c_str());
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, _path.c_str(), sizeof(address.sun_path) - 1);
+      ::bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+   }
+
+   DatagramServer::~DatagramServer() {
+      ::close(_socket);
+      ::unlink(_path.c_str());
+   }
+
+   std::vector<std::string> DatagramServer::receive(size_t count, std::chrono::milliseconds timeout) {
+      std::vector<std::string> datagrams;
+      std::vector<char> buffer(256 * 1024);
+      while (datagrams.size() < count) {
+         pollfd readable = {_socket, POLLIN, 0};
+         if (::poll(&readable, 1, static_cast<int>(timeout.count())) <= 0) {
+            break;
+         }
+         iovec data = {buffer.data(), buffer.size()};
+         union {
+            cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(int))];
+         } control;
+         msghdr message;
+         std::memset(&message, 0, sizeof(message));
+         message.msg_iov = &data;
+         message.msg_iovlen = 1;
+         message.msg_control = &control;
+         message.msg_controllen = sizeof(control);
+         auto size = ::recvmsg(_socket, &message, MSG_CMSG_CLOEXEC);
+         if (size < 0) {
+            break;
+         }
+
+         cmsghdr* rights = CMSG_FIRSTHDR(&message);
+         if (rights && SOL_SOCKET == rights->cmsg_level && SCM_RIGHTS == rights->cmsg_type) {
+            int fd = -1;
+            std::memcpy(&fd, CMSG_DATA(rights), sizeof(int));
+            std::string content;
+            char chunk[4096];
+            ssize_t read = 0;
+            while ((read = ::pread(fd, chunk, sizeof(chunk), static_cast<off_t>(content.size()))) > 0) {
+               content.append(chunk, static_cast<size_t>(read));
+            }
+            ::close(fd);
+            datagrams.push_back(std::move(content));
+            continue;
+         }
+         datagrams.emplace_back(buffer.data(), static_cast<size_t>(size));
+      }
+      return datagrams;
+   }
+
+   StreamServer::StreamServer()
+      : _listener(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0))
+      , _client(-1) {
+      sockaddr_in address;
+      std::memset(&address, 0, sizeof(address));
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port = 0; // any free port
+      ::bind(_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+      ::listen(_listener, 4);
+      socklen_t size = sizeof(address);
+      ::getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &size);
+      _address = "127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+   }
+
+   StreamServer::~StreamServer() {
+      if (_client >= 0) {
+         ::close(_client);
+      }
+      ::close(_listener);
+   }
+
+   std::vector<std::string> StreamServer::receive(size_t count, std::chrono::milliseconds timeout) {
+      std::vector<std::string> frames;
+      std::vector<char> buffer(64 * 1024);
+      while (frames.size() < count) {
+         // MSG-LEN SP SYSLOG-MSG
+         auto space = _pending.find(' ');
+         if (space != std::string::npos) {
+            size_t length = std::stoul(_pending.substr(0, space));
+            if (_pending.size() >= space + 1 + length) {
+               frames.push_back(_pending.substr(space + 1, length));
+               _pending.erase(0, space + 1 + length);
+               continue;
+            }
+         }
+
+         int fd = (_client >= 0) ? _client : _listener;
+         pollfd readable = {fd, POLLIN, 0};
+         if (::poll(&readable, 1, static_cast<int>(timeout.count())) <= 0) {
+            break;
+         }
+         if (_client < 0) {
+            _client = ::accept4(_listener, nullptr, nullptr, SOCK_CLOEXEC);
+            continue;
+         }
+         auto size = ::recv(_client, buffer.data(), buffer.size(), 0);
+         if (size <= 0) {
+            break;
+         }
+         _pending.append(buffer.data(), static_cast<size_t>(size));
+      }
+      return frames;
+   }
+
+   std::string UniqueSocketPath(const std::string& name) {
+      return "/tmp/" + name + "_" + std::to_string(::getpid()) + ".sock";
+   }
+}
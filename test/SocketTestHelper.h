@@ -0,0 +1,57 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace SocketTestHelper {
+   /// A unix datagram socket that stands in for a logging daemon (syslog, journald)
+   class DatagramServer {
+    public:
+      explicit DatagramServer(const std::string& path);
+      ~DatagramServer();
+
+      const std::string& path() const { return _path; }
+
+      /// @return up to @param count datagrams, waits at most @param timeout for each
+      /// A datagram that passes a file descriptor, like journald's memfd entries, is
+      /// returned as the content of that file
+      std::vector<std::string> receive(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    private:
+      std::string _path;
+      int _socket;
+   };
+
+   /// A localhost TCP collector that reads RFC 6587 octet counted syslog frames
+   class StreamServer {
+    public:
+      StreamServer();
+      ~StreamServer();
+
+      /// "127.0.0.1:port"
+      const std::string& address() const { return _address; }
+
+      /// @return up to @param count frames without the length prefix, waits at most @param timeout for each
+      std::vector<std::string> receive(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    private:
+      std::string _address;
+      int _listener;
+      int _client;
+      std::string _pending; // received bytes that are not yet a complete frame
+   };
+
+   /// @return a socket path in the temp directory that is unique for this process
+   std::string UniqueSocketPath(const std::string& name);
+}
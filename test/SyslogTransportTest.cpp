@@ -0,0 +1,276 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <g3log/logmessage.hpp>
+#include <g3sinks/syslogsink.hpp>
+#include <g3sinks/syslogtransport.hpp>
+#include <memory>
+#include <regex>
+#include <thread>
+#include <syslog.h>
+#include <unistd.h>
+#include "SocketTestHelper.h"
+
+using namespace SocketTestHelper;
+
+namespace {
+   g3::LogMessage CreateLogEntry(const LEVELS level, std::string content, std::chrono::milliseconds age = std::chrono::milliseconds(0)) {
+      g3::LogMessage message(__FILE__, __LINE__, __FUNCTION__, level);
+      message.write().append(content);
+      message._timestamp -= age;
+      return message;
+   }
+} // anonymous
+
+TEST(SyslogTransportTest, RFC5424Frame) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   ASSERT_TRUE(transport.isConnected());
+   transport.setIdentity("myapp");
+   transport.setFacility(LOG_LOCAL0);
+
+   transport.send(LOG_ERR, CreateLogEntry(WARNING, "Hello"), "Hello syslog\n");
+   auto frames = daemon.receive(1);
+   ASSERT_EQ(size_t{1}, frames.size());
+
+   // <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID SD MSG
+   std::regex rfc5424("<131>1 \\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}:\\d{2}\\.\\d{6}Z \\S+ myapp " + std::to_string(getpid()) + " - - Hello syslog");
+   EXPECT_TRUE(std::regex_match(frames[0], rfc5424)) << frames[0];
+}
+
+TEST(SyslogTransportTest, RFC3164Frame) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC3164);
+   transport.setIdentity("myapp");
+
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "Hello"), "Hello syslog");
+   auto frames = daemon.receive(1);
+   ASSERT_EQ(size_t{1}, frames.size());
+   std::regex rfc3164("<14>[A-Z][a-z]{2} [ \\d]\\d \\d{2}:\\d{2}:\\d{2} myapp\\[" + std::to_string(getpid()) + "\\]: Hello syslog");
+   EXPECT_TRUE(std::regex_match(frames[0], rfc3164)) << frames[0];
+}
+
+TEST(SyslogTransportTest, StructuredData) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   transport.setIdentity("myapp");
+   transport.setStructuredData(true);
+
+   auto message = CreateLogEntry(INFO, "Hello");
+   message._function = "operator[]";
+   message._line = 42;
+   transport.send(LOG_INFO, message, "Hello structured");
+   transport.send(LOG_NOTICE, "text from the sink itself");
+   auto frames = daemon.receive(2);
+   ASSERT_EQ(size_t{2}, frames.size());
+
+   std::regex structured("<14>1 \\S+ \\S+ myapp \\d+ - \\[g3log@32473 file=\"SyslogTransportTest.cpp\" line=\"42\" "
+                         "function=\"operator\\[\\\\]\" thread=\"[^\"]+\"\\] Hello structured");
+   EXPECT_TRUE(std::regex_match(frames[0], structured)) << frames[0];
+   EXPECT_NE(std::string::npos, frames[1].find(" - - text from the sink itself")) << frames[1];
+}
+
+TEST(SyslogTransportTest, OctetCountedStream) {
+   StreamServer collector;
+   g3::SyslogTransport transport(collector.address(), g3::SyslogTransport::Format::RFC5424, g3::SyslogTransport::Framing::OctetCounted);
+   ASSERT_TRUE(transport.isConnected());
+   transport.setBatching(8, std::chrono::milliseconds(10));
+
+   // pipelined, several frames in one send
+   for (int i = 0; i < 8; ++i) {
+      transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "line " + std::to_string(i) + "\nwith a break");
+   }
+   auto frames = collector.receive(8);
+   ASSERT_EQ(size_t{8}, frames.size());
+   for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(0u, frames[i].find("<14>1 ")) << frames[i];
+      auto text = "line " + std::to_string(i) + "\nwith a break";
+      EXPECT_EQ(frames[i].size() - text.size(), frames[i].rfind(text)) << frames[i];
+   }
+   EXPECT_EQ(uint64_t{8}, transport.counters().sent);
+}
+
+TEST(SyslogTransportTest, MissingCollectorIsNotAnError) {
+   std::string address;
+   {
+      StreamServer gone;
+      address = gone.address();
+   }
+   g3::SyslogTransport transport(address, g3::SyslogTransport::Format::RFC5424, g3::SyslogTransport::Framing::OctetCounted);
+   EXPECT_FALSE(transport.isConnected());
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "dropped"), "dropped");
+   EXPECT_EQ(uint64_t{1}, transport.counters().dropped);
+}
+
+TEST(SyslogTransportTest, BatchedWhileBehind) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   transport.setBatching(4, std::chrono::milliseconds(10));
+
+   // queued messages: the sink is behind so they are batched
+   for (int i = 0; i < 3; ++i) {
+      transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued " + std::to_string(i));
+   }
+   EXPECT_TRUE(daemon.receive(1, std::chrono::milliseconds(50)).empty());
+
+   // batch is full at the 4th
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued 3");
+   auto frames = daemon.receive(4);
+   ASSERT_EQ(size_t{4}, frames.size());
+   for (int i = 0; i < 4; ++i) {
+      EXPECT_NE(std::string::npos, frames[i].find("queued " + std::to_string(i))) << frames[i];
+   }
+
+   // a fresh message means the sink caught up, pending messages are sent right away
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued 4");
+   transport.send(LOG_INFO, CreateLogEntry(INFO, ""), "fresh");
+   frames = daemon.receive(2);
+   ASSERT_EQ(size_t{2}, frames.size());
+   EXPECT_NE(std::string::npos, frames[1].find("fresh")) << frames[1];
+}
+
+TEST(SyslogTransportTest, OverdueBatchIsSent) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   transport.setBatching(100, std::chrono::milliseconds(10), std::chrono::milliseconds(50));
+
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued 0");
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued 1");
+   EXPECT_EQ(size_t{2}, transport.pendingFrames());
+   std::this_thread::sleep_for(std::chrono::milliseconds(60));
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued 2");
+   EXPECT_EQ(size_t{0}, transport.pendingFrames());
+   EXPECT_EQ(size_t{3}, daemon.receive(3).size());
+}
+
+TEST(SyslogTransportTest, SeverePrioritySendsPending) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   transport.setBatching(100, std::chrono::milliseconds(10));
+
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "", std::chrono::seconds(1)), "queued");
+   transport.send(LOG_WARNING, CreateLogEntry(WARNING, "", std::chrono::seconds(1)), "warning");
+   EXPECT_EQ(size_t{2}, daemon.receive(2).size());
+}
+
+TEST(SyslogTransportTest, MissingDaemonIsNotAnError) {
+   g3::SyslogTransport transport(UniqueSocketPath("g3sinks_no_daemon"), g3::SyslogTransport::Format::RFC5424);
+   EXPECT_FALSE(transport.isConnected());
+   transport.send(LOG_INFO, CreateLogEntry(INFO, "dropped"), "dropped");
+}
+
+TEST(SyslogSinkTest, DirectTransport) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   {
+      g3::SyslogSink sink("sinktest");
+      sink.useDirectTransport(g3::SyslogTransport::Format::RFC5424, daemon.path());
+      sink.setLogHeader("header");
+      sink.syslog(g3::LogMessageMover(CreateLogEntry(WARNING, "Hello sink")));
+   }
+   auto frames = daemon.receive(2);
+   ASSERT_EQ(size_t{2}, frames.size());
+   EXPECT_NE(std::string::npos, frames[0].find("<13>1 ")) << frames[0]; // LOG_USER | LOG_NOTICE
+   EXPECT_NE(std::string::npos, frames[0].find(" sinktest ")) << frames[0];
+   EXPECT_NE(std::string::npos, frames[0].find("header")) << frames[0];
+   EXPECT_NE(std::string::npos, frames[1].find("<12>1 ")) << frames[1]; // LOG_USER | LOG_WARNING
+   EXPECT_NE(std::string::npos, frames[1].find("Hello sink")) << frames[1];
+}
+
+TEST(SyslogSinkTest, StructuredDataOverStream) {
+   StreamServer collector;
+   g3::SyslogSink sink("sinktest");
+   sink.useDirectTransport(g3::SyslogTransport::Format::RFC5424, collector.address(), g3::SyslogTransport::Framing::OctetCounted);
+   sink.setStructuredData(true);
+   sink.syslog(g3::LogMessageMover(CreateLogEntry(WARNING, "Hello collector")));
+
+   auto frames = collector.receive(1);
+   ASSERT_EQ(size_t{1}, frames.size());
+   EXPECT_NE(std::string::npos, frames[0].find(" sinktest ")) << frames[0];
+   EXPECT_NE(std::string::npos, frames[0].find("[g3log@32473 file=\"SyslogTransportTest.cpp\" line=\"")) << frames[0];
+   EXPECT_NE(std::string::npos, frames[0].find("Hello collector")) << frames[0];
+}
+
+TEST(SyslogTransportTest, NonBlockingWhenDaemonIsStalled) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogTransport transport(daemon.path(), g3::SyslogTransport::Format::RFC5424);
+   transport.setNonBlocking(true, 8);
+
+   // the daemon does not read. A blocking send would hang when its socket queue is full
+   const size_t kMessages = 2000;
+   for (size_t i = 0; i < kMessages; ++i) {
+      transport.send(LOG_INFO, CreateLogEntry(INFO, ""), "stalled #" + std::to_string(i));
+   }
+   auto counters = transport.counters();
+   EXPECT_GT(counters.sent, uint64_t{0});
+   EXPECT_GT(counters.retried, uint64_t{0});
+   EXPECT_LE(counters.retried, kMessages - counters.sent) << "a frame is counted once, not at each retry";
+   EXPECT_GT(counters.dropped, uint64_t{0});
+   EXPECT_EQ(size_t{8}, transport.pendingFrames());
+   EXPECT_EQ(kMessages, counters.sent + counters.dropped + transport.pendingFrames());
+
+   // the daemon catches up, the retry queue is sent before the new message
+   auto received = daemon.receive(kMessages, std::chrono::milliseconds(100));
+   EXPECT_EQ(counters.sent, received.size());
+   transport.send(LOG_INFO, CreateLogEntry(INFO, ""), "caught up");
+   received = daemon.receive(9);
+   ASSERT_EQ(size_t{9}, received.size());
+   EXPECT_NE(std::string::npos, received[0].find("stalled #" + std::to_string(kMessages - 8))) << received[0];
+   EXPECT_NE(std::string::npos, received[8].find("caught up")) << received[8];
+   EXPECT_EQ(size_t{0}, transport.pendingFrames());
+}
+
+TEST(SyslogSinkTest, NonBlockingReportsDrops) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   g3::SyslogSink sink("sinktest");
+   sink.useDirectTransport(g3::SyslogTransport::Format::RFC3164, daemon.path());
+   sink.setNonBlocking(4);
+   sink.setDroppedReportInterval(std::chrono::milliseconds(0));
+
+   for (int i = 0; i < 1000; ++i) {
+      sink.syslog(g3::LogMessageMover(CreateLogEntry(INFO, "stalled")));
+   }
+   auto counters = sink.transportCounters();
+   EXPECT_GT(counters.dropped, uint64_t{0});
+
+   daemon.receive(2000, std::chrono::milliseconds(100));
+   sink.syslog(g3::LogMessageMover(CreateLogEntry(INFO, "caught up")));
+   auto received = daemon.receive(10, std::chrono::milliseconds(100));
+   ASSERT_FALSE(received.empty());
+   EXPECT_NE(std::string::npos, received.back().find("g3sinks: syslog transport dropped")) << received.back();
+}
+
+TEST(SyslogSinkTest, LatencyToWriteAndToSend) {
+   DatagramServer daemon(UniqueSocketPath("g3sinks_syslog"));
+   {
+      g3::SyslogSink sink("sinktest");
+      sink.useDirectTransport(g3::SyslogTransport::Format::RFC5424, daemon.path());
+      sink.setBatching(4, std::chrono::milliseconds(10));
+      sink.setLatencyTracking(true);
+
+      // batched: written but not yet sent
+      for (int i = 0; i < 3; ++i) {
+         sink.syslog(g3::LogMessageMover(CreateLogEntry(INFO, "queued", std::chrono::milliseconds(100))));
+      }
+      auto latency = sink.latency();
+      EXPECT_EQ(uint64_t{3}, latency.to_write.count());
+      EXPECT_EQ(uint64_t{0}, latency.to_flush.count());
+      EXPECT_GE(latency.to_write.percentile(50), std::chrono::milliseconds(100));
+
+      sink.flush();
+      EXPECT_EQ(uint64_t{3}, sink.latency().to_flush.count());
+      EXPECT_EQ(size_t{3}, daemon.receive(3).size());
+   }
+   // the summary is sent at exit
+   auto frames = daemon.receive(1);
+   ASSERT_EQ(size_t{1}, frames.size());
+   EXPECT_NE(std::string::npos, frames[0].find("<14>1 ")) << frames[0]; // LOG_USER | LOG_INFO
+   EXPECT_NE(std::string::npos, frames[0].find("g3sinks: latency of 3 entries")) << frames[0];
+}
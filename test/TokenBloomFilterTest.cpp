@@ -0,0 +1,141 @@
+/** ==========================================================================
+ * 2026 by KjellKod.cc
+ *
+ * This code is PUBLIC DOMAIN to use at your own risk and comes
+ * with no warranties. This code is yours to share, use and modify with no
+ * strings attached and no restrictions or obligations.
+ * ============================================================================*
+ * PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+ * ********************************************* */
+
+#include "RotateFileTest.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "g3sinks/LogFileReader.h"
+#include "g3sinks/LogRotate.h"
+#include "g3sinks/LogRotateUtility.h"
+#include "g3sinks/SeekableGzip.h"
+#include "g3sinks/TokenBloomFilter.h"
+
+namespace {
+   std::string RequestId(int index) {
+      return "req" + std::to_string(1000000 + index * 7919);
+   }
+} // anonymous
+
+TEST(TokenBloomFilter, NoFalseNegativesAndFewFalsePositives) {
+   TokenBloomFilter filter(1 << 20);
+   for (int i = 0; i < 10000; ++i) {
+      std::string line = "handled " + RequestId(i) + " for user-" + std::to_string(i) + "\n";
+      filter.addText(line.data(), line.size());
+   }
+   filter.finish();
+   filter.compact();
+   EXPECT_GT(uint64_t(1) << 20, filter.bits()) << "folded to the number of tokens";
+   EXPECT_GE(0.5, filter.fillRatio());
+
+   int false_positives = 0;
+   for (int i = 0; i < 10000; ++i) {
+      ASSERT_TRUE(filter.mayContain(RequestId(i), true)) << i;
+      false_positives += filter.mayContain(RequestId(i + 10000), true) ? 1 : 0;
+   }
+   EXPECT_GT(200, false_positives);
+
+   EXPECT_TRUE(filter.mayContain("HANDLED", true)) << "case insensitive";
+   EXPECT_TRUE(filter.mayContain("for user-42", true)) << "user is a token, 42 is too short to be one";
+   EXPECT_FALSE(filter.mayContain("handled unknownword", true));
+   EXPECT_TRUE(filter.mayContain("ndled " + RequestId(1), false)) << "the first word may be the end of a token";
+   EXPECT_FALSE(filter.mayContain("ndled " + RequestId(1), true));
+
+   const std::string file = "/tmp/g3sinks_bloom_test.bloom";
+   ASSERT_TRUE(filter.save(file));
+   TokenBloomFilter loaded;
+   ASSERT_TRUE(loaded.load(file));
+   std::remove(file.c_str());
+   EXPECT_EQ(filter.bits(), loaded.bits());
+   EXPECT_TRUE(loaded.mayContain(RequestId(99), true));
+   EXPECT_FALSE(loaded.load("/tmp/g3sinks_no_such_bloom_filter"));
+}
+
+TEST_F(RotateFileTest, ArchivesGetABloomFilterOfTheirTokens) {
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveBloomFilter(true);
+      for (int i = 0; i < 1000; ++i) {
+         logrotate.save("2026/10/18 12:00:00 000000\tINFO [Server.cpp->handle:1]\thandled " + RequestId(i) + "\n");
+      }
+      ASSERT_TRUE(logrotate.rotateLog());
+   }
+   auto files = LogRotateUtility::getLogFileSet(_directory, _filename);
+   ASSERT_LE(1u, files.size());
+   const std::string archive = files[0];
+   _filesToRemove.push_back(ArchiveBloomFilter::filterFileName(archive));
+
+   TokenBloomFilter filter;
+   ASSERT_TRUE(filter.load(ArchiveBloomFilter::filterFileName(archive)));
+   EXPECT_GT(uint64_t(64 * 1024 * 4), filter.bits()) << "much smaller than the log";
+   for (int i = 0; i < 1000; ++i) {
+      EXPECT_TRUE(ArchiveBloomFilter::mayContain(archive, RequestId(i), true)) << i;
+   }
+   EXPECT_TRUE(ArchiveBloomFilter::mayContain(archive, "Server.cpp->handle", true));
+   EXPECT_FALSE(ArchiveBloomFilter::mayContain(archive, "handled reqnotlogged", true));
+   EXPECT_TRUE(ArchiveBloomFilter::mayContain(archive + ".missing", "anything", true)) << "no filter, no skipping";
+}
+
+TEST_F(RotateFileTest, SeekableArchivesGetTheFilterInTheSamePass) {
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveBloomFilter(true);
+      logrotate.setArchiveSyncPoints(1024, std::chrono::seconds(0));
+      for (int i = 0; i < 1000; ++i) {
+         logrotate.save("2026/10/18 12:00:00 000000\tINFO [Server.cpp->handle:1]\thandled " + RequestId(i) + "\n");
+      }
+      ASSERT_TRUE(logrotate.rotateLog());
+   }
+   auto files = LogRotateUtility::getLogFileSet(_directory, _filename);
+   ASSERT_LE(1u, files.size());
+   const std::string archive = files[0];
+   _filesToRemove.push_back(ArchiveBloomFilter::filterFileName(archive));
+   _filesToRemove.push_back(SeekableGzip::indexFileName(archive));
+
+   for (int i = 0; i < 1000; ++i) {
+      EXPECT_TRUE(ArchiveBloomFilter::mayContain(archive, RequestId(i), true)) << i;
+   }
+   EXPECT_FALSE(ArchiveBloomFilter::mayContain(archive, "handled reqnotlogged", true));
+}
+
+TEST_F(RotateFileTest, ADefaultSearchOnlyOpensTheArchiveWithTheRequestId) {
+   {
+      LogRotate logrotate(_filename, _directory);
+      logrotate.setArchiveBloomFilter(true);
+      for (int archive = 0; archive < 2; ++archive) {
+         for (int i = 0; i < 100; ++i) {
+            logrotate.save("2026/10/18 12:00:00 000000\tINFO [Server.cpp->handle:1]\thandled req-" + std::to_string(7000000 + archive * 100 + i) + "\n");
+         }
+         ASSERT_TRUE(logrotate.rotateLog());
+         std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // the archives are named by the second
+      }
+   }
+   auto files = LogRotateUtility::getLogFileSet(_directory, _filename);
+   std::vector<std::string> archives;
+   for (auto& file : files) {
+      if (file.size() > 3 && 0 == file.compare(file.size() - 3, 3, ".gz")) {
+         archives.push_back(file);
+         _filesToRemove.push_back(ArchiveBloomFilter::filterFileName(file));
+      }
+   }
+   ASSERT_EQ(2u, archives.size());
+
+   // a bare request ID, as it is searched for
+   const std::string id = "req-" + std::to_string(7000150);
+   int opened = 0;
+   for (auto& archive : archives) {
+      opened += ArchiveBloomFilter::mayContain(archive, id) ? 1 : 0;
+   }
+   EXPECT_EQ(1, opened);
+   for (auto& archive : archives) {
+      EXPECT_TRUE(ArchiveBloomFilter::mayContain(archive, id, false)) << "a substring search cannot rule out the edge words";
+   }
+}
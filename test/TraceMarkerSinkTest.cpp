@@ -0,0 +1,68 @@
+/** ==========================================================================
+* 2026 by KjellKod.cc
+*
+* This code is PUBLIC DOMAIN to use at your own risk and comes
+* with no warranties. This code is yours to share, use and modify with no
+* strings attached and no restrictions or obligations.
+* ============================================================================*
+* PUBLIC DOMAIN and Not copywrited. First published at KjellKod.cc
+* ********************************************* */
+
+#include <gtest/gtest.h>
+#include <g3sinks/TraceMarkerSink.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+   g3::LogMessageMover CreateLogEntry(const LEVELS level, std::string content) {
+      g3::LogMessage message("some/path/trace.cpp", 42, "someFunction", level);
+      message.write().append(content);
+      return g3::LogMessageMover(std::move(message));
+   }
+
+   std::string ReadFile(const std::string& path) {
+      std::ifstream in(path);
+      std::stringstream content;
+      content << in.rdbuf();
+      return content.str();
+   }
+
+   std::string CreateMarkerFile() {
+      std::string path = "./trace_marker_" + std::to_string(getpid());
+      std::ofstream create(path);
+      return path;
+   }
+} // anonymous
+
+TEST(TraceMarkerSinkTest, CompactRecordPerWrite) {
+   auto path = CreateMarkerFile();
+   {
+      TraceMarkerSink sink(path);
+      ASSERT_TRUE(sink.isOpen());
+      sink.ReceiveLogMessage(CreateLogEntry(WARNING, "first"));
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, "second\nline"));
+   }
+   EXPECT_EQ("g3log WARNING trace.cpp:42 first\ng3log INFO trace.cpp:42 second line\n", ReadFile(path));
+   std::remove(path.c_str());
+}
+
+TEST(TraceMarkerSinkTest, LongRecordsAreTruncated) {
+   auto path = CreateMarkerFile();
+   {
+      TraceMarkerSink sink(path, "app", 64);
+      sink.ReceiveLogMessage(CreateLogEntry(INFO, std::string(1000, 'x')));
+   }
+   auto content = ReadFile(path);
+   EXPECT_EQ(size_t{64}, content.size()) << content;
+   EXPECT_EQ(0u, content.find("app INFO trace.cpp:42 xxx")) << content;
+   EXPECT_EQ('\n', content.back());
+   std::remove(path.c_str());
+}
+
+TEST(TraceMarkerSinkTest, MissingMarkerIsNotAnError) {
+   TraceMarkerSink sink("./no_such_dir/trace_marker");
+   EXPECT_FALSE(sink.isOpen());
+   sink.ReceiveLogMessage(CreateLogEntry(INFO, "dropped"));
+}